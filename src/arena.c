@@ -0,0 +1,111 @@
+#include "headers/arena.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t roundUp(size_t size, size_t align) { return (size + align - 1) / align * align; }
+
+#define CHUNK_HEADER roundUp(sizeof(ArenaChunk), ARENA_ALIGN)
+
+static uint8_t* chunkData(ArenaChunk* chunk) { return (uint8_t*)chunk + CHUNK_HEADER; }
+
+static ArenaChunk* newChunk(Arena* arena, size_t min_size) {
+    size_t size = arena->next_chunk_size;
+    while (size < min_size) {
+        size *= 2;
+    }
+
+    ArenaChunk* chunk = (ArenaChunk*)malloc(CHUNK_HEADER + size);
+    if (chunk == NULL) {
+        exit(1);
+    }
+
+    chunk->prev = arena->chunk;
+    chunk->size = size;
+    chunk->used = 0;
+
+    arena->chunk = chunk;
+    arena->next_chunk_size = size * 2;
+
+    return chunk;
+}
+
+Arena* newArena(size_t chunk_size) {
+    Arena* arena = (Arena*)malloc(sizeof(Arena));
+    if (arena == NULL) {
+        exit(1);
+    }
+
+    *arena = (Arena){.chunk = NULL,
+                     .next_chunk_size = roundUp(chunk_size > 0 ? chunk_size : 1, ARENA_ALIGN),
+                     .last = NULL};
+
+    return arena;
+}
+
+void freeArena(Arena* arena) {
+    if (arena == NULL) {
+        return;
+    }
+
+    ArenaChunk* chunk = arena->chunk;
+    while (chunk != NULL) {
+        ArenaChunk* prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    free(arena);
+}
+
+void* arenaAlloc(Arena* arena, size_t size) {
+    assert(arena != NULL);
+
+    size = roundUp(size > 0 ? size : 1, ARENA_ALIGN);
+
+    ArenaChunk* chunk = arena->chunk;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        chunk = newChunk(arena, size);
+    }
+
+    void* ptr = chunkData(chunk) + chunk->used;
+    chunk->used += size;
+    arena->last = ptr;
+
+    return ptr;
+}
+
+void* arenaCalloc(Arena* arena, size_t count, size_t size) {
+    void* ptr = arenaAlloc(arena, count * size);
+    memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+void* arenaGrow(Arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    assert(arena != NULL);
+
+    if (ptr == NULL) {
+        return arenaAlloc(arena, new_size);
+    }
+
+    old_size = roundUp(old_size > 0 ? old_size : 1, ARENA_ALIGN);
+    new_size = roundUp(new_size > 0 ? new_size : 1, ARENA_ALIGN);
+
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    ArenaChunk* chunk = arena->chunk;
+    if (ptr == arena->last && chunk->size - chunk->used >= new_size - old_size) {
+        chunk->used += new_size - old_size;
+        return ptr;
+    }
+
+    void* res = arenaAlloc(arena, new_size);
+    memcpy(res, ptr, old_size);
+
+    return res;
+}
@@ -1,9 +1,11 @@
 #include "headers/assembler.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "headers/cpu.h"
 #include "headers/errors.h"
@@ -11,8 +13,7 @@
 #include "headers/parse_imm.h"
 #include "headers/str_int_map.h"
 #include "headers/tokenizer.h"
-
-Assembler assembler;
+#include "headers/util.h"
 
 #define HANDLE_BASIC_OP(opcode)                                         \
     do {                                                                \
@@ -20,52 +21,40 @@ Assembler assembler;
         if (new_token == NULL || is_token_comment(new_token->tok)) {    \
             PUSH_OP(OP_##opcode);                                       \
         } else {                                                        \
-            printError(new_token, OP_DOESNT_USE_OPERAND_E, &assembler); \
+            reportError(new_token, OP_DOESNT_USE_OPERAND_E, assembler); \
         }                                                               \
     } while (0)
 
-#define PUSH_OP(opcode)                     \
-    do {                                    \
-        uint8_t op = (uint8_t)opcode;       \
-        push_vec(&assembler.compiled, &op); \
+#define PUSH_OP(opcode)                      \
+    do {                                     \
+        uint8_t op = (uint8_t)opcode;        \
+        push_vec(&assembler->compiled, &op); \
     } while (0)
 
-#define PUSH_IMM8(imm)                        \
-    do {                                      \
-        uint8_t imm1 = (imm);                 \
-        push_vec(&assembler.compiled, &imm1); \
+#define PUSH_IMM8(imm)                         \
+    do {                                       \
+        uint8_t imm1 = (imm);                  \
+        push_vec(&assembler->compiled, &imm1); \
     } while (0)
 
 #define PUSH_IMM16(imm)                         \
     do {                                        \
         uint8_t imm1 = (uint8_t)((imm) >> 8);   \
         uint8_t imm2 = (uint8_t)((imm) & 0xFF); \
-        push_vec(&assembler.compiled, &imm1);   \
-        push_vec(&assembler.compiled, &imm2);   \
+        push_vec(&assembler->compiled, &imm1);  \
+        push_vec(&assembler->compiled, &imm2);  \
     } while (0)
 
-#define PUSH_LABEL_REF(token)                                                                    \
-    do {                                                                                         \
-        slice_t label = (slice_t){.str = (token->substr.str + 1), .len = token->substr.len - 1}; \
-        size_t idx = assembler.compiled.len;                                                     \
-        LabelRef ref = (LabelRef){.label = label,                                                \
-                                  .idx = idx,                                                    \
-                                  .line = assembler.line,                                        \
-                                  .line_nr = assembler.line_nr,                                  \
-                                  .col_nr = token->char_nr + 1};                                 \
-        push_vec(&assembler.label_ref_list, &ref);                                               \
-        /* Push two zeros to the executable as a placeholder for the label location */           \
-        PUSH_IMM16(0);                                                                           \
-    } while (0)
+#define PUSH_LABEL_REF(token) PUSH_LABEL_IDX(token, 0)
 
 #define PUSH_LABEL_IDX(token, offset)                                                  \
     do {                                                                               \
-        LabelRef ref = (LabelRef){.label = token->substr,                              \
-                                  .idx = assembler.compiled.len,                       \
-                                  .line = assembler.line,                              \
-                                  .line_nr = assembler.line_nr,                        \
+        LabelRef ref = (LabelRef){.label = token->label,                               \
+                                  .idx = assembler->compiled.len,                      \
+                                  .line = assembler->line,                             \
+                                  .line_nr = assembler->line_nr,                       \
                                   .col_nr = token->char_nr + 1};                       \
-        push_vec(&assembler.label_ref_list, &ref);                                     \
+        push_vec(&assembler->label_ref_list, &ref);                                    \
         /* Push two zeros to the executable as a placeholder for the label location */ \
         PUSH_IMM16(offset);                                                            \
     } while (0)
@@ -75,26 +64,54 @@ Assembler assembler;
         PUSH_OP(OP_##op##_##dst); \
         break;
 
-static void initAssembler(Assembler* assembler, slice_t filename, TokenLines token_lines) {
+// Sources are only split up when every chunk gets at least this much of it, below that starting
+// the threads costs more than they save
+#define MIN_CHUNK_SIZE (1024 * 1024)
+#define MAX_CHUNKS 64
+// Sessions split the source up much finer, so an edit only has to redo a small part of it
+#define SESSION_CHUNK_SIZE (16 * 1024)
+
+/// `start` is the address the first assembled byte ends up at
+static void initAssembler(Assembler* assembler, slice_t filename, Arena* scratch,
+                          TokenLines token_lines, Arena* labels, size_t start) {
     assembler->path = filename;
+    assembler->scratch = scratch;
     assembler->line_nr = 0;
     assembler->line = (slice_t){.str = NULL, .len = 0};
-    assembler->token_lines = token_lines.lines;
-    assembler->label_ref_list = new_vec(10, sizeof(LabelRef));
-    assembler->label_def_map = new_map();
-    assembler->compiled = new_vec(PROGRAM_START + 100, sizeof(uint8_t));
-    assembler->compiled.len = PROGRAM_START;  // first
+    assembler->token_lines = token_lines;
+    assembler->label_ref_list = new_vec_in(scratch, len_vec(&token_lines.lines) / 4 + 16,
+                                           sizeof(LabelRef));
+    assembler->label_addrs = new_vec_in(scratch, labelCount(&token_lines), sizeof(LabelDef));
+    assembler->label_addrs.len = labelCount(&token_lines);
+    for (size_t i = 0; i < labelCount(&token_lines); ++i) {
+        ((LabelDef*)assembler->label_addrs.ptr)[i] =
+            (LabelDef){.addr = LABEL_UNDEFINED, .constant = false};
+    }
+    assembler->label_def_map = new_map_in(labels, labelCount(&token_lines));
+    assembler->compiled = new_vec(start + 100, sizeof(uint8_t));
+    assembler->compiled.len = start;
+    assembler->debug_info = newDebugInfo(filename);
+    assembler->diagnostics = new_vec_in(labels, 8, sizeof(Diagnostic));
 }
 
 static void freeAssembler(Assembler* assembler) {
     if (assembler != NULL) {
-        free_map(&assembler->label_def_map);
-        free_vec(&assembler->label_ref_list, NULL);
-        // free_vec(&assembler->compiled, NULL);
+        // the tokens and label references all live in the scratch arena, compiled, debug_info,
+        // label_def_map and diagnostics are handed over to the Executable
+        freeArena(assembler->scratch);
+        assembler->scratch = NULL;
     }
 }
 
-static inline Token* nextToken(vec_iter_t* token_line) {
+// Like inserting into a map, only the first definition of a label counts
+static void defineLabel(Assembler* assembler, uint32_t id, size_t value, bool constant) {
+    LabelDef* def = get_vec(&assembler->label_addrs, id);
+    if (def->addr == LABEL_UNDEFINED) {
+        *def = (LabelDef){.addr = value, .constant = constant};
+    }
+}
+
+static inline Token* nextToken(Assembler* assembler, vec_iter_t* token_line) {
     // Relies on invariant that lines contain at least one token, so this will never point to
     // invalid memory when the next token is NULL.
     Token* prev_token = (Token*)(token_line->ptr) - 1;
@@ -103,7 +120,7 @@ static inline Token* nextToken(vec_iter_t* token_line) {
     assert(token != prev_token);
 
     if (token == NULL) {
-        printError(prev_token, UNEXPECTED_EOL_E, &assembler);
+        reportError(prev_token, UNEXPECTED_EOL_E, assembler);
     }
     return token;
 }
@@ -119,7 +136,7 @@ void expr_apply(uint16_t* val, ExprOperator op, uint16_t to_apply) {
     }
 }
 
-static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
+static MemExpr parse_mem_expr(Assembler* assembler, vec_iter_t token_line, TokenSymbol end) {
     Token* token;
     MemExpr expr = (MemExpr){.mode = INVALID_MM, .addr = 0, .mode_token = NULL};
     ExprOperator next_op = PLUS_EOP;
@@ -133,7 +150,7 @@ static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
 
     while (true) {
         // get the expression value
-        token = nextToken(&token_line);
+        token = nextToken(assembler, &token_line);
         if (token == NULL) return (MemExpr){0};
 
         switch (token->tok) {
@@ -145,7 +162,7 @@ static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
                 break;
             case L_T:
                 if (expr.mode == L_MM || expr.mode == HL_MM || expr.mode == BP_MM) {
-                    printError(token, MULTIPLE_MEMORY_E, &assembler);
+                    reportError(token, MULTIPLE_MEMORY_E, assembler);
                     return (MemExpr){0};
                 }
                 expr.mode = L_MM;
@@ -153,7 +170,7 @@ static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
                 break;
             case HL_T:
                 if (expr.mode == L_MM || expr.mode == HL_MM || expr.mode == BP_MM) {
-                    printError(token, MULTIPLE_MEMORY_E, &assembler);
+                    reportError(token, MULTIPLE_MEMORY_E, assembler);
                     return (MemExpr){0};
                 }
                 expr.mode = HL_MM;
@@ -161,19 +178,19 @@ static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
                 break;
             case BP_T:
                 if (expr.mode == L_MM || expr.mode == HL_MM || expr.mode == BP_MM) {
-                    printError(token, MULTIPLE_MEMORY_E, &assembler);
+                    reportError(token, MULTIPLE_MEMORY_E, assembler);
                     return (MemExpr){0};
                 }
                 expr.mode = BP_MM;
                 expr.mode_token = token;
                 break;
             default:
-                printError(token, EXPECTED_EXPR_E, &assembler);
+                reportError(token, EXPECTED_EXPR_E, assembler);
                 return (MemExpr){0};
         }
 
         // get the expression delim
-        token = nextToken(&token_line);
+        token = nextToken(assembler, &token_line);
         if (token == NULL) return (MemExpr){0};
 
         switch (token->tok) {
@@ -190,35 +207,35 @@ static MemExpr parse_mem_expr(vec_iter_t token_line, TokenSymbol end) {
                     }
                     return expr;
                 } else {
-                    printError(token, NONMATCHING_CLOSING_PAREN_E, &assembler);
+                    reportError(token, NONMATCHING_CLOSING_PAREN_E, assembler);
                     return (MemExpr){0};
                 }
             default:
-                printError(token, EXPECTED_EXPR_OP_E, &assembler);
+                reportError(token, EXPECTED_EXPR_OP_E, assembler);
                 return (MemExpr){0};
         }
     }
 }
 
-static MemExpr parse_mem_addr(Token* prev_token, vec_iter_t token_line) {
+static MemExpr parse_mem_addr(Assembler* assembler, Token* prev_token, vec_iter_t token_line) {
     Token* token;
 
     switch (prev_token->tok) {
         case LABEL_IDX_T:
-            token = nextToken(&token_line);
+            token = nextToken(assembler, &token_line);
             if (token == NULL) return (MemExpr){0};
 
             if (token->tok == L_SQUARE_T) {
-                return parse_mem_expr(token_line, R_SQUARE_T);
+                return parse_mem_expr(assembler, token_line, R_SQUARE_T);
             }
 
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
 
             return (MemExpr){0};
         case L_PAREN_T:
-            return parse_mem_expr(token_line, R_PAREN_T);
+            return parse_mem_expr(assembler, token_line, R_PAREN_T);
         case L_CURLY_T:
-            return parse_mem_expr(token_line, R_CURLY_T);
+            return parse_mem_expr(assembler, token_line, R_CURLY_T);
         default:
             assert(0 && "unreachable");
     }
@@ -226,7 +243,7 @@ static MemExpr parse_mem_addr(Token* prev_token, vec_iter_t token_line) {
     return (MemExpr){0};
 }
 
-static inline void parse_load_imm(Token* token) {
+static inline void parse_load_imm(Assembler* assembler, Token* token) {
     uint8_t imm = parse_immediate(token);
     if (imm == 0) {
         PUSH_OP(OP_CLRA);
@@ -238,7 +255,7 @@ static inline void parse_load_imm(Token* token) {
 
 #define PARSE_CASE_LABEL_IDX(op)                                                     \
     case LABEL_IDX_T: {                                                              \
-        MemExpr expr = parse_mem_addr(token, token_line);                            \
+        MemExpr expr = parse_mem_addr(assembler, token, token_line);                 \
         switch (expr.mode) {                                                         \
             case INVALID_MM:                                                         \
                 /* we can break here because any errors will                         \
@@ -255,14 +272,14 @@ static inline void parse_load_imm(Token* token) {
                 break;                                                               \
             case L_MM:                                                               \
             case BP_MM:                                                              \
-                printError(expr.mode_token, INVALID_MEMORY_IDX_INDEX_E, &assembler); \
+                reportError(expr.mode_token, INVALID_MEMORY_IDX_INDEX_E, assembler); \
                 break;                                                               \
         }                                                                            \
     }; break;
 
 #define PARSE_CASE_L_PAREN(op)                                                   \
     case L_PAREN_T: {                                                            \
-        MemExpr expr = parse_mem_addr(token, token_line);                        \
+        MemExpr expr = parse_mem_addr(assembler, token, token_line);             \
         switch (expr.mode) {                                                     \
             case INVALID_MM:                                                     \
                 break;                                                           \
@@ -289,14 +306,14 @@ static inline void parse_load_imm(Token* token) {
                 }                                                                \
                 break;                                                           \
             case BP_MM:                                                          \
-                printError(expr.mode_token, INVALID_MEMORY_INDEX_E, &assembler); \
+                reportError(expr.mode_token, INVALID_MEMORY_INDEX_E, assembler); \
                 break;                                                           \
         }                                                                        \
     }; break;
 
 #define PARSE_CASE_L_CURLY(op)                                                  \
     case L_CURLY_T: {                                                           \
-        MemExpr expr = parse_mem_addr(token, token_line);                       \
+        MemExpr expr = parse_mem_addr(assembler, token, token_line);            \
         switch (expr.mode) {                                                    \
             case INVALID_MM:                                                    \
                 /* we can break here because any errors will                    \
@@ -305,7 +322,7 @@ static inline void parse_load_imm(Token* token) {
             case IMM_MM:                                                        \
             case HL_MM:                                                         \
             case L_MM:                                                          \
-                printError(expr.mode_token, INVALID_STACK_INDEX_E, &assembler); \
+                reportError(expr.mode_token, INVALID_STACK_INDEX_E, assembler); \
                 break;                                                          \
             case BP_MM:                                                         \
                 PUSH_OP(OP_##op##_BPI);                                         \
@@ -314,8 +331,8 @@ static inline void parse_load_imm(Token* token) {
         }                                                                       \
     }; break;
 
-static void parse_load(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static void parse_load(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -330,16 +347,16 @@ static void parse_load(vec_iter_t token_line) {
         case OCTAL_T:
         case INTEGER_T:
         case HEXADECIMAL_T:
-            parse_load_imm(token);
+            parse_load_imm(assembler, token);
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_store(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_store(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -351,13 +368,13 @@ static inline void parse_store(vec_iter_t token_line) {
         PARSE_CASE_L_PAREN(STORE);
         PARSE_CASE_L_CURLY(STORE);
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_xch(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_xch(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -372,17 +389,17 @@ static inline void parse_xch(vec_iter_t token_line) {
         case OCTAL_T:
         case INTEGER_T:
         case HEXADECIMAL_T:
-            parse_load_imm(token);
+            parse_load_imm(assembler, token);
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
 #define PARSE_ALU_CASE_LABEL_IDX(op)                                             \
     case LABEL_IDX_T: {                                                          \
-        MemExpr expr = parse_mem_addr(token, token_line);                        \
+        MemExpr expr = parse_mem_addr(assembler, token, token_line);             \
         switch (expr.mode) {                                                     \
             case INVALID_MM:                                                     \
                 break;                                                           \
@@ -398,14 +415,14 @@ static inline void parse_xch(vec_iter_t token_line) {
                 break;                                                           \
             case L_MM:                                                           \
             case BP_MM:                                                          \
-                printError(expr.mode_token, INVALID_MEMORY_INDEX_E, &assembler); \
+                reportError(expr.mode_token, INVALID_MEMORY_INDEX_E, assembler); \
                 break;                                                           \
         }                                                                        \
     }; break;
 
 #define PARSE_ALU_CASE_L_PAREN(op)                                               \
     case L_PAREN_T: {                                                            \
-        MemExpr expr = parse_mem_addr(token, token_line);                        \
+        MemExpr expr = parse_mem_addr(assembler, token, token_line);             \
         switch (expr.mode) {                                                     \
             case INVALID_MM:                                                     \
                 break;                                                           \
@@ -433,14 +450,14 @@ static inline void parse_xch(vec_iter_t token_line) {
                 }                                                                \
                 break;                                                           \
             case BP_MM:                                                          \
-                printError(expr.mode_token, INVALID_MEMORY_INDEX_E, &assembler); \
+                reportError(expr.mode_token, INVALID_MEMORY_INDEX_E, assembler); \
                 break;                                                           \
         }                                                                        \
     }; break;
 
 #define PARSE_ACC_ALU(op)                                          \
     {                                                              \
-        Token* token = nextToken(&token_line);                     \
+        Token* token = nextToken(assembler, &token_line);          \
         if (token == NULL) return;                                 \
                                                                    \
         switch (token->tok) {                                      \
@@ -460,14 +477,14 @@ static inline void parse_xch(vec_iter_t token_line) {
                 PUSH_IMM8(parse_immediate(token));                 \
                 break;                                             \
             default:                                               \
-                printError(token, UNEXPECTED_TOKEN_E, &assembler); \
+                reportError(token, UNEXPECTED_TOKEN_E, assembler); \
                 break;                                             \
         }                                                          \
     }
 
 #define PARSE_HL_ALU(op)                                           \
     {                                                              \
-        Token* token = nextToken(&token_line);                     \
+        Token* token = nextToken(assembler, &token_line);          \
         if (token == NULL) return;                                 \
                                                                    \
         switch (token->tok) {                                      \
@@ -481,14 +498,14 @@ static inline void parse_xch(vec_iter_t token_line) {
             PARSE_ALU_CASE_L_PAREN(op);                            \
             PARSE_CASE_L_CURLY(op);                                \
             default:                                               \
-                printError(token, UNEXPECTED_TOKEN_E, &assembler); \
+                reportError(token, UNEXPECTED_TOKEN_E, assembler); \
                 break;                                             \
         }                                                          \
     }
 
 #define PARSE_SHIFT_ALU(op)                                        \
     {                                                              \
-        Token* token = nextToken(&token_line);                     \
+        Token* token = nextToken(assembler, &token_line);          \
         if (token == NULL) return;                                 \
                                                                    \
         switch (token->tok) {                                      \
@@ -507,14 +524,14 @@ static inline void parse_xch(vec_iter_t token_line) {
                 PUSH_IMM8(parse_immediate(token));                 \
                 break;                                             \
             default:                                               \
-                printError(token, UNEXPECTED_TOKEN_E, &assembler); \
+                reportError(token, UNEXPECTED_TOKEN_E, assembler); \
                 break;                                             \
         }                                                          \
     }
 
 #define PARSE_WIDE(op)                                                 \
     {                                                                  \
-        Token* token = nextToken(&token_line);                         \
+        Token* token = nextToken(assembler, &token_line);              \
         if (token == NULL) return;                                     \
                                                                        \
         switch (token->tok) {                                          \
@@ -530,17 +547,17 @@ static inline void parse_xch(vec_iter_t token_line) {
                 break;                                                 \
             case L_PAREN_T:                                            \
             case L_CURLY_T:                                            \
-                printError(token, INVALID_OPERAND_TYPE_E, &assembler); \
+                reportError(token, INVALID_OPERAND_TYPE_E, assembler); \
                 break;                                                 \
             default:                                                   \
-                printError(token, UNEXPECTED_TOKEN_E, &assembler);     \
+                reportError(token, UNEXPECTED_TOKEN_E, assembler);     \
                 break;                                                 \
         }                                                              \
     }
 
 #define PARSE_JMP(op)                                              \
     {                                                              \
-        Token* token = nextToken(&token_line);                     \
+        Token* token = nextToken(assembler, &token_line);          \
         if (token == NULL) return;                                 \
                                                                    \
         switch (token->tok) {                                      \
@@ -557,13 +574,13 @@ static inline void parse_xch(vec_iter_t token_line) {
                 break;                                             \
             }                                                      \
             default:                                               \
-                printError(token, UNEXPECTED_TOKEN_E, &assembler); \
+                reportError(token, UNEXPECTED_TOKEN_E, assembler); \
                 break;                                             \
         }                                                          \
     }
 
-static inline void parse_jext(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_jext(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
     uint8_t flags;
 
@@ -574,12 +591,12 @@ static inline void parse_jext(vec_iter_t token_line) {
         case HEXADECIMAL_T:
             flags = parse_immediate(token);
 
-            token = nextToken(&token_line);
+            token = nextToken(assembler, &token_line);
             if (token == NULL) return;
 
             switch (token->tok) {
                 case COMMA_T:
-                    token = nextToken(&token_line);
+                    token = nextToken(assembler, &token_line);
                     if (token == NULL) return;
 
                     switch (token->tok) {
@@ -598,24 +615,24 @@ static inline void parse_jext(vec_iter_t token_line) {
                             break;
                         }
                         default:
-                            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+                            reportError(token, UNEXPECTED_TOKEN_E, assembler);
                             break;
                     }
                     break;
                 default:
-                    printError(token, EXPECTED_COMMA_E, &assembler);
+                    reportError(token, EXPECTED_COMMA_E, assembler);
                     break;
             }
             break;
 
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_push(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_push(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -634,16 +651,16 @@ static inline void parse_push(vec_iter_t token_line) {
             PUSH_IMM8(parse_immediate(token));
             break;
         case L_PAREN_T:
-            printError(token, INVALID_OPERAND_TYPE_E, &assembler);
+            reportError(token, INVALID_OPERAND_TYPE_E, assembler);
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_pop(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_pop(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -656,16 +673,16 @@ static inline void parse_pop(vec_iter_t token_line) {
         PARSE_CASE(POP, FLAGS);
         case L_PAREN_T:
         case L_CURLY_T:
-            printError(token, INVALID_OPERAND_TYPE_E, &assembler);
+            reportError(token, INVALID_OPERAND_TYPE_E, assembler);
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_call(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_call(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -685,12 +702,12 @@ static inline void parse_call(vec_iter_t token_line) {
             break;
         }
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_ret(vec_iter_t token_line) {
+static inline void parse_ret(Assembler* assembler, vec_iter_t token_line) {
     Token* token = iter_next(&token_line);
     if (token == NULL || token->tok == COMMENT_T) {
         PUSH_OP(OP_RET);
@@ -706,13 +723,13 @@ static inline void parse_ret(vec_iter_t token_line) {
             PUSH_IMM8(parse_immediate(token));
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static inline void parse_enter(vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static inline void parse_enter(Assembler* assembler, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     switch (token->tok) {
@@ -724,17 +741,17 @@ static inline void parse_enter(vec_iter_t token_line) {
             PUSH_IMM8(parse_immediate(token));
             break;
         default:
-            printError(token, UNEXPECTED_TOKEN_E, &assembler);
+            reportError(token, UNEXPECTED_TOKEN_E, assembler);
             break;
     }
 }
 
-static void parse_label_ref(Token* label_t, vec_iter_t token_line) {
-    Token* token = nextToken(&token_line);
+static void parse_label_ref(Assembler* assembler, Token* label_t, vec_iter_t token_line) {
+    Token* token = nextToken(assembler, &token_line);
     if (token == NULL) return;
 
     if (token->tok == EQUALS_T) {
-        token = nextToken(&token_line);
+        token = nextToken(assembler, &token_line);
         if (token == NULL) return;
 
         switch (token->tok) {
@@ -742,28 +759,24 @@ static void parse_label_ref(Token* label_t, vec_iter_t token_line) {
             case OCTAL_T:
             case INTEGER_T:
             case HEXADECIMAL_T: {
-                size_t val = parse_immediate(token);
-                // label refs start with . which is included in the token substr
-                slice_t label =
-                    (slice_t){.str = label_t->substr.str + 1, .len = label_t->substr.len - 1};
-                insert_map(&assembler.label_def_map, label, val);
+                defineLabel(assembler, label_t->label, parse_immediate(token), true);
                 break;
             }
             default:
-                printError(token, UNEXPECTED_TOKEN_E, &assembler);
+                reportError(token, UNEXPECTED_TOKEN_E, assembler);
         }
     } else {
-        printError(token, UNEXPECTED_EOL_E, &assembler);
+        reportError(token, UNEXPECTED_EOL_E, assembler);
     }
 
     return;
 }
 
-static void assembleLinePass1(TokenLine* line) {
-    assembler.line_nr = line->line_nr;
-    assembler.line = line->substr;
+static void assembleLinePass1(Assembler* assembler, TokenLine* line) {
+    assembler->line_nr = line->line_nr;
+    assembler->line = line->substr;
 
-    vec_iter_t token_line = iter_from_vec(&line->tokens);
+    vec_iter_t token_line = iterTokenLine(&assembler->token_lines, line);
 
     Token* token = iter_next(&token_line);
     if (token == NULL) return;
@@ -793,14 +806,17 @@ static void assembleLinePass1(TokenLine* line) {
         case LEAVE_T:
             HANDLE_BASIC_OP(LEAVE);
             break;
+        case WAIT_T:
+            HANDLE_BASIC_OP(WAIT);
+            break;
         case LOAD_T:
-            parse_load(token_line);
+            parse_load(assembler, token_line);
             break;
         case STORE_T:
-            parse_store(token_line);
+            parse_store(assembler, token_line);
             break;
         case XCH_T:
-            parse_xch(token_line);
+            parse_xch(assembler, token_line);
             break;
         case ADD_T:
             PARSE_ACC_ALU(ADD);
@@ -881,25 +897,25 @@ static void assembleLinePass1(TokenLine* line) {
             PARSE_JMP(JNC);
             break;
         case JEXT_T:
-            parse_jext(token_line);
+            parse_jext(assembler, token_line);
             break;
         case CMP_T:
             PARSE_ACC_ALU(CMP);
             break;
         case PUSH_T:
-            parse_push(token_line);
+            parse_push(assembler, token_line);
             break;
         case POP_T:
-            parse_pop(token_line);
+            parse_pop(assembler, token_line);
             break;
         case CALL_T:
-            parse_call(token_line);
+            parse_call(assembler, token_line);
             break;
         case RET_T:
-            parse_ret(token_line);
+            parse_ret(assembler, token_line);
             break;
         case ENTER_T:
-            parse_enter(token_line);
+            parse_enter(assembler, token_line);
             break;
         case MIN_T:
             PARSE_SHIFT_ALU(MIN);
@@ -908,9 +924,9 @@ static void assembleLinePass1(TokenLine* line) {
             PARSE_SHIFT_ALU(MAX);
             break;
         case UNKNOWN_T:
-            printError(token, UNKNOWN_TOKEN_E, &assembler);
+            reportError(token, UNKNOWN_TOKEN_E, assembler);
             while ((token = iter_next(&token_line))) {
-                if (is_token_unknown(token->tok)) printError(token, UNKNOWN_TOKEN_E, &assembler);
+                if (is_token_unknown(token->tok)) reportError(token, UNKNOWN_TOKEN_E, assembler);
             }
             break;
         case INTEGER_T:
@@ -919,7 +935,7 @@ static void assembleLinePass1(TokenLine* line) {
         case HEXADECIMAL_T:
             do {
                 uint16_t imm = parse_immediate(token);
-                if (imm > 255) printWarning(token, U8_OVERFLOW_W, &assembler);
+                if (imm > 255) reportWarning(token, U8_OVERFLOW_W, assembler);
 
                 PUSH_IMM8(imm);
             } while ((token = iter_next(&token_line)) && is_token_immediate(token->tok));
@@ -930,14 +946,11 @@ static void assembleLinePass1(TokenLine* line) {
                 PUSH_IMM8(token->substr.str[i]);
             }
             break;
-        case LABEL_DEF_T: {
-            // label defs end with : which is included in the token substr
-            slice_t label = (slice_t){.str = token->substr.str, .len = token->substr.len - 1};
-            insert_map(&assembler.label_def_map, label, assembler.compiled.len);
+        case LABEL_DEF_T:
+            defineLabel(assembler, token->label, assembler->compiled.len, false);
             break;
-        }
         case LABEL_REF_T:
-            parse_label_ref(token, token_line);
+            parse_label_ref(assembler, token, token_line);
             break;
         case COMMENT_T:
             break;
@@ -963,69 +976,601 @@ static void assembleLinePass1(TokenLine* line) {
         case R_PAREN_T:
         case L_CURLY_T:
         case R_CURLY_T:
-            printError(token, EXPECTED_OPERATOR_E, &assembler);
+            reportError(token, EXPECTED_OPERATOR_E, assembler);
     }
 }
 
 /// Compile the assembled tokens into an executable with placeholder zeroes in place of labeled
 /// jumps and memory access. Those will be filled out in pass 2.
-static void assemblePass1() {
-    vec_iter_t token_lines = iter_from_vec(&assembler.token_lines);
+static void assemblePass1(Assembler* assembler) {
+    vec_iter_t token_lines = iter_from_vec(&assembler->token_lines.lines);
     TokenLine* line;
 
     while ((line = iter_next(&token_lines))) {
-        assembleLinePass1(line);
+        const size_t start = assembler->compiled.len;
+
+        assembleLinePass1(assembler, line);
+
+        // lines that only define labels or constants don't produce any bytes
+        if (assembler->compiled.len > start) {
+            const Token* first = firstToken(&assembler->token_lines, line);
+            LineEntry entry = (LineEntry){.addr = (uint16_t)start,
+                                          .column = (uint16_t)(first->char_nr + 1),
+                                          .line = (uint32_t)line->line_nr};
+            push_vec(&assembler->debug_info.lines, &entry);
+        }
     }
+}
+
+/// Ends the program once every line went through pass 1
+static void finishPass1(Assembler* assembler) {
+    LineEntry halt = (LineEntry){.addr = (uint16_t)assembler->compiled.len, .column = 0, .line = 0};
+    push_vec(&assembler->debug_info.lines, &halt);
 
     // always add a HALT right at the end, might not keep this
     PUSH_OP(OP_HALT);
 }
 
+/// Fills the label map handed to the Executable with every label that got defined
+static void collectLabels(Assembler* assembler) {
+    for (uint32_t id = 0; id < labelCount(&assembler->token_lines); ++id) {
+        const size_t addr = ((LabelDef*)get_vec(&assembler->label_addrs, id))->addr;
+        if (addr != LABEL_UNDEFINED) {
+            insert_map(&assembler->label_def_map, labelName(&assembler->token_lines, id), addr);
+        }
+    }
+}
+
 /// Takes the compiled program currently in the Assembler and works out the jump locations
-static void assemblePass2() {
+static void assemblePass2(Assembler* assembler) {
     LabelRef* ref;
-    vec_iter_t label_refs = iter_from_vec(&assembler.label_ref_list);
+    vec_iter_t label_refs = iter_from_vec(&assembler->label_ref_list);
 
     while ((ref = iter_next(&label_refs))) {
-        assembler.line = ref->line;
-        assembler.line_nr = ref->line_nr;
+        assembler->line = ref->line;
+        assembler->line_nr = ref->line_nr;
 
-        size_t* idx = get_map(&assembler.label_def_map, ref->label);
+        const size_t* idx = &((LabelDef*)get_vec(&assembler->label_addrs, ref->label))->addr;
 
-        if (idx == NULL) {
-            Token tok = (Token){.tok = LABEL_REF_T, .char_nr = ref->col_nr, .substr = ref->label};
-            printError(&tok, UNDEFINED_LABEL_E, &assembler);
+        if (*idx == LABEL_UNDEFINED) {
+            Token tok = (Token){.tok = LABEL_REF_T,
+                                .label = ref->label,
+                                .char_nr = ref->col_nr,
+                                .substr = labelName(&assembler->token_lines, ref->label)};
+            reportError(&tok, UNDEFINED_LABEL_E, assembler);
         } else {
             size_t idx_jmp_from_high = ref->idx;     // label location high byte
             size_t idx_jmp_from_low = ref->idx + 1;  // low byte
 
             // These might be non-zero if working with an indexed label
-            uint8_t base_high = *(uint8_t*)get_vec(&assembler.compiled, idx_jmp_from_high);
-            uint8_t base_low = *(uint8_t*)get_vec(&assembler.compiled, idx_jmp_from_low);
+            uint8_t base_high = *(uint8_t*)get_vec(&assembler->compiled, idx_jmp_from_high);
+            uint8_t base_low = *(uint8_t*)get_vec(&assembler->compiled, idx_jmp_from_low);
 
             uint8_t jmp_to_high = base_high + (uint8_t)((*idx >> 8) & 0xFF);
             uint8_t jmp_to_low = base_low + (uint8_t)(*idx & 0xFF);
 
             // set bytes of label location
-            set_vec(&assembler.compiled, &jmp_to_high, idx_jmp_from_high);
-            set_vec(&assembler.compiled, &jmp_to_low, idx_jmp_from_low);
+            set_vec(&assembler->compiled, &jmp_to_high, idx_jmp_from_high);
+            set_vec(&assembler->compiled, &jmp_to_low, idx_jmp_from_low);
         }
     }
 }
 
-Executable assemble(slice_t program, slice_t filename) {
-    TokenLines lines = tokenizeProgram(program);
+static void noHook(AssemblerPhase phase, void* data) {
+    (void)phase;
+    (void)data;
+}
+
+/// One piece of a source that gets tokenized and goes through pass 1 by itself, possibly on a
+/// thread of its own. Its addresses start at 0 and its lines at 1 until `mergeChunks` moves them to
+/// where the chunk ends up.
+typedef struct Chunk {
+    // the text of the chunk, part of the source or a copy of it that the chunk keeps. Until the
+    // chunk is tokenized it runs on to the end of the source.
+    slice_t src;
+    // where the chunk's text is in the source being assembled, only differs from `src.str` for
+    // copies. Everything handed to the Executable points into the source, never into a copy.
+    const char* text;
+    slice_t path;
+    Arena* scratch;
+    TokenLines lines;
+    // where the chunk is meant to end, its last line can run on past it
+    size_t until;
+    // the source ends in this chunk because of a NUL, later chunks are ignored
+    bool ends_program;
+    // lines in the chunks before this one
+    size_t line_offset;
+    Assembler assembler;
+    // where the chunk's output goes in the whole program, set by `mergeChunks`
+    Assembler* merged;
+    // global id of every label id in this chunk, NULL when they already are the global ones
+    const uint32_t* ids;
+    size_t base;
+    size_t first_ref;
+    size_t first_line;
+} Chunk;
+
+// The same part of the source as `s`, which points into the chunk's own text
+static slice_t moveSlice(const Chunk* chunk, slice_t s) {
+    return from_cstr_slice(chunk->text + (s.str - chunk->src.str), s.len);
+}
+
+static void* tokenizeChunk(void* data) {
+    Chunk* chunk = (Chunk*)data;
+
+    if (chunk->scratch == NULL) {
+        chunk->scratch = newArena(max(DEFAULT_ARENA_CHUNK_SIZE, chunk->until * 8));
+    }
+
+    // the tokenizer sees the rest of the source just like it does in one piece, so a string
+    // spanning lines carries the chunk on to where its line ends, and a NUL only ends the source
+    // where the tokenizer actually stops at it
+    size_t tokenized;
+    chunk->lines = tokenizeLinesUntil(chunk->src, chunk->until, chunk->scratch, &tokenized);
+    chunk->ends_program = tokenized < chunk->src.len && chunk->src.str[tokenized] == '\0';
+    chunk->src.len = tokenized;
+
+    return NULL;
+}
+
+static void* assembleChunk(void* data) {
+    Chunk* chunk = (Chunk*)data;
+
+    initAssembler(&chunk->assembler, chunk->path, chunk->scratch, chunk->lines, chunk->scratch, 0);
+    assemblePass1(&chunk->assembler);
+
+    return NULL;
+}
+
+static void freeChunk(Chunk* chunk) {
+    free_vec(&chunk->assembler.compiled, NULL);
+    freeDebugInfo(&chunk->assembler.debug_info);
+    freeArena(chunk->scratch);
+    chunk->scratch = NULL;
+}
+
+/// Runs `work` on every chunk at once, the calling thread takes the first one
+static void runOnChunks(void* (*work)(void*), Chunk* chunks, size_t count) {
+    pthread_t threads[MAX_CHUNKS];
+    bool started[MAX_CHUNKS] = {false};
+
+    if (count == 0) {
+        return;
+    }
+
+    for (size_t i = 1; i < count; ++i) {
+        started[i] = pthread_create(&threads[i], NULL, work, &chunks[i]) == 0;
+    }
+
+    work(&chunks[0]);
+
+    for (size_t i = 1; i < count; ++i) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            work(&chunks[i]);
+        }
+    }
+}
+
+/// Splits `program` into `count` pieces of about the same size, each meant to end right after a
+/// newline
+static void splitSource(slice_t program, slice_t path, Chunk* chunks, size_t count) {
+    const char* start = program.str;
+    const char* end = program.str + program.len;
+
+    for (size_t i = 0; i < count; ++i) {
+        const char* split = end;
+
+        if (i + 1 < count) {
+            // a long line can carry the previous chunk past this one's share
+            const size_t offset =
+                max((size_t)(start - program.str), program.len * (i + 1) / count);
+            const char* newline = memchr(program.str + offset, '\n', program.len - offset);
+            split = newline != NULL ? newline + 1 : end;
+        }
+
+        chunks[i] = (Chunk){.src = from_cstr_slice(start, (size_t)(end - start)),
+                            .text = start,
+                            .path = path,
+                            .scratch = NULL,
+                            .until = (size_t)(split - start)};
+        start = split;
+    }
+}
+
+/// Copies the chunk's bytes, label references and line entries to their place in the merged
+/// program. The chunks all write to different parts of it, so they can do this at the same time.
+static void* copyChunk(void* data) {
+    Chunk* chunk = (Chunk*)data;
+    const Assembler* part = &chunk->assembler;
+    Assembler* merged = chunk->merged;
+
+    memcpy((uint8_t*)merged->compiled.ptr + chunk->base, part->compiled.ptr, part->compiled.len);
+
+    const LabelRef* refs = part->label_ref_list.ptr;
+    LabelRef* moved_refs = (LabelRef*)merged->label_ref_list.ptr + chunk->first_ref;
+    for (size_t i = 0; i < len_vec(&part->label_ref_list); ++i) {
+        moved_refs[i] = refs[i];
+        moved_refs[i].label = chunk->ids != NULL ? chunk->ids[refs[i].label] : refs[i].label;
+        moved_refs[i].idx += chunk->base;
+        moved_refs[i].line = moveSlice(chunk, refs[i].line);
+        moved_refs[i].line_nr += chunk->line_offset;
+    }
+
+    const LineEntry* lines = part->debug_info.lines.ptr;
+    LineEntry* moved_lines = (LineEntry*)merged->debug_info.lines.ptr + chunk->first_line;
+    for (size_t i = 0; i < len_vec(&part->debug_info.lines); ++i) {
+        moved_lines[i] = lines[i];
+        moved_lines[i].addr = (uint16_t)(lines[i].addr + chunk->base);
+        moved_lines[i].line = (uint32_t)(lines[i].line + chunk->line_offset);
+    }
+
+    return NULL;
+}
+
+/// Puts what pass 1 produced for every chunk together in `assembler`, moving the addresses of
+/// labels, label references and lines to where they end up in the whole program. With `scratch`
+/// NULL the first chunk's scratch arena and label ids become the merged program's, that chunk can't
+/// be merged again after that.
+static void mergeChunks(Assembler* assembler, slice_t filename, Chunk* chunks, size_t count,
+                        Arena* scratch, Arena* labels) {
+    TokenLines merged;
+    size_t first_foreign = 0;
+
+    if (scratch == NULL) {
+        scratch = chunks[0].scratch;
+        merged = chunks[0].lines;
+        merged.line_count = 0;
+        chunks[0].ids = NULL;
+        first_foreign = 1;
+    } else {
+        merged = newTokenLines(scratch, 1, 1);
+    }
+
+    // the other chunks gave their own ids to the names they came across
+    for (size_t c = first_foreign; c < count; ++c) {
+        const TokenLines* lines = &chunks[c].lines;
+        uint32_t* ids = arenaAlloc(scratch, labelCount(lines) * sizeof(uint32_t));
+
+        for (uint32_t id = 0; id < labelCount(lines); ++id) {
+            ids[id] = internLabelName(&merged, moveSlice(&chunks[c], labelName(lines, id)));
+        }
+        chunks[c].ids = ids;
+    }
+
+    initAssembler(assembler, filename, scratch, merged, labels, PROGRAM_START);
+
+    size_t base = PROGRAM_START;
+    size_t refs = 0;
+    size_t lines = 0;
+    for (size_t c = 0; c < count; ++c) {
+        Chunk* chunk = &chunks[c];
+        const Assembler* part = &chunk->assembler;
+
+        chunk->merged = assembler;
+        chunk->base = base;
+        chunk->first_ref = refs;
+        chunk->first_line = lines;
+        base += part->compiled.len;
+        refs += len_vec(&part->label_ref_list);
+        lines += len_vec(&part->debug_info.lines);
+        assembler->token_lines.line_count += chunk->lines.line_count;
+
+        // going through the chunks in order keeps the first definition of every label
+        for (uint32_t id = 0; id < len_vec(&part->label_addrs); ++id) {
+            const LabelDef* def = get_vec(&part->label_addrs, id);
+            if (def->addr != LABEL_UNDEFINED) {
+                const uint32_t global = chunk->ids != NULL ? chunk->ids[id] : id;
+                const size_t addr = def->constant ? def->addr : def->addr + chunk->base;
+                defineLabel(assembler, global, addr, def->constant);
+            }
+        }
+
+        vec_iter_t diagnostics = iter_from_vec(&part->diagnostics);
+        Diagnostic* diag;
+        while ((diag = iter_next(&diagnostics))) {
+            Diagnostic moved = *diag;
+            moved.token.substr = moveSlice(chunk, diag->token.substr);
+            moved.line = moveSlice(chunk, diag->line);
+            moved.line_nr += chunk->line_offset;
+            push_vec(&assembler->diagnostics, &moved);
+        }
+    }
+
+    // leaves room for the HALT and its line entry that `finishPass1` adds
+    reserve_vec(&assembler->compiled, base + 1);
+    reserve_vec(&assembler->label_ref_list, refs);
+    reserve_vec(&assembler->debug_info.lines, lines + 1);
+    assembler->compiled.len = base;
+    assembler->label_ref_list.len = refs;
+    assembler->debug_info.lines.len = lines;
+
+    runOnChunks(copyChunk, chunks, min(count, MAX_CHUNKS));
+    for (size_t c = MAX_CHUNKS; c < count; ++c) {
+        copyChunk(&chunks[c]);
+    }
+}
+
+/// A newline a chunk starts after can be inside a line of the whole source, like a string spanning
+/// lines. The chunks the line before ran into are tokenized again from where it really ended.
+/// Returns the number of chunks up to the one a NUL ended the source in.
+static size_t alignChunks(Chunk* chunks, size_t count, const char* end) {
+    size_t used = 1;
+
+    while (used < count && !chunks[used - 1].ends_program) {
+        const Chunk* prev = &chunks[used - 1];
+        Chunk* chunk = &chunks[used++];
+        const char* start = prev->src.str + prev->src.len;
+
+        if (start != chunk->src.str) {
+            const char* until = chunk->src.str + chunk->until;
+            freeArena(chunk->scratch);
+            *chunk = (Chunk){.src = from_cstr_slice(start, (size_t)(end - start)),
+                             .text = start,
+                             .path = chunk->path,
+                             .scratch = NULL,
+                             .until = until > start ? (size_t)(until - start) : 0};
+            tokenizeChunk(chunk);
+        }
+    }
+
+    return used;
+}
+
+/// Tokenizes and runs pass 1 on `count` chunks of `program` at once, then merges them into
+/// `assembler` as if it had gone through pass 1 in one piece
+static void assembleChunks(Assembler* assembler, slice_t program, slice_t filename, size_t count,
+                           Arena* labels, PhaseHook hook, void* data) {
+    Chunk chunks[MAX_CHUNKS];
+
+    hook(TOKENIZE_PHASE, data);
+    splitSource(program, filename, chunks, count);
+    runOnChunks(tokenizeChunk, chunks, count);
+    const size_t used = alignChunks(chunks, count, program.str + program.len);
+
+    hook(PASS1_PHASE, data);
+    size_t line_offset = 0;
+    for (size_t c = 0; c < used; ++c) {
+        chunks[c].line_offset = line_offset;
+        line_offset += chunks[c].lines.line_count;
+    }
+    // what comes after a NUL never gets tokenized when the source is assembled in one piece
+    for (size_t c = used; c < count; ++c) {
+        freeArena(chunks[c].scratch);
+    }
+
+    runOnChunks(assembleChunk, chunks, used);
+    mergeChunks(assembler, filename, chunks, used, NULL, labels);
+
+    // the merged program took over the first chunk's arena
+    chunks[0].scratch = NULL;
+    for (size_t c = 0; c < used; ++c) {
+        freeChunk(&chunks[c]);
+    }
+}
+
+// Number of chunks `assemble` splits a source of `len` bytes into, one per core
+static size_t chunkCount(size_t len) {
+#ifdef _SC_NPROCESSORS_ONLN
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return min(min(cores > 0 ? (size_t)cores : 1, len / MIN_CHUNK_SIZE), MAX_CHUNKS);
+#else
+    (void)len;
+    return 1;
+#endif
+}
 
-    initAssembler(&assembler, filename, lines);
+/// Pass 2 and what comes after it, hands everything `assembler` built over to the Executable
+static Executable finishAssembly(Assembler* assembler, Arena* labels, PhaseHook hook,
+                                 void* data) {
+    finishPass1(assembler);
 
-    assemblePass1();
-    assemblePass2();
+    hook(PASS2_PHASE, data);
+    assemblePass2(assembler);
+    collectLabels(assembler);
 
-    Executable exec =
-        (Executable){.executable = assembler.compiled.ptr, .size = assembler.compiled.len};
+    freeSymbols(&assembler->debug_info.symbols);
+    assembler->debug_info.symbols =
+        symbolsFromLabels(&assembler->label_def_map, assembler->compiled.len);
 
-    freeAssembler(&assembler);
-    freeTokenLines(&lines);
+    Executable exec = (Executable){.executable = assembler->compiled.ptr,
+                                   .size = assembler->compiled.len,
+                                   .labels = assembler->label_def_map,
+                                   .arena = labels,
+                                   .debug_info = assembler->debug_info,
+                                   .diagnostics = assembler->diagnostics};
+
+    freeAssembler(assembler);
+    hook(DONE_PHASE, data);
 
     return exec;
 }
+
+Executable assemble(slice_t program, slice_t filename) {
+    return assembleWithHook(program, filename, noHook, NULL);
+}
+
+Executable assembleWithHook(slice_t program, slice_t filename, PhaseHook hook, void* data) {
+    return assembleInChunks(program, filename, chunkCount(program.len), hook, data);
+}
+
+Executable assembleInChunks(slice_t program, slice_t filename, size_t chunks, PhaseHook hook,
+                            void* data) {
+    // all the state of this assembly, nothing is shared with others running at the same time
+    Assembler assembler;
+    Arena* labels = newArena(DEFAULT_ARENA_CHUNK_SIZE / 4);
+
+    if (hook == NULL) {
+        hook = noHook;
+    }
+
+    if (chunks > 1) {
+        assembleChunks(&assembler, program, filename, min(chunks, MAX_CHUNKS), labels, hook, data);
+    } else {
+        hook(TOKENIZE_PHASE, data);
+        // sized so the token arrays and label references of typical sources fit in the first chunk
+        Arena* scratch = newArena(max(DEFAULT_ARENA_CHUNK_SIZE, program.len * 8));
+        TokenLines lines = tokenizeProgram(program, scratch);
+
+        hook(PASS1_PHASE, data);
+        initAssembler(&assembler, filename, scratch, lines, labels, PROGRAM_START);
+        assemblePass1(&assembler);
+    }
+
+    return finishAssembly(&assembler, labels, hook, data);
+}
+
+void initAssemblySession(AssemblySession* session, slice_t path) {
+    session->path = from_cstr_str(path.str, path.len);
+    session->chunks = new_vec(16, sizeof(Chunk));
+}
+
+void freeAssemblySession(AssemblySession* session) {
+    if (session != NULL) {
+        vec_iter_t chunks = iter_from_vec(&session->chunks);
+        Chunk* chunk;
+        while ((chunk = iter_next(&chunks))) {
+            freeChunk(chunk);
+        }
+        free_vec(&session->chunks, NULL);
+        free_str(&session->path);
+    }
+}
+
+// Whether the chunk's text is at `offset` in `program` and tokenizes the same way there. Every
+// chunk but the last ends where a line starts, whatever comes after it. The last one ended at a NUL
+// or at the end of the source and has to end there again.
+static bool chunkUnchanged(const Chunk* chunk, bool last, slice_t program, size_t offset) {
+    const slice_t src = chunk->src;
+    const size_t end = offset + src.len;
+
+    if (end > program.len || memcmp(program.str + offset, src.str, src.len) != 0) {
+        return false;
+    }
+    if (!last) {
+        return true;
+    }
+    return chunk->ends_program ? end < program.len && program.str[end] == '\0'
+                               : end == program.len;
+}
+
+// Tokenizes and runs pass 1 on the part of `program` starting at `offset`, up to the first line
+// that starts `until` or more bytes after it
+static Chunk freshChunk(slice_t program, slice_t path, size_t offset, size_t until) {
+    Chunk chunk = (Chunk){.src = from_cstr_slice(program.str + offset, program.len - offset),
+                          .path = path,
+                          .scratch = NULL,
+                          .until = until};
+
+    // finds where the chunk ends first, the caller's buffer changes between calls so the chunk
+    // keeps its own copy of the text up to there
+    Arena* scratch = newArena(max(DEFAULT_ARENA_CHUNK_SIZE, until * 8));
+    size_t len;
+    tokenizeLinesUntil(chunk.src, until, scratch, &len);
+    freeArena(scratch);
+    const bool ends_program = len < chunk.src.len && chunk.src.str[len] == '\0';
+
+    // the copy tokenizes like the source did, nothing after `len` made a difference to it
+    chunk.scratch = newArena(max(DEFAULT_ARENA_CHUNK_SIZE, len * 9));
+    char* copy = arenaAlloc(chunk.scratch, len);
+    memcpy(copy, chunk.src.str, len);
+    chunk.src = from_cstr_slice(copy, len);
+    chunk.until = len;
+
+    tokenizeChunk(&chunk);
+    assembleChunk(&chunk);
+    chunk.ends_program = ends_program;
+
+    return chunk;
+}
+
+Executable reassemble(AssemblySession* session, slice_t program) {
+    const slice_t path = from_str_slice(session->path);
+    // the session's chunks are used up here, the ones that are kept move to the new list
+    Chunk* old = session->chunks.ptr;
+    const size_t old_count = len_vec(&session->chunks);
+
+    // the chunks at the start and at the end that didn't change are kept as they are
+    size_t front = 0;
+    size_t front_len = 0;
+    while (front < old_count &&
+           chunkUnchanged(&old[front], front + 1 == old_count, program, front_len)) {
+        front_len += old[front++].src.len;
+    }
+    // the last chunk ended the source, nothing after it gets tokenized
+    const bool ended = front > 0 && front == old_count;
+
+    size_t back = 0;
+    size_t back_len = 0;
+    while (!ended && front + back < old_count && !old[old_count - 1].ends_program) {
+        const Chunk* chunk = &old[old_count - 1 - back];
+        if (front_len + back_len + chunk->src.len > program.len ||
+            !chunkUnchanged(chunk, back == 0, program,
+                            program.len - back_len - chunk->src.len)) {
+            break;
+        }
+        back_len += old[old_count - 1 - back++].src.len;
+    }
+
+    // everything in between goes through the tokenizer and pass 1 again, in new chunks. A line
+    // that runs on into the chunks at the end, like after a quote was opened, changes how they
+    // tokenize, so they go through it again too.
+    vec_t chunks = new_vec(front + back + 8, sizeof(Chunk));
+    for (size_t c = 0; c < front; ++c) {
+        push_vec(&chunks, &old[c]);
+    }
+
+    size_t offset = front_len;
+    while (!ended && offset < program.len - back_len) {
+        const size_t until = min(program.len - back_len - offset, SESSION_CHUNK_SIZE);
+        Chunk chunk = freshChunk(program, path, offset, until);
+        push_vec(&chunks, &chunk);
+        offset += chunk.src.len;
+
+        while (back > 0 && program.len - back_len < offset) {
+            back_len -= old[old_count - back--].src.len;
+        }
+        if (chunk.ends_program) {
+            back = 0;
+            break;
+        }
+    }
+
+    for (size_t c = old_count - back; c < old_count; ++c) {
+        push_vec(&chunks, &old[c]);
+    }
+    for (size_t c = front; c < old_count - back; ++c) {
+        freeChunk(&old[c]);
+    }
+    free_vec(&session->chunks, NULL);
+    session->chunks = chunks;
+
+    Chunk* next = chunks.ptr;
+    size_t line_offset = 0;
+    offset = 0;
+    for (size_t c = 0; c < len_vec(&chunks); ++c) {
+        next[c].text = program.str + offset;
+        next[c].line_offset = line_offset;
+        offset += next[c].src.len;
+        line_offset += next[c].lines.line_count;
+    }
+
+    Assembler assembler;
+    Arena* labels = newArena(DEFAULT_ARENA_CHUNK_SIZE / 4);
+    mergeChunks(&assembler, path, next, len_vec(&chunks), newArena(DEFAULT_ARENA_CHUNK_SIZE),
+                labels);
+
+    return finishAssembly(&assembler, labels, noHook, NULL);
+}
+
+void freeExecutable(Executable* exec) {
+    if (exec != NULL) {
+        free(exec->executable);
+        freeDebugInfo(&exec->debug_info);
+        free_map(&exec->labels);
+        free_vec(&exec->diagnostics, NULL);
+        freeArena(exec->arena);
+        exec->arena = NULL;
+    }
+}
@@ -0,0 +1,91 @@
+#include "headers/breakpoints.h"
+
+#include <stdio.h>
+
+#include "headers/cpu.h"
+#include "headers/debug.h"
+#include "headers/instructions.h"
+
+void initBreakpoints(Breakpoints* bps, BreakpointHandler on_hit, void* data) {
+    bps->list = new_vec(8, sizeof(Breakpoint));
+    bps->on_hit = on_hit;
+    bps->data = data;
+}
+
+void freeBreakpoints(Breakpoints* bps) {
+    if (bps != NULL) {
+        free_vec(&bps->list, NULL);
+    }
+}
+
+static Breakpoint* findBreakpoint(const Breakpoints* bps, uint16_t addr) {
+    for (size_t i = 0; i < bps->list.len; ++i) {
+        Breakpoint* bp = get_vec(&bps->list, i);
+        if (bp->addr == addr) return bp;
+    }
+    return NULL;
+}
+
+bool setBreakpoint(CPU* cpu, uint16_t addr) {
+    if (findBreakpoint(cpu->breakpoints, addr) != NULL) return false;
+
+    Breakpoint bp = (Breakpoint){.addr = addr, .original = MEMORY(addr)};
+    push_vec(&cpu->breakpoints->list, &bp);
+    MEMORY(addr) = OP_BRK;
+
+    return true;
+}
+
+bool clearBreakpoint(CPU* cpu, uint16_t addr) {
+    Breakpoints* bps = cpu->breakpoints;
+
+    for (size_t i = 0; i < bps->list.len; ++i) {
+        Breakpoint* bp = get_vec(&bps->list, i);
+        if (bp->addr == addr) {
+            MEMORY(addr) = bp->original;
+            remove_vec(&bps->list, i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint8_t* programByte(CPU* cpu, uint16_t addr) {
+    Breakpoint* bp = cpu->breakpoints == NULL ? NULL : findBreakpoint(cpu->breakpoints, addr);
+
+    return bp == NULL ? &MEMORY(addr) : &bp->original;
+}
+
+bool hitBreakpoint(CPU* cpu, uint8_t* original) {
+    const Breakpoint* bp =
+        cpu->breakpoints == NULL ? NULL : findBreakpoint(cpu->breakpoints, PC);
+
+    if (bp == NULL) {
+        PC++;
+        return false;
+    }
+
+    *original = bp->original;
+    const Breakpoints* bps = cpu->breakpoints;
+
+    return bps->on_hit == NULL || bps->on_hit(cpu, PC, bps->data);
+}
+
+bool pauseOnBreakpoint(CPU* cpu, uint16_t addr, void* data) {
+    UNUSED(data);
+
+    // show the instruction the breakpoint covers instead of BRK
+    uint8_t next[MAX_OPCODE_LENGTH] = {*programByte(cpu, addr), MEMORY(addr + 1),
+                                       MEMORY(addr + 2), MEMORY(addr + 3)};
+
+    printf("Breakpoint at %u\n", addr);
+    printCpu(cpu);
+    printStack(cpu, SP + 5);
+    printf("Next opcode: ");
+    printNextOperation(next);
+    printf("\n");
+    getchar();
+
+    return true;
+}
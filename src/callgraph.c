@@ -0,0 +1,194 @@
+#include "headers/callgraph.h"
+
+#include <stdlib.h>
+
+#include "headers/instructions.h"
+#include "headers/util.h"
+
+#define NODE(idx) ((CallNode*)get_vec(&graph->nodes, (idx)))
+
+typedef struct FunctionStats {
+    uint16_t func;
+    uint64_t calls;
+    uint64_t inclusive;
+    uint64_t exclusive;
+} FunctionStats;
+
+static size_t pushNode(CallGraph* graph, uint16_t func, size_t parent) {
+    CallNode node = (CallNode){.func = func,
+                               .parent = parent,
+                               .first_child = NO_NODE,
+                               .next_sibling = NO_NODE,
+                               .calls = 0,
+                               .self = 0};
+    push_vec(&graph->nodes, &node);
+
+    return graph->nodes.len - 1;
+}
+
+void initCallGraph(CallGraph* graph, uint16_t entry) {
+    graph->nodes = new_vec(64, sizeof(CallNode));
+    graph->stack[0] = pushNode(graph, entry, NO_NODE);
+    graph->depth = 1;
+    graph->overflow = 0;
+
+    NODE(0)->calls = 1;
+}
+
+void freeCallGraph(CallGraph* graph) {
+    if (graph != NULL) {
+        free_vec(&graph->nodes, NULL);
+    }
+}
+
+static void enterFunction(CallGraph* graph, uint16_t func) {
+    if (graph->depth == SHADOW_STACK_SIZE) {
+        graph->overflow++;
+        return;
+    }
+
+    size_t parent = graph->stack[graph->depth - 1];
+    size_t child = NODE(parent)->first_child;
+
+    while (child != NO_NODE && NODE(child)->func != func) {
+        child = NODE(child)->next_sibling;
+    }
+
+    if (child == NO_NODE) {
+        child = pushNode(graph, func, parent);
+        NODE(child)->next_sibling = NODE(parent)->first_child;
+        NODE(parent)->first_child = child;
+    }
+
+    NODE(child)->calls++;
+    graph->stack[graph->depth++] = child;
+}
+
+static void leaveFunction(CallGraph* graph) {
+    if (graph->overflow > 0) {
+        graph->overflow--;
+    } else if (graph->depth > 1) {
+        graph->depth--;
+    }
+}
+
+int runCpuCallGraph(CPU* cpu, CallGraph* graph, Profile* profile) {
+    uint8_t op = MEMORY(PC);
+
+    do {
+        NODE(graph->stack[graph->depth - 1])->self++;
+        if (profile != NULL) {
+            profile->opcodes[op]++;
+            profile->addresses[PC]++;
+        }
+
+        OP_TABLE[op](cpu);
+
+        switch (op) {
+            case OP_CALL:
+                enterFunction(graph, PC);
+                break;
+            case OP_RET:
+            case OP_RET_I:
+                leaveFunction(graph);
+                break;
+        }
+
+        op = MEMORY(PC);
+    } while (op != OP_HALT);
+
+    if (profile != NULL) {
+        profile->instructions = 0;
+        for (size_t i = 0; i < 256; ++i) {
+            profile->instructions += profile->opcodes[i];
+        }
+    }
+
+    return 0;
+}
+
+void fprintCallStack(FILE* out, const CallGraph* graph, const SymbolTable* symbols, size_t node) {
+    const CallNode* n = get_vec(&graph->nodes, node);
+
+    if (n->parent != NO_NODE) {
+        fprintCallStack(out, graph, symbols, n->parent);
+        fputc(';', out);
+    }
+    fprintSymbolized(out, symbols, n->func);
+}
+
+void writeFoldedStacks(const CallGraph* graph, const DebugInfo* info, FILE* out) {
+    for (size_t i = 0; i < graph->nodes.len; ++i) {
+        const CallNode* node = get_vec(&graph->nodes, i);
+        if (node->self == 0) continue;
+
+        fprintCallStack(out, graph, &info->symbols, i);
+        fprintf(out, " %lu\n", (unsigned long)node->self);
+    }
+}
+
+static FunctionStats* statsFor(vec_t* stats, uint16_t func) {
+    for (size_t i = 0; i < stats->len; ++i) {
+        FunctionStats* s = get_vec(stats, i);
+        if (s->func == func) return s;
+    }
+
+    FunctionStats s = (FunctionStats){.func = func, .calls = 0, .inclusive = 0, .exclusive = 0};
+    push_vec(stats, &s);
+
+    return last_vec(stats);
+}
+
+static bool hasAncestor(const CallGraph* graph, size_t node, uint16_t func) {
+    for (size_t p = ((CallNode*)get_vec(&graph->nodes, node))->parent; p != NO_NODE;
+         p = ((CallNode*)get_vec(&graph->nodes, p))->parent) {
+        if (((CallNode*)get_vec(&graph->nodes, p))->func == func) return true;
+    }
+    return false;
+}
+
+static int cmpInclusive(const void* lhs, const void* rhs) {
+    const FunctionStats* a = lhs;
+    const FunctionStats* b = rhs;
+
+    if (a->inclusive != b->inclusive) return a->inclusive < b->inclusive ? 1 : -1;
+    return (int)a->func - (int)b->func;
+}
+
+void printCallGraph(const CallGraph* graph, const DebugInfo* info) {
+    const size_t len = graph->nodes.len;
+    uint64_t* totals = calloc(len, sizeof(uint64_t));
+    vec_t stats = new_vec(16, sizeof(FunctionStats));
+
+    // children are always created after their parent, so walking backwards visits every child
+    // before its parent
+    for (size_t i = len; i-- > 0;) {
+        const CallNode* node = get_vec(&graph->nodes, i);
+        totals[i] += node->self;
+        if (node->parent != NO_NODE) totals[node->parent] += totals[i];
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        const CallNode* node = get_vec(&graph->nodes, i);
+        FunctionStats* s = statsFor(&stats, node->func);
+
+        s->calls += node->calls;
+        s->exclusive += node->self;
+        // a recursive call is already part of the outermost call's total
+        if (!hasAncestor(graph, i, node->func)) s->inclusive += totals[i];
+    }
+
+    qsort(stats.ptr, stats.len, sizeof(FunctionStats), cmpInclusive);
+
+    printf("\n       calls    inclusive    exclusive  function\n");
+    for (size_t i = 0; i < min(stats.len, PROFILE_TOP); ++i) {
+        FunctionStats* s = get_vec(&stats, i);
+        printf("%12lu %12lu %12lu  ", (unsigned long)s->calls, (unsigned long)s->inclusive,
+               (unsigned long)s->exclusive);
+        fprintSymbolized(stdout, &info->symbols, s->func);
+        printf("\n");
+    }
+
+    free_vec(&stats, NULL);
+    free(totals);
+}
@@ -2,11 +2,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "headers/debug.h"
 #include "headers/instructions.h"
 
-void initCpu(CPU* cpu) {
+static void initRegisters(CPU* cpu) {
     PC = PROGRAM_START;
     FLAGS = 0;
     ACC = 0;
@@ -17,9 +18,11 @@ void initCpu(CPU* cpu) {
     SP = 0;
     BP = 0;
 
-    for (size_t i = 0; i < STACK_SIZE; ++i) {
-        STACK(i) = 0;
-    }
+    memset(cpu->stack, 0, STACK_SIZE);
+}
+
+void initCpu(CPU* cpu) {
+    initRegisters(cpu);
 
     uint8_t* memory = (uint8_t*)calloc(MEMORY_SIZE, sizeof(uint8_t));
 
@@ -28,6 +31,10 @@ void initCpu(CPU* cpu) {
     }
 
     cpu->memory = memory;
+    cpu->baseline = NULL;
+    memset(cpu->dirty, 0, sizeof(cpu->dirty));
+    cpu->breakpoints = NULL;
+    cpu->watchpoints = NULL;
 }
 
 void freeCpu(CPU* cpu) {
@@ -37,25 +44,54 @@ void freeCpu(CPU* cpu) {
 }
 
 void resetCpu(CPU* cpu) {
-    freeCpu(cpu);
-    initCpu(cpu);
+    initRegisters(cpu);
+
+    for (size_t word = 0; word < DIRTY_WORDS; ++word) {
+        for (uint64_t bits = cpu->dirty[word]; bits != 0; bits &= bits - 1) {
+            size_t offset = (word * 64 + (size_t)__builtin_ctzll(bits)) << PAGE_SHIFT;
+
+            if (cpu->baseline != NULL) {
+                memcpy(&MEMORY(offset), &cpu->baseline[offset], PAGE_SIZE);
+            } else {
+                memset(&MEMORY(offset), 0, PAGE_SIZE);
+            }
+        }
+        cpu->dirty[word] = 0;
+    }
 }
 
 void loadProgram(CPU* cpu, const uint8_t* program, uint16_t length) {
     for (int i = 0; i < length; ++i) {
-        MEMORY(i) = program[i];
+        MEMORY_W(i) = program[i];
+    }
+}
+
+bool writeInput(CPU* cpu, char input) {
+    // work directly in the CPU's memory to create and manage the ringbuffer that
+    // the keyboard will use. The CPU's interrupts will also use this ringbuffer
+    // internally to process keyboard input.
+    if ((MEMORY(INPUT_WRITE_IDX) + 1) % INPUT_BUF_SIZE == MEMORY(INPUT_READ_IDX)) {
+        return false;
     }
+    MEMORY_W(INPUT_RINGBUF + MEMORY(INPUT_WRITE_IDX)) = input;
+    MEMORY_W(INPUT_WRITE_IDX) = (MEMORY(INPUT_WRITE_IDX) + 1) % INPUT_BUF_SIZE;
+
+    return true;
+}
+
+void stopOnTrap(CPU* cpu) {
+    printCpu(cpu);
+    printStack(cpu, SP + 5);
+    printf("Next opcode: ");
+    printNextOperation(&MEMORY(PC));
+    printf("\n");
+    getchar();
 }
 
 int runCpu(CPU* cpu) {
     while (stepCpu(cpu) != OP_HALT) {
-        if (get_tf(FLAGS)) {
-            printCpu(cpu);
-            printStack(cpu, SP + 5);
-            printf("Next opcode: ");
-            printNextOperation(&MEMORY(PC));
-            printf("\n");
-            getchar();
+        if (FLAGS & TF_BIT) {
+            stopOnTrap(cpu);
         }
     }
 
@@ -65,5 +101,7 @@ int runCpu(CPU* cpu) {
 int stepCpu(CPU* cpu) {
     OP_TABLE[MEMORY(PC)](cpu);
 
-    return MEMORY(PC);
+    // a breakpoint on a HALT runs it without moving on, the run still has to end there
+    const uint8_t op = MEMORY(PC);
+    return op == OP_BRK ? *programByte(cpu, PC) : op;
 }
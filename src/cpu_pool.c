@@ -0,0 +1,111 @@
+#include "headers/cpu_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define HAS_MMAP
+#endif
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+static size_t roundUp(size_t size, size_t align) { return (size + align - 1) / align * align; }
+
+// Memory returned from here is zeroed and, apart from the fallback, page aligned
+static uint8_t* allocSlab(size_t size, bool huge_pages) {
+#ifdef HAS_MMAP
+    void* slab = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (slab == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+        madvise(slab, size, MADV_HUGEPAGE);
+    }
+#endif
+    return slab;
+#else
+    (void)huge_pages;
+    return calloc(size + CPU_ALIGN, 1);
+#endif
+}
+
+static void freeSlab(uint8_t* slab, size_t size) {
+#ifdef HAS_MMAP
+    munmap(slab, size);
+#else
+    (void)size;
+    free(slab);
+#endif
+}
+
+void initCpuPool(CpuPool* pool, size_t capacity, const uint8_t* program, uint16_t length,
+                 bool huge_pages) {
+    const size_t header = roundUp(sizeof(CPU), CPU_ALIGN);
+
+    pool->stride = header + MEMORY_SIZE;
+    pool->capacity = capacity;
+    pool->slab_size = pool->stride * capacity;
+    if (huge_pages) {
+        pool->slab_size = roundUp(pool->slab_size, HUGE_PAGE_SIZE);
+    }
+
+    pool->slab = allocSlab(pool->slab_size, huge_pages);
+    pool->baseline = (uint8_t*)calloc(MEMORY_SIZE, sizeof(uint8_t));
+
+    if (pool->slab == NULL || pool->baseline == NULL) {
+        exit(1);
+    }
+
+    memcpy(pool->baseline, program, length);
+
+    // a new CPU's memory is all zeroes, so only the pages that differ from that need to be copied
+    // in the first time it's reset
+    uint64_t program_pages[DIRTY_WORDS] = {0};
+    for (size_t page = 0; page < PAGE_COUNT; ++page) {
+        const uint8_t* start = &pool->baseline[page << PAGE_SHIFT];
+        for (size_t i = 0; i < PAGE_SIZE; ++i) {
+            if (start[i] != 0) {
+                program_pages[page / 64] |= 1ULL << (page % 64);
+                break;
+            }
+        }
+    }
+
+    uint8_t* base = (uint8_t*)roundUp((size_t)pool->slab, CPU_ALIGN);
+
+    pool->free_cpus = new_vec(capacity, sizeof(CPU*));
+
+    // push in reverse so the CPUs are handed out front to back
+    for (size_t i = capacity; i-- > 0;) {
+        CPU* cpu = (CPU*)(base + i * pool->stride);
+
+        cpu->memory = (uint8_t*)cpu + header;
+        cpu->baseline = pool->baseline;
+        cpu->breakpoints = NULL;
+        cpu->watchpoints = NULL;
+        memcpy(cpu->dirty, program_pages, sizeof(program_pages));
+
+        push_vec(&pool->free_cpus, &cpu);
+    }
+}
+
+void freeCpuPool(CpuPool* pool) {
+    freeSlab(pool->slab, pool->slab_size);
+    free(pool->baseline);
+    free_vec(&pool->free_cpus, NULL);
+}
+
+CPU* acquireCpu(CpuPool* pool) {
+    if (len_vec(&pool->free_cpus) == 0) {
+        return NULL;
+    }
+
+    CPU* cpu = CAST(pop_vec(&pool->free_cpus), CPU*);
+    resetCpu(cpu);
+
+    return cpu;
+}
+
+void releaseCpu(CpuPool* pool, CPU* cpu) { push_vec(&pool->free_cpus, &cpu); }
@@ -0,0 +1,150 @@
+#include "headers/debug_info.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// All integers in the sidecar are little endian:
+//
+//   "CDBG" u8 version
+//   u16 file length, file
+//   u32 line entry count, (u16 addr, u16 column, u32 line) per entry
+//   u32 symbol count, (u16 addr, u16 name length, name) per symbol
+
+DebugInfo newDebugInfo(slice_t file) {
+    return (DebugInfo){.file = from_cstr_str(file.str, file.len),
+                       .lines = new_vec(64, sizeof(LineEntry)),
+                       .symbols = newSymbols(0)};
+}
+
+void freeDebugInfo(DebugInfo* info) {
+    if (info != NULL) {
+        free_str(&info->file);
+        free_vec(&info->lines, NULL);
+        freeSymbols(&info->symbols);
+    }
+}
+
+const LineEntry* findLine(const DebugInfo* info, uint16_t addr) {
+    const LineEntry* lines = info->lines.ptr;
+    size_t lo = 0;
+    size_t hi = info->lines.len;
+
+    // first entry past addr
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lines[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo == 0 ? NULL : &lines[lo - 1];
+}
+
+static void writeU16(FILE* fp, uint16_t val) {
+    fputc(val & 0xFF, fp);
+    fputc(val >> 8, fp);
+}
+
+static void writeU32(FILE* fp, uint32_t val) {
+    writeU16(fp, (uint16_t)(val & 0xFFFF));
+    writeU16(fp, (uint16_t)(val >> 16));
+}
+
+bool writeDebugInfo(const DebugInfo* info, const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return false;
+
+    fwrite(DEBUG_INFO_MAGIC, 1, 4, fp);
+    fputc(DEBUG_INFO_VERSION, fp);
+
+    writeU16(fp, (uint16_t)info->file.len);
+    fwrite(info->file.str, 1, info->file.len, fp);
+
+    writeU32(fp, (uint32_t)info->lines.len);
+    for (size_t i = 0; i < info->lines.len; ++i) {
+        const LineEntry* entry = get_vec(&info->lines, i);
+        writeU16(fp, entry->addr);
+        writeU16(fp, entry->column);
+        writeU32(fp, entry->line);
+    }
+
+    writeU32(fp, (uint32_t)info->symbols.symbols.len);
+    for (size_t i = 0; i < info->symbols.symbols.len; ++i) {
+        const Symbol* sym = get_vec(&info->symbols.symbols, i);
+        writeU16(fp, sym->addr);
+        writeU16(fp, (uint16_t)sym->name.len);
+        fwrite(sym->name.str, 1, sym->name.len, fp);
+    }
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+
+    return ok;
+}
+
+static bool readU16(FILE* fp, uint16_t* val) {
+    int lo = fgetc(fp);
+    int hi = fgetc(fp);
+    if (lo == EOF || hi == EOF) return false;
+
+    *val = (uint16_t)(lo | (hi << 8));
+    return true;
+}
+
+static bool readU32(FILE* fp, uint32_t* val) {
+    uint16_t lo, hi;
+    if (!readU16(fp, &lo) || !readU16(fp, &hi)) return false;
+
+    *val = (uint32_t)lo | ((uint32_t)hi << 16);
+    return true;
+}
+
+static bool readBody(FILE* fp, DebugInfo* info, char* buf) {
+    uint32_t count;
+    if (!readU32(fp, &count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        LineEntry entry;
+        if (!readU16(fp, &entry.addr) || !readU16(fp, &entry.column) ||
+            !readU32(fp, &entry.line)) {
+            return false;
+        }
+        push_vec(&info->lines, &entry);
+    }
+
+    if (!readU32(fp, &count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint16_t addr, len;
+        if (!readU16(fp, &addr) || !readU16(fp, &len)) return false;
+        if (fread(buf, 1, len, fp) != len) return false;
+        addSymbol(&info->symbols, (slice_t){.str = buf, .len = len}, addr);
+    }
+    sortSymbols(&info->symbols);
+
+    return true;
+}
+
+bool readDebugInfo(DebugInfo* info, const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return false;
+
+    // large enough for any string, their lengths are stored as u16
+    char* buf = malloc(UINT16_MAX);
+    char magic[4];
+    uint16_t len;
+    bool ok = false;
+
+    if (buf != NULL && fread(magic, 1, 4, fp) == 4 && memcmp(magic, DEBUG_INFO_MAGIC, 4) == 0 &&
+        fgetc(fp) == DEBUG_INFO_VERSION && readU16(fp, &len) && fread(buf, 1, len, fp) == len) {
+        *info = newDebugInfo((slice_t){.str = buf, .len = len});
+        ok = readBody(fp, info, buf);
+
+        if (!ok) freeDebugInfo(info);
+    }
+
+    free(buf);
+    fclose(fp);
+
+    return ok;
+}
@@ -1,15 +1,166 @@
-#include <stdio.h>
+#include <string.h>
 
 #include "headers/cpu.h"
-#include "headers/debug.h"
 #include "headers/disassembler.h"
+#include "headers/opcodes.h"
+#include "headers/ovec.h"
 
-void disassemble(Executable exec) {
-    uint8_t* e = exec.executable + PROGRAM_START;
-    uint8_t* b;
-    while ((b = e++) && *b != 0) {
-        // this shit doesn't work yet
-        printNextOperation(b);
-        printf("\n");
+#define BYTES_PER_LINE 8
+
+static void markStart(InstructionStarts starts, size_t addr) {
+    starts[addr / 64] |= 1ULL << (addr % 64);
+}
+
+// Whether the whole instruction at `addr` lies within `end`
+static bool fits(const uint8_t* memory, size_t addr, size_t end) {
+    return addr + opcodeLength(memory[addr]) <= end;
+}
+
+void sweepLinear(const uint8_t* memory, size_t start, size_t end, InstructionStarts starts) {
+    memset(starts, 0, sizeof(InstructionStarts));
+
+    for (size_t addr = start; addr < end && fits(memory, addr, end);
+         addr += opcodeLength(memory[addr])) {
+        markStart(starts, addr);
     }
 }
+
+void findReachable(const uint8_t* memory, size_t start, size_t end, InstructionStarts starts) {
+    memset(starts, 0, sizeof(InstructionStarts));
+
+    // uint16_t, addresses that still have to be followed
+    vec_t work = new_vec(64, sizeof(uint16_t));
+    uint16_t entry = (uint16_t)start;
+    push_vec(&work, &entry);
+
+    while (len_vec(&work) > 0) {
+        size_t addr = CAST(pop_vec(&work), uint16_t);
+
+        // follow straight line code until it leaves the range or runs into decoded code
+        while (addr >= start && addr < end && !isInstructionStart(starts, addr) &&
+               fits(memory, addr, end)) {
+            markStart(starts, addr);
+
+            const OpcodeInfo* info = &OPCODE_INFO[memory[addr]];
+            if (info->flow == FLOW_JUMP || info->flow == FLOW_BRANCH || info->flow == FLOW_CALL) {
+                uint16_t target = jumpTarget(&memory[addr]);
+                push_vec(&work, &target);
+            }
+            if (info->flow == FLOW_JUMP || info->flow == FLOW_RET || info->flow == FLOW_STOP) {
+                break;
+            }
+
+            addr += info->length;
+        }
+    }
+
+    free_vec(&work, NULL);
+}
+
+static void printLabel(FILE* out, const SymbolTable* symbols, size_t addr) {
+    if (symbols == NULL) return;
+
+    const Symbol* sym = findSymbol(symbols, (uint16_t)addr);
+    if (sym != NULL && sym->addr == addr) {
+        fprintf(out, "%.*s:\n", (int)sym->name.len, sym->name.str);
+    }
+}
+
+static void printInstruction(FILE* out, const uint8_t* memory, size_t addr,
+                             const SymbolTable* symbols) {
+    const uint8_t* code = &memory[addr];
+    const OpcodeInfo* info = &OPCODE_INFO[*code];
+
+    fprintf(out, "    0x%04zx  ", addr);
+    for (size_t i = 0; i < MAX_OPCODE_LENGTH; ++i) {
+        if (i < info->length) {
+            fprintf(out, "%02x ", code[i]);
+        } else {
+            fprintf(out, "   ");
+        }
+    }
+
+    if (info->mnemonic == NULL) {
+        fprintf(out, " .byte %u\n", *code);
+        return;
+    }
+
+    fprintf(out, " %s", info->mnemonic);
+    switch (info->operands) {
+        case OPERANDS_NONE:
+            break;
+        case OPERANDS_U8:
+            fprintf(out, " %u", code[1]);
+            break;
+        case OPERANDS_U16:
+            fprintf(out, " 0x%04x", (code[1] << 8) | code[2]);
+            break;
+        case OPERANDS_U8_U16:
+            fprintf(out, " 0x%02x, 0x%04x", code[1], (code[2] << 8) | code[3]);
+            break;
+    }
+
+    if (symbols != NULL && info->mode == MODE_CODE) {
+        fprintf(out, "  ; ");
+        fprintSymbolized(out, symbols, jumpTarget(code));
+    }
+    fprintf(out, "\n");
+}
+
+// Prints `memory[start..end)` as data, at most BYTES_PER_LINE bytes per line
+static void printBytes(FILE* out, const uint8_t* memory, size_t start, size_t end) {
+    for (size_t line = start; line < end; line += BYTES_PER_LINE) {
+        fprintf(out, "    0x%04zx  %*s .byte", line, MAX_OPCODE_LENGTH * 3, "");
+        for (size_t addr = line; addr < end && addr < line + BYTES_PER_LINE; ++addr) {
+            fprintf(out, addr == line ? " %u" : ", %u", memory[addr]);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void printListing(FILE* out, const uint8_t* memory, size_t start, size_t end,
+                         const InstructionStarts starts, const SymbolTable* symbols) {
+    size_t addr = start;
+
+    while (addr < end) {
+        printLabel(out, symbols, addr);
+
+        if (isInstructionStart(starts, addr)) {
+            printInstruction(out, memory, addr, symbols);
+            addr += opcodeLength(memory[addr]);
+            continue;
+        }
+
+        // everything up to the next instruction or label is data
+        size_t data_end = addr + 1;
+        while (data_end < end && !isInstructionStart(starts, data_end)) {
+            const Symbol* sym = symbols != NULL ? findSymbol(symbols, (uint16_t)data_end) : NULL;
+            if (sym != NULL && sym->addr == data_end) break;
+            data_end++;
+        }
+
+        printBytes(out, memory, addr, data_end);
+        addr = data_end;
+    }
+}
+
+void disassembleLinear(FILE* out, const uint8_t* memory, size_t start, size_t end,
+                       const SymbolTable* symbols) {
+    InstructionStarts starts;
+
+    sweepLinear(memory, start, end, starts);
+    printListing(out, memory, start, end, starts, symbols);
+}
+
+void disassembleRecursive(FILE* out, const uint8_t* memory, size_t start, size_t end,
+                          const SymbolTable* symbols) {
+    InstructionStarts starts;
+
+    findReachable(memory, start, end, starts);
+    printListing(out, memory, start, end, starts, symbols);
+}
+
+void disassemble(Executable exec) {
+    disassembleRecursive(stdout, exec.executable, PROGRAM_START, exec.size,
+                         &exec.debug_info.symbols);
+}
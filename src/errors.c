@@ -38,7 +38,7 @@
 
 // clang-format on
 
-static void printErrorMsg(ParserError err, Token* tok) {
+static void printErrorMsg(ParserError err, const Token* tok) {
     switch (err) {
         case UNKNOWN_TOKEN_E:
             printf("unknown token `%.*s`", (int)tok->substr.len, tok->substr.str);
@@ -154,7 +154,7 @@ static void alignWarningHelpMsgNewline(size_t char_nr, size_t len) {
     printf(GRUVBOX_YELLOW "%.*s       ", (int)len, SPACES_256);
 }
 
-static void printWarningMsg(ParserWarning warning, Token* tok) {
+static void printWarningMsg(ParserWarning warning, const Token* tok) {
     switch (warning) {
         case U8_OVERFLOW_W:
             printf(
@@ -165,7 +165,7 @@ static void printWarningMsg(ParserWarning warning, Token* tok) {
     }
 }
 
-static void printWarningHelpMsg(ParserWarning warning, Token* tok) {
+static void printWarningHelpMsg(ParserWarning warning, const Token* tok) {
     switch (warning) {
         case U8_OVERFLOW_W: {
             uint16_t imm = parse_immediate(tok);
@@ -179,14 +179,20 @@ static void printWarningHelpMsg(ParserWarning warning, Token* tok) {
     }
 }
 
-void printHighlightedLine(Assembler* assembler, bool darken) {
-    str_iter_t line_iter = iter_from_slice(assembler->line);
+void printHighlightedLine(slice_t line_src, size_t line_nr, bool darken) {
+    str_iter_t line_iter = iter_from_slice(line_src);
 
     printf(RESET);
 
-    TokenLine line = tokenizeLine(&line_iter, assembler->line_nr);
+    TokenLines line = newTokenLines(NULL, 16, 1);
 
-    vec_iter_t token_iter = iter_from_vec(&line.tokens);
+    // blank lines are printed as just the line number
+    if (!tokenizeLine(&line_iter, line_nr, &line)) {
+        freeTokenLines(&line);
+        return;
+    }
+
+    vec_iter_t token_iter = iterTokenLine(&line, first_vec(&line.lines));
     Token* token;
 
     printf(RESET);
@@ -237,85 +243,119 @@ void printHighlightedLine(Assembler* assembler, bool darken) {
         printf("%.*s" RESET, (int)token->substr.len, token->substr.str);
     }
 
-    free_vec(&line.tokens, NULL);
+    freeTokenLines(&line);
 }
 
-static void printNumberedHighlightedLine(Assembler* assembler, bool darken) {
-    printf(GRUVBOX_BLUE "%4lu |  " RESET, assembler->line_nr);
-    printHighlightedLine(assembler, darken);
+static void printNumberedHighlightedLine(slice_t line, size_t line_nr, bool darken) {
+    printf(GRUVBOX_BLUE "%4lu |  " RESET, line_nr);
+    printHighlightedLine(line, line_nr, darken);
     printf(RESET "\n");
 }
 
-#define STRINGIFY_EXPR(expr) #expr
+// The line in `program` right before `line`, empty when `line` is the first one
+static slice_t previousLine(slice_t program, slice_t line) {
+    if (line.str <= program.str) {
+        return (slice_t){.len = 0, .str = ""};
+    }
 
-static TokenLine* findTokenLineWithLineNr(vec_iter_t token_line_iter, size_t line_nr) {
-    TokenLine* line;
+    // skip the newline that ends the previous line
+    const char* end = line.str - 1;
+    const char* start = end;
+    while (start > program.str && start[-1] != '\n') {
+        --start;
+    }
 
-    while ((line = iter_next(&token_line_iter))) {
-        if (line->line_nr == line_nr) {
-            return line;
-        }
+    return from_cstr_slice(start, (size_t)(end - start));
+}
+
+static void printNumberedHighlightedLines(const Diagnostic* diag, slice_t program, size_t n_back) {
+    // walk back from the line of the diagnostic to the first one that gets printed
+    slice_t lines[n_back];
+    lines[n_back - 1] = diag->line;
+    for (size_t i = n_back - 1; i > 0; --i) {
+        lines[i - 1] = previousLine(program, lines[i]);
+    }
+
+    for (size_t i = diag->line_nr - (n_back - 1); i <= diag->line_nr; ++i) {
+        const size_t back = diag->line_nr - i;
+        // the lines before the first one are printed as empty lines
+        const slice_t line = i > 0 ? lines[n_back - 1 - back] : (slice_t){.len = 0, .str = ""};
+        printNumberedHighlightedLine(line, i, back != 0);
     }
-    return NULL;
 }
 
-static void printNumberedHighlightedLines(Assembler* assembler, size_t n_back) {
-    size_t old_line_nr = assembler->line_nr;
-    slice_t old_line = assembler->line;
-    vec_iter_t token_line_iter = iter_from_vec(&assembler->token_lines);
-    TokenLine* line;
+static void pushDiagnostic(Assembler* assembler, Diagnostic diag) {
+    diag.line = assembler->line;
+    diag.line_nr = assembler->line_nr;
+    push_vec(&assembler->diagnostics, &diag);
+}
 
-    for (size_t i = assembler->line_nr - (n_back - 1); i <= old_line_nr; ++i) {
-        void* old_token_ptr = token_line_iter.ptr;
+void reportError(Token* tok, ParserError error, Assembler* assembler) {
+    pushDiagnostic(assembler,
+                   (Diagnostic){.severity = ERROR_SEVERITY, .error = error, .token = *tok});
+}
 
-        if ((line = findTokenLineWithLineNr(token_line_iter, i))) {
-            assembler->line_nr = line->line_nr;
-            assembler->line = line->substr;
-            bool darken = old_line_nr == line->line_nr ? false : true;
-            printNumberedHighlightedLine(assembler, darken);
-        } else {
-            assembler->line_nr = i;
-            assembler->line = (slice_t){.len = 0, .str = ""};
-            printNumberedHighlightedLine(assembler, false);
-        }
+void reportWarning(Token* tok, ParserWarning warning, Assembler* assembler) {
+    pushDiagnostic(assembler,
+                   (Diagnostic){.severity = WARNING_SEVERITY, .warning = warning, .token = *tok});
+}
 
-        // optimalization: since we only look forward, only start looking from the last found idx
-        // we might skip over a following index so we jump ahead to the last one used
-        token_line_iter.ptr = old_token_ptr;
+size_t countErrors(const vec_t* diagnostics) {
+    size_t errors = 0;
+    for (size_t i = 0; i < len_vec(diagnostics); ++i) {
+        const Diagnostic* diag = get_vec(diagnostics, i);
+        errors += diag->severity == ERROR_SEVERITY;
     }
-
-    assembler->line_nr = old_line_nr;
-    assembler->line = old_line;
+    return errors;
 }
 
-void printError(Token* tok, ParserError error, Assembler* assembler) {
+static void printError(const Diagnostic* diag, slice_t program, slice_t path) {
+    const Token* tok = &diag->token;
+
     printf(GRUVBOX_RED BOLD "ERROR" RESET BOLD ": ");
 
-    printErrorMsg(error, tok);
+    printErrorMsg(diag->error, tok);
 
-    printf("\n    " GRUVBOX_BLUE "-->" RESET " %.*s:%lu:%lu\n", (int)assembler->path.len,
-           assembler->path.str, assembler->line_nr, tok->char_nr);
+    printf("\n    " GRUVBOX_BLUE "-->" RESET " %.*s:%lu:%lu\n", (int)path.len, path.str,
+           diag->line_nr, tok->char_nr);
     printf(GRUVBOX_BLUE "     |\n");
-    printNumberedHighlightedLines(assembler, 3);
+    printNumberedHighlightedLines(diag, program, 3);
 
     alignErrorHelpMsg(tok->char_nr, tok->substr.len);
-    printErrorHelpMsg(error);
+    printErrorHelpMsg(diag->error);
 
     printf(GRUVBOX_BLUE "\n     |\n\n" RESET);
 }
 
-void printWarning(Token* tok, ParserWarning warning, Assembler* assembler) {
+static void printWarning(const Diagnostic* diag, slice_t program, slice_t path) {
+    const Token* tok = &diag->token;
+
     printf(GRUVBOX_YELLOW BOLD "WARNING" RESET BOLD ": ");
 
-    printWarningMsg(warning, tok);
+    printWarningMsg(diag->warning, tok);
 
-    printf("\n    " GRUVBOX_BLUE "-->" RESET " %.*s:%lu:%lu\n", (int)assembler->path.len,
-           assembler->path.str, assembler->line_nr, tok->char_nr);
+    printf("\n    " GRUVBOX_BLUE "-->" RESET " %.*s:%lu:%lu\n", (int)path.len, path.str,
+           diag->line_nr, tok->char_nr);
     printf(GRUVBOX_BLUE "     |\n");
-    printNumberedHighlightedLines(assembler, 3);
+    printNumberedHighlightedLines(diag, program, 3);
 
     alignWarningHelpMsg(tok->char_nr, tok->substr.len);
-    printWarningHelpMsg(warning, tok);
+    printWarningHelpMsg(diag->warning, tok);
 
     printf("\n" GRUVBOX_BLUE "     |\n\n" RESET);
 }
+
+void printDiagnostics(const vec_t* diagnostics, slice_t program, slice_t path) {
+    for (size_t i = 0; i < len_vec(diagnostics); ++i) {
+        const Diagnostic* diag = get_vec(diagnostics, i);
+
+        switch (diag->severity) {
+            case ERROR_SEVERITY:
+                printError(diag, program, path);
+                break;
+            case WARNING_SEVERITY:
+                printWarning(diag, program, path);
+                break;
+        }
+    }
+}
@@ -0,0 +1,681 @@
+#include "headers/gdb_stub.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "headers/instructions.h"
+
+// Registers in the order of the target description, which is also the order of a `g` reply
+static const char* TARGET_XML =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<feature name=\"org.oxey.cce.core\">"
+    "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\" regnum=\"0\"/>"
+    "<reg name=\"acc\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"r0\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"r1\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"h\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"l\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"bp\" bitsize=\"8\" type=\"uint8\"/>"
+    "<flags id=\"cce_flags\" size=\"1\">"
+    "<field name=\"CF\" start=\"0\" end=\"0\"/>"
+    "<field name=\"AF\" start=\"1\" end=\"1\"/>"
+    "<field name=\"ZF\" start=\"2\" end=\"2\"/>"
+    "<field name=\"SF\" start=\"3\" end=\"3\"/>"
+    "<field name=\"TF\" start=\"4\" end=\"4\"/>"
+    "<field name=\"OF\" start=\"5\" end=\"5\"/>"
+    "<field name=\"IF\" start=\"6\" end=\"6\"/>"
+    "</flags>"
+    "<reg name=\"flags\" bitsize=\"8\" type=\"cce_flags\"/>"
+    "</feature>"
+    "</target>";
+
+#define REGISTER_COUNT 9
+
+static uint8_t* byteRegister(CPU* cpu, size_t reg) {
+    switch (reg) {
+        case 1: return &ACC;
+        case 2: return &R0;
+        case 3: return &R1;
+        case 4: return &H;
+        case 5: return &L;
+        case 6: return &SP;
+        case 7: return &BP;
+        case 8: return &FLAGS;
+        default: return NULL;
+    }
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static char* putHex(char* out, uint8_t byte) {
+    static const char digits[] = "0123456789abcdef";
+    *out++ = digits[byte >> 4];
+    *out++ = digits[byte & 0xF];
+    return out;
+}
+
+// Parses a hex byte, returns false on anything else
+static bool getHex(const char* in, uint8_t* byte) {
+    int hi = hexValue(in[0]);
+    int lo = hi < 0 ? -1 : hexValue(in[1]);
+    if (lo < 0) return false;
+
+    *byte = (uint8_t)((hi << 4) | lo);
+    return true;
+}
+
+static bool breakpointHit(CPU* cpu, uint16_t addr, void* data) {
+    GdbStub* stub = (GdbStub*)data;
+    UNUSED(cpu);
+    UNUSED(addr);
+
+    if (stub->skip_breakpoint) {
+        stub->skip_breakpoint = false;
+        return true;
+    }
+
+    stub->stopped = true;
+    return false;
+}
+
+static void watchHit(CPU* cpu, const WatchHit* hit, void* data) {
+    GdbStub* stub = (GdbStub*)data;
+    UNUSED(cpu);
+
+    stub->stopped = true;
+    stub->watch_hit = true;
+    stub->last_watch = *hit;
+}
+
+static uint8_t stepOnce(CPU* cpu, GdbStub* stub) {
+    return stub->watch_count > 0 ? stepCpuWatched(cpu, stub->watchpoints) : stepCpu(cpu);
+}
+
+// The first instruction after resuming from a breakpoint is the one under it, which has to run
+// instead of stopping on the same breakpoint again
+static uint8_t resumeStep(CPU* cpu, GdbStub* stub) {
+    stub->skip_breakpoint = MEMORY(PC) == OP_BRK;
+    const uint8_t op = stepOnce(cpu, stub);
+    stub->skip_breakpoint = false;
+
+    return op;
+}
+
+#ifndef _WIN32
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static int listenUnix(GdbStub* stub, const char* path) {
+    struct sockaddr_un addr = {0};
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    strcpy(stub->path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int listenTcp(const char* address) {
+    const char* colon = strrchr(address, ':');
+    char host[256];
+    size_t len = colon == NULL ? 0 : (size_t)(colon - address);
+    if (colon == NULL || len >= sizeof(host)) return -1;
+
+    memcpy(host, address, len);
+    host[len] = '\0';
+
+    struct addrinfo hints = {0};
+    struct addrinfo* info;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host, colon + 1, &hints, &info) != 0) return -1;
+
+    int fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    const int yes = 1;
+
+    if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) != 0 ||
+                    bind(fd, info->ai_addr, info->ai_addrlen) != 0 || listen(fd, 1) != 0)) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(info);
+
+    return fd;
+}
+
+bool openGdbStub(GdbStub* stub, const char* address, bool wait) {
+    stub->client_fd = -1;
+    stub->path[0] = '\0';
+    stub->wait = wait;
+    stub->stopped = false;
+    stub->watch_hit = false;
+    stub->skip_breakpoint = false;
+    stub->watch_count = 0;
+    stub->kept_breakpoints = 0;
+
+    if (strncmp(address, "unix:", 5) == 0) {
+        stub->listen_fd = listenUnix(stub, address + 5);
+    } else {
+        stub->listen_fd = listenTcp(address);
+    }
+    if (stub->listen_fd < 0) return false;
+
+    stub->watchpoints = malloc(sizeof(Watchpoints));
+    if (stub->watchpoints == NULL) {
+        exit(1);
+    }
+    initWatchpoints(stub->watchpoints, watchHit, stub);
+    initBreakpoints(&stub->breakpoints, breakpointHit, stub);
+
+    return true;
+}
+
+void closeGdbStub(GdbStub* stub) {
+    if (stub->client_fd >= 0) close(stub->client_fd);
+    close(stub->listen_fd);
+    if (stub->path[0] != '\0') unlink(stub->path);
+
+    freeBreakpoints(&stub->breakpoints);
+    free(stub->watchpoints);
+}
+
+static bool readable(int fd, int timeout) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+    return poll(&pfd, 1, timeout) > 0;
+}
+
+static bool sendAll(GdbStub* stub, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(stub->client_fd, data, len, MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data += sent;
+        len -= (size_t)sent;
+    }
+    return true;
+}
+
+static int readByte(GdbStub* stub) {
+    uint8_t c;
+    return recv(stub->client_fd, &c, 1, 0) == 1 ? c : -1;
+}
+
+// Sends `$data#checksum` and waits for the client to acknowledge it
+static bool sendPacket(GdbStub* stub, const char* data) {
+    const size_t len = strlen(data);
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; ++i) {
+        sum += (uint8_t)data[i];
+    }
+
+    char trailer[3] = {'#'};
+    putHex(&trailer[1], sum);
+
+    for (;;) {
+        if (!sendAll(stub, "$", 1) || !sendAll(stub, data, len) || !sendAll(stub, trailer, 3)) {
+            return false;
+        }
+
+        int ack = readByte(stub);
+        while (ack != '+' && ack != '-' && ack != -1) {
+            ack = readByte(stub);
+        }
+        if (ack != '-') return ack == '+';
+    }
+}
+
+// Reads the next packet into `stub->packet`. Returns false when the client went away, and sets
+// `interrupted` instead of reading a packet if the client sent a ctrl-c.
+static bool readPacket(GdbStub* stub, bool* interrupted) {
+    *interrupted = false;
+
+    for (;;) {
+        int c = readByte(stub);
+        if (c == -1) return false;
+        if (c == 0x03) {
+            *interrupted = true;
+            return true;
+        }
+        if (c != '$') continue;
+
+        size_t len = 0;
+        uint8_t sum = 0;
+        while ((c = readByte(stub)) != '#') {
+            if (c == -1) return false;
+            if (len < GDB_PACKET_SIZE - 1) stub->packet[len++] = (char)c;
+            sum += (uint8_t)c;
+        }
+        stub->packet[len] = '\0';
+
+        char checksum[2];
+        uint8_t expected;
+        if ((c = readByte(stub)) == -1) return false;
+        checksum[0] = (char)c;
+        if ((c = readByte(stub)) == -1) return false;
+        checksum[1] = (char)c;
+
+        if (getHex(checksum, &expected) && expected == sum) {
+            return sendAll(stub, "+", 1);
+        }
+        if (!sendAll(stub, "-", 1)) return false;
+    }
+}
+
+static void dropClient(CPU* cpu, GdbStub* stub) {
+    // whatever the client set up goes away with it
+    while (stub->breakpoints.list.len > stub->kept_breakpoints) {
+        clearBreakpoint(cpu, ((Breakpoint*)last_vec(&stub->breakpoints.list))->addr);
+    }
+    unwatchRange(stub->watchpoints, 0, MEMORY_SIZE - 1, WATCH_READ | WATCH_WRITE);
+    stub->watch_count = 0;
+
+    close(stub->client_fd);
+    stub->client_fd = -1;
+}
+
+static void acceptClient(GdbStub* stub, int timeout) {
+    if (!readable(stub->listen_fd, timeout)) return;
+
+    stub->client_fd = accept(stub->listen_fd, NULL, NULL);
+}
+
+static bool readMemory(CPU* cpu, uint32_t addr, char* out) {
+    if (addr < MEMORY_SIZE) {
+        putHex(out, *programByte(cpu, (uint16_t)addr));
+    } else if (addr >= GDB_STACK_BASE && addr < GDB_STACK_BASE + STACK_SIZE) {
+        putHex(out, STACK(addr - GDB_STACK_BASE));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool writeMemory(CPU* cpu, uint32_t addr, uint8_t value) {
+    if (addr < MEMORY_SIZE) {
+        uint8_t* byte = programByte(cpu, (uint16_t)addr);
+        if (byte == &MEMORY(addr)) {
+            MEMORY_W(addr) = value;
+        } else {
+            *byte = value;
+        }
+    } else if (addr >= GDB_STACK_BASE && addr < GDB_STACK_BASE + STACK_SIZE) {
+        STACK(addr - GDB_STACK_BASE) = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Handles `m addr,len` and `M addr,len:bytes`
+static void memoryPacket(CPU* cpu, GdbStub* stub, char* reply) {
+    char* end;
+    const bool write = stub->packet[0] == 'M';
+    uint32_t addr = (uint32_t)strtoul(&stub->packet[1], &end, 16);
+    size_t len = *end == ',' ? strtoul(end + 1, &end, 16) : 0;
+
+    if (len * 2 >= GDB_PACKET_SIZE || (write && *end != ':')) {
+        strcpy(reply, "E01");
+        return;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t byte;
+        bool ok = write ? getHex(end + 1 + i * 2, &byte) && writeMemory(cpu, addr + i, byte)
+                        : readMemory(cpu, addr + i, &reply[i * 2]);
+        if (!ok) {
+            strcpy(reply, "E01");
+            return;
+        }
+    }
+
+    if (write) {
+        strcpy(reply, "OK");
+    } else {
+        reply[len * 2] = '\0';
+    }
+}
+
+static void readRegisters(CPU* cpu, char* reply) {
+    char* out = putHex(reply, (uint8_t)(PC & 0xFF));
+    out = putHex(out, (uint8_t)(PC >> 8));
+    for (size_t reg = 1; reg < REGISTER_COUNT; ++reg) {
+        out = putHex(out, *byteRegister(cpu, reg));
+    }
+    *out = '\0';
+}
+
+static bool writeRegister(CPU* cpu, size_t reg, const char* hex) {
+    uint8_t lo, hi;
+    if (!getHex(hex, &lo)) return false;
+
+    if (reg == 0) {
+        if (!getHex(hex + 2, &hi)) return false;
+        PC = (uint16_t)(lo | (hi << 8));
+    } else if (reg < REGISTER_COUNT) {
+        *byteRegister(cpu, reg) = lo;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool writeRegisters(CPU* cpu, const char* hex) {
+    if (strlen(hex) < 2 * (REGISTER_COUNT + 1)) return false;
+
+    for (size_t reg = 0; reg < REGISTER_COUNT; ++reg) {
+        if (!writeRegister(cpu, reg, hex)) return false;
+        hex += reg == 0 ? 4 : 2;
+    }
+    return true;
+}
+
+// Handles `Z type,addr,kind` and `z type,addr,kind`
+static void pointPacket(CPU* cpu, GdbStub* stub, char* reply) {
+    const bool insert = stub->packet[0] == 'Z';
+    const char type = stub->packet[1];
+    char* end;
+    unsigned long addr = strtoul(&stub->packet[3], &end, 16);
+    // the kind of a watchpoint is its length
+    unsigned long len = *end == ',' ? strtoul(end + 1, NULL, 16) : 1;
+
+    if (addr >= MEMORY_SIZE || len == 0 || addr + len > MEMORY_SIZE) {
+        strcpy(reply, "E01");
+        return;
+    }
+
+    strcpy(reply, "OK");
+
+    if (type == '0' || type == '1') {
+        if (insert) {
+            setBreakpoint(cpu, (uint16_t)addr);
+            return;
+        }
+        // the client may remove a kept breakpoint as well, which moves the ones after it up
+        for (size_t i = 0; i < stub->kept_breakpoints; ++i) {
+            if (((Breakpoint*)get_vec(&stub->breakpoints.list, i))->addr == addr) {
+                stub->kept_breakpoints--;
+                break;
+            }
+        }
+        clearBreakpoint(cpu, (uint16_t)addr);
+        return;
+    }
+
+    WatchKind kinds;
+    switch (type) {
+        case '2': kinds = WATCH_WRITE; break;
+        case '3': kinds = WATCH_READ; break;
+        case '4': kinds = WATCH_READ | WATCH_WRITE; break;
+        default: reply[0] = '\0'; return;
+    }
+
+    const uint16_t hi = (uint16_t)(addr + len - 1);
+    if (insert) {
+        watchRange(stub->watchpoints, (uint16_t)addr, hi, kinds);
+        stub->watch_count++;
+    } else {
+        unwatchRange(stub->watchpoints, (uint16_t)addr, hi, kinds);
+        if (stub->watch_count > 0) stub->watch_count--;
+    }
+}
+
+// Handles `qXfer:features:read:target.xml:offset,length`
+static void featuresPacket(GdbStub* stub, char* reply) {
+    const char* args = &stub->packet[strlen("qXfer:features:read:")];
+
+    if (strncmp(args, "target.xml:", 11) != 0) {
+        strcpy(reply, "E00");
+        return;
+    }
+
+    char* end;
+    size_t offset = strtoul(args + 11, &end, 16);
+    size_t length = *end == ',' ? strtoul(end + 1, NULL, 16) : 0;
+    const size_t total = strlen(TARGET_XML);
+
+    if (offset > total) offset = total;
+    if (length > GDB_PACKET_SIZE - 2) length = GDB_PACKET_SIZE - 2;
+
+    const size_t left = total - offset;
+    const size_t count = left < length ? left : length;
+
+    reply[0] = count == left ? 'l' : 'm';
+    memcpy(&reply[1], TARGET_XML + offset, count);
+    reply[count + 1] = '\0';
+}
+
+static void stopReply(CPU* cpu, GdbStub* stub, int signal, char* reply) {
+    if (stub->watch_hit) {
+        const WatchHit* hit = &stub->last_watch;
+        sprintf(reply, "T%02x%s:%x;", signal, hit->kind == WATCH_READ ? "rwatch" : "watch",
+                hit->addr);
+    } else if (stub->stopped) {
+        sprintf(reply, "T%02xswbreak:;", signal);
+    } else if (*programByte(cpu, PC) == OP_HALT) {
+        strcpy(reply, "W00");
+    } else {
+        sprintf(reply, "S%02x", signal);
+    }
+
+    stub->stopped = false;
+    stub->watch_hit = false;
+}
+
+typedef enum GdbAction {
+    GDB_STAY,
+    GDB_STEP,
+    GDB_CONTINUE,
+    GDB_DETACH,
+    GDB_KILL,
+} GdbAction;
+
+// Answers one packet, `reply` has room for a full packet
+static GdbAction handlePacket(CPU* cpu, GdbStub* stub, char* reply) {
+    char* packet = stub->packet;
+    reply[0] = '\0';
+
+    switch (packet[0]) {
+        case '?': stopReply(cpu, stub, 5, reply); break;
+        case 'g': readRegisters(cpu, reply); break;
+        case 'G': strcpy(reply, writeRegisters(cpu, &packet[1]) ? "OK" : "E01"); break;
+        case 'p': {
+            size_t reg = strtoul(&packet[1], NULL, 16);
+            if (reg == 0) {
+                char* out = putHex(reply, (uint8_t)(PC & 0xFF));
+                *putHex(out, (uint8_t)(PC >> 8)) = '\0';
+            } else if (reg < REGISTER_COUNT) {
+                *putHex(reply, *byteRegister(cpu, reg)) = '\0';
+            } else {
+                strcpy(reply, "E01");
+            }
+            break;
+        }
+        case 'P': {
+            char* end;
+            size_t reg = strtoul(&packet[1], &end, 16);
+            strcpy(reply, *end == '=' && writeRegister(cpu, reg, end + 1) ? "OK" : "E01");
+            break;
+        }
+        case 'm':
+        case 'M': memoryPacket(cpu, stub, reply); break;
+        case 'Z':
+        case 'z': pointPacket(cpu, stub, reply); break;
+        case 's': return GDB_STEP;
+        case 'c': return GDB_CONTINUE;
+        case 'D': strcpy(reply, "OK"); return GDB_DETACH;
+        case 'k': return GDB_KILL;
+        case 'H': strcpy(reply, "OK"); break;
+        case 'T': strcpy(reply, "OK"); break;
+        case 'q':
+            if (strncmp(packet, "qSupported", 10) == 0) {
+                sprintf(reply, "PacketSize=%x;qXfer:features:read+;swbreak+", GDB_PACKET_SIZE);
+            } else if (strncmp(packet, "qXfer:features:read:", 20) == 0) {
+                featuresPacket(stub, reply);
+            } else if (strcmp(packet, "qAttached") == 0) {
+                strcpy(reply, "1");
+            } else if (strcmp(packet, "qC") == 0) {
+                strcpy(reply, "QC1");
+            } else if (strcmp(packet, "qfThreadInfo") == 0) {
+                strcpy(reply, "m1");
+            } else if (strcmp(packet, "qsThreadInfo") == 0) {
+                strcpy(reply, "l");
+            }
+            break;
+        default: break;
+    }
+
+    return GDB_STAY;
+}
+
+// Serves packets while the VM is stopped, returns what to do with it next
+static GdbAction serveStopped(CPU* cpu, GdbStub* stub, char* reply) {
+    for (;;) {
+        bool interrupted;
+        if (!readPacket(stub, &interrupted)) return GDB_DETACH;
+        if (interrupted) continue;
+
+        GdbAction action = handlePacket(cpu, stub, reply);
+        if (action == GDB_STEP || action == GDB_CONTINUE || action == GDB_KILL) return action;
+        if (!sendPacket(stub, reply)) return GDB_DETACH;
+        if (action == GDB_DETACH) return action;
+    }
+}
+
+int runCpuGdb(CPU* cpu, GdbStub* stub) {
+    char* reply = malloc(GDB_PACKET_SIZE);
+    if (reply == NULL) {
+        exit(1);
+    }
+
+    cpu->breakpoints = &stub->breakpoints;
+    stub->kept_breakpoints = stub->breakpoints.list.len;
+    // an attached client stops the VM until it asks to step or continue
+    bool stopped = false;
+
+    if (stub->wait) {
+        acceptClient(stub, -1);
+        stopped = stub->client_fd >= 0;
+    }
+
+    while (true) {
+        if (stub->client_fd < 0) {
+            acceptClient(stub, 0);
+            stopped = stub->client_fd >= 0;
+        }
+
+        if (stopped) {
+            GdbAction action = serveStopped(cpu, stub, reply);
+
+            if (action == GDB_KILL) break;
+            if (action == GDB_DETACH) {
+                dropClient(cpu, stub);
+                stopped = false;
+                continue;
+            }
+            if (action == GDB_STEP) {
+                if (*programByte(cpu, PC) != OP_HALT) resumeStep(cpu, stub);
+
+                stopReply(cpu, stub, 5, reply);
+                if (!sendPacket(stub, reply)) {
+                    dropClient(cpu, stub);
+                    stopped = false;
+                }
+                continue;
+            }
+            stopped = false;
+        }
+
+        // a breakpoint may cover the HALT
+        if (*programByte(cpu, PC) == OP_HALT) {
+            // let the client know the program exited before it's gone
+            if (stub->client_fd >= 0) {
+                stopReply(cpu, stub, 5, reply);
+                sendPacket(stub, reply);
+                dropClient(cpu, stub);
+            }
+            break;
+        }
+
+        uint8_t op = resumeStep(cpu, stub);
+        for (size_t i = 1; i < GDB_POLL_INTERVAL && op != OP_HALT && !stub->stopped; ++i) {
+            op = stepOnce(cpu, stub);
+        }
+
+        if (stub->client_fd < 0) {
+            // nobody to stop for, a breakpoint that was hit just gets run through
+            stub->stopped = false;
+            continue;
+        }
+
+        int signal = 5;
+        if (!stub->stopped && readable(stub->client_fd, 0)) {
+            // GDB doesn't send anything but a ctrl-c while the VM runs
+            int c = readByte(stub);
+            if (c == -1) {
+                dropClient(cpu, stub);
+                continue;
+            }
+            if (c != 0x03) continue;
+            signal = 2;
+        } else if (!stub->stopped) {
+            continue;
+        }
+
+        stopReply(cpu, stub, signal, reply);
+        if (!sendPacket(stub, reply)) {
+            dropClient(cpu, stub);
+            continue;
+        }
+        stopped = true;
+    }
+
+    cpu->breakpoints = NULL;
+    free(reply);
+
+    return 0;
+}
+
+#else
+
+bool openGdbStub(GdbStub* stub, const char* address, bool wait) {
+    UNUSED(stub);
+    UNUSED(address);
+    UNUSED(wait);
+    return false;
+}
+
+void closeGdbStub(GdbStub* stub) { UNUSED(stub); }
+
+int runCpuGdb(CPU* cpu, GdbStub* stub) {
+    UNUSED(stub);
+    return runCpu(cpu);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef __OXEY_CCE_ARENA_H
+#define __OXEY_CCE_ARENA_H
+
+#include <stddef.h>
+
+// every allocation is aligned to this, enough for any type the assembler stores
+#define ARENA_ALIGN 16
+#define DEFAULT_ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct ArenaChunk {
+    struct ArenaChunk* prev;
+    size_t size;
+    size_t used;
+} ArenaChunk;
+
+/// A bump allocator. Allocations are carved out of large chunks and are never freed one by one,
+/// `freeArena` releases all of them at once. Chunks at least double in size, so an arena only
+/// ever holds a handful of them.
+typedef struct Arena {
+    // the chunk allocations currently come from, earlier ones are linked through `prev`
+    ArenaChunk* chunk;
+    size_t next_chunk_size;
+    // the most recent allocation, the only one `arenaGrow` can extend in place
+    void* last;
+} Arena;
+
+/// The arena itself lives on the heap so maps and vecs can keep pointing to it when whatever
+/// owns them is moved around
+Arena* newArena(size_t chunk_size);
+void freeArena(Arena* arena);
+
+/// Returns `size` uninitialized bytes, exits if the system is out of memory like the rest of the
+/// assembler
+void* arenaAlloc(Arena* arena, size_t size);
+void* arenaCalloc(Arena* arena, size_t count, size_t size);
+/// Grows an allocation from this arena to `new_size` bytes. The most recent allocation is
+/// extended in place when its chunk has room, anything else is copied to a new allocation.
+void* arenaGrow(Arena* arena, void* ptr, size_t old_size, size_t new_size);
+
+#endif
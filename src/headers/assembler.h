@@ -1,9 +1,13 @@
 #ifndef __OXEY_CCE_ASSEMBLER_H
 #define __OXEY_CCE_ASSEMBLER_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "arena.h"
+#include "debug_info.h"
 #include "oslice.h"
+#include "ostring.h"
 #include "ovec.h"
 #include "str_int_map.h"
 #include "tokenizer.h"
@@ -27,8 +31,18 @@ typedef struct MemExpr {
     Token* mode_token;
 } MemExpr;
 
+#define LABEL_UNDEFINED SIZE_MAX
+
+typedef struct LabelDef {
+    // address or value of the label, LABEL_UNDEFINED until it's defined
+    size_t addr;
+    // `.name = value` constants, their value doesn't move with the code around them
+    bool constant;
+} LabelDef;
+
 typedef struct {
-    slice_t label;
+    // id the tokenizer gave the label
+    uint32_t label;
     size_t idx;
     slice_t line;
     size_t line_nr;
@@ -37,19 +51,72 @@ typedef struct {
 
 typedef struct Assembler {
     slice_t path;
-    vec_t token_lines;
+    // everything that only lives as long as one `assemble` call
+    Arena* scratch;
+    TokenLines token_lines;
     size_t line_nr;
     slice_t line;
+    // LabelDef, one for every label id
+    vec_t label_addrs;
+    // label name -> address, only filled in for the Executable once pass 2 is done
     si_map_t label_def_map;
     vec_t label_ref_list;
     vec_t compiled;
+    DebugInfo debug_info;
+    // Diagnostic, every error and warning in the order they were found
+    vec_t diagnostics;
 } Assembler;
 
 typedef struct Executable {
     uint8_t* executable;
     size_t size;
+    // label name -> address, the names point into the assembled source
+    si_map_t labels;
+    // holds the slots of `labels`, NULL for executables that weren't assembled
+    Arena* arena;
+    DebugInfo debug_info;
+    // Diagnostic, see errors.h, the executable is only usable when none of them are errors
+    vec_t diagnostics;
 } Executable;
 
+/// The steps `assemble` goes through, in order
+typedef enum AssemblerPhase {
+    TOKENIZE_PHASE,
+    PASS1_PHASE,
+    PASS2_PHASE,
+    // everything is assembled
+    DONE_PHASE,
+} AssemblerPhase;
+
+/// Called right before each phase starts and once more with DONE_PHASE at the end, used to time
+/// and measure the phases separately
+typedef void (*PhaseHook)(AssemblerPhase phase, void* data);
+
+/// Keeps no state between calls, so any number of programs can be assembled at once on different
+/// threads. Errors and warnings are returned in the Executable's diagnostics instead of printed.
 Executable assemble(slice_t program, slice_t path);
+/// Same as `assemble`, calling `hook` with `data` between phases
+Executable assembleWithHook(slice_t program, slice_t path, PhaseHook hook, void* data);
+/// Same as `assembleWithHook`, but splits the source into `chunks` pieces at line boundaries that
+/// are tokenized and go through pass 1 on threads of their own. `assemble` only splits up large
+/// sources and picks the number of chunks from the number of cores, this is for tests and
+/// benchmarks. The result doesn't depend on `chunks`. `hook` may be NULL.
+Executable assembleInChunks(slice_t program, slice_t path, size_t chunks, PhaseHook hook,
+                            void* data);
+void freeExecutable(Executable* exec);
+
+/// Assembles new versions of the same source over and over, only tokenizing and running pass 1
+/// again on the pieces of about 16KB of lines that changed since the previous call. Labels and pass
+/// 2 are still redone for the whole program.
+typedef struct AssemblySession {
+    string_t path;
+    // pieces of the previous version of the source, each with a copy of its text
+    vec_t chunks;
+} AssemblySession;
+
+void initAssemblySession(AssemblySession* session, slice_t path);
+/// Gives the same Executable `assemble` would, its names and diagnostics point into `program`
+Executable reassemble(AssemblySession* session, slice_t program);
+void freeAssemblySession(AssemblySession* session);
 
 #endif
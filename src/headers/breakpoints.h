@@ -0,0 +1,51 @@
+#ifndef __OXEY_CCE_BREAKPOINTS_H
+#define __OXEY_CCE_BREAKPOINTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ovec.h"
+
+struct CPU;
+
+/// Returns true to run the instruction under the breakpoint, or false to stay on it
+typedef bool (*BreakpointHandler)(struct CPU* cpu, uint16_t addr, void* data);
+
+typedef struct Breakpoint {
+    uint16_t addr;
+    // the opcode that was replaced with OP_BRK
+    uint8_t original;
+} Breakpoint;
+
+/// Breakpoints replace the opcode at their address with OP_BRK, so the run loop doesn't have to
+/// check anything and only pays when a breakpoint is actually hit. When that happens `on_hit` is
+/// called before the original instruction executes, and can keep it from executing.
+typedef struct Breakpoints {
+    // Breakpoint
+    vec_t list;
+    BreakpointHandler on_hit;
+    void* data;
+} Breakpoints;
+
+void initBreakpoints(Breakpoints* bps, BreakpointHandler on_hit, void* data);
+void freeBreakpoints(Breakpoints* bps);
+
+/// Patches a breakpoint into the memory of `cpu`, which has to use `cpu->breakpoints`. Returns
+/// false if there already is one at `addr`.
+bool setBreakpoint(struct CPU* cpu, uint16_t addr);
+/// Restores the original opcode, returns false if there was no breakpoint at `addr`
+bool clearBreakpoint(struct CPU* cpu, uint16_t addr);
+
+/// Returns the byte the program has at `addr`, which is the saved opcode if there is a breakpoint
+uint8_t* programByte(struct CPU* cpu, uint16_t addr);
+
+/// Called by OP_BRK. Runs the handler and returns true if OP_BRK should go on with the instruction
+/// the breakpoint replaced, which is stored in `original`. It's dispatched by OP_BRK so it goes
+/// through the same table as the loop that hit the breakpoint. A BRK that doesn't belong to a
+/// breakpoint is skipped like a NOOP.
+bool hitBreakpoint(struct CPU* cpu, uint8_t* original);
+
+/// Default handler, prints the CPU and waits for enter like the trap flag does
+bool pauseOnBreakpoint(struct CPU* cpu, uint16_t addr, void* data);
+
+#endif
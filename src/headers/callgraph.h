@@ -0,0 +1,53 @@
+#ifndef __OXEY_CCE_CALLGRAPH_H
+#define __OXEY_CCE_CALLGRAPH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cpu.h"
+#include "debug_info.h"
+#include "ovec.h"
+#include "profiler.h"
+#include "symbols.h"
+
+// CALL pushes two bytes, so the guest stack can't hold more frames than this
+#define SHADOW_STACK_SIZE (STACK_SIZE / 2)
+#define NO_NODE SIZE_MAX
+
+/// One node per distinct chain of calls, so recursion and different callers of the same function
+/// get counted separately
+typedef struct CallNode {
+    uint16_t func;
+    size_t parent;
+    size_t first_child;
+    size_t next_sibling;
+    uint64_t calls;
+    // instructions executed while this node was at the top of the stack
+    uint64_t self;
+} CallNode;
+
+/// Call tree built by following CALL, RET and RET_I on a host side shadow stack
+typedef struct CallGraph {
+    // CallNode, the root is the program entry
+    vec_t nodes;
+    size_t stack[SHADOW_STACK_SIZE];
+    size_t depth;
+    // calls made while the shadow stack was full, their returns are ignored
+    size_t overflow;
+} CallGraph;
+
+void initCallGraph(CallGraph* graph, uint16_t entry);
+void freeCallGraph(CallGraph* graph);
+
+/// Same as `runCpuProfiled`, but also attributes every instruction to the function executing it.
+/// `profile` may be NULL.
+int runCpuCallGraph(CPU* cpu, CallGraph* graph, Profile* profile);
+
+/// Prints the chain of calls leading to `node` as `caller;callee`
+void fprintCallStack(FILE* out, const CallGraph* graph, const SymbolTable* symbols, size_t node);
+/// Writes one `caller;callee count` line per call chain, the folded format `flamegraph.pl` reads
+void writeFoldedStacks(const CallGraph* graph, const DebugInfo* info, FILE* out);
+/// Prints calls, inclusive and exclusive instruction counts per function
+void printCallGraph(const CallGraph* graph, const DebugInfo* info);
+
+#endif
@@ -1,11 +1,18 @@
 #ifndef __OXEY_CCE_CPU_H
 #define __OXEY_CCE_CPU_H
 
+#include <stdbool.h>
+
+#include "breakpoints.h"
 #include "flags.h"
 
 #define STACK_SIZE 256U
 #define MEMORY_SIZE 256 * 256
 #define PROGRAM_START 256U
+#define PAGE_SHIFT 8
+#define PAGE_SIZE (1U << PAGE_SHIFT)
+#define PAGE_COUNT ((MEMORY_SIZE) >> PAGE_SHIFT)
+#define DIRTY_WORDS (PAGE_COUNT / 64)
 #define SIGN_BIT (1 << 7)
 
 #define PC cpu->program_counter
@@ -29,9 +36,20 @@
 #define BP cpu->baseptr
 #define STACK(idx) cpu->stack[idx]
 #define MEMORY(idx) cpu->memory[idx]
+// Use for reads of data, as opposed to instruction bytes, so watchpoints can see them
+#define MEMORY_R(idx) MEMORY(idx)
+// Use for every write to memory so `resetCpu` knows which pages to restore
+#define MEMORY_W(idx) (*markDirty(cpu, (uint16_t)(idx)))
 
 #define CARRY_FLAG() get_cf(FLAGS)
 
+// Keyboard input is passed to programs through a ring buffer in memory
+#define INPUT_WRITE_IDX 0x9fed
+#define INPUT_READ_IDX 0x9fee
+#define INPUT_RINGBUF 0x9fef
+#define INPUT_BUF_SIZE 0x0010
+#define INPUT_EMPTY() (MEMORY(INPUT_READ_IDX) == MEMORY(INPUT_WRITE_IDX))
+
 typedef struct Registers {
     uint8_t reg_0;
     uint8_t reg_1;
@@ -48,13 +66,33 @@ typedef struct CPU {
     uint8_t stackptr;
     uint8_t baseptr;
     uint8_t* memory;
+    // memory is restored from this image on reset, or cleared when it's NULL
+    const uint8_t* baseline;
+    // one bit for every page written to since the last reset
+    uint64_t dirty[DIRTY_WORDS];
+    // NULL unless breakpoints are patched into memory
+    Breakpoints* breakpoints;
+    // only used by the watched handlers, see watchpoints.h
+    struct Watchpoints* watchpoints;
 } CPU;
 
+static inline uint8_t* markDirty(CPU* cpu, uint16_t idx) {
+    cpu->dirty[idx >> (PAGE_SHIFT + 6)] |= 1ULL << ((idx >> PAGE_SHIFT) & 63);
+    return &cpu->memory[idx];
+}
+
 void initCpu(CPU* cpu);
 void freeCpu(CPU* cpu);
+/// Resets the registers and stack, and restores every page of memory that was written to since the
+/// last reset from `cpu->baseline`. Writes that bypass `MEMORY_W` aren't undone.
 void resetCpu(CPU* cpu);
 void loadProgram(CPU* cpu, const uint8_t* program, uint16_t length);
 
+/// Appends a value to the input ring buffer, returns false if the buffer is full
+bool writeInput(CPU* cpu, char input);
+
+/// Prints the CPU and waits for enter, which runs the next instruction while TF is set
+void stopOnTrap(CPU* cpu);
 int runCpu(CPU* cpu);
 int stepCpu(CPU* cpu);
 
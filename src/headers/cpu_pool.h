@@ -0,0 +1,37 @@
+#ifndef __OXEY_CCE_CPU_POOL_H
+#define __OXEY_CCE_CPU_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+#include "ovec.h"
+
+#define CPU_ALIGN 64
+
+/// Hands out CPUs that live in a single slab, each one directly followed by its memory. Every CPU
+/// uses the pool's baseline image, so `resetCpu` only has to restore the pages a run touched.
+typedef struct CpuPool {
+    uint8_t* slab;
+    size_t slab_size;
+    // distance between two CPUs in the slab
+    size_t stride;
+    size_t capacity;
+    // CPU*
+    vec_t free_cpus;
+    // full MEMORY_SIZE image every CPU starts from
+    uint8_t* baseline;
+} CpuPool;
+
+/// Creates a pool of `capacity` CPUs that start with `program` loaded. With `huge_pages` set the
+/// slab is backed by transparent huge pages where the platform supports it.
+void initCpuPool(CpuPool* pool, size_t capacity, const uint8_t* program, uint16_t length,
+                 bool huge_pages);
+void freeCpuPool(CpuPool* pool);
+
+/// Returns a freshly reset CPU or NULL when every CPU is in use. Return it with `releaseCpu`
+/// instead of calling `freeCpu` on it.
+CPU* acquireCpu(CpuPool* pool);
+void releaseCpu(CpuPool* pool, CPU* cpu);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __OXEY_CCE_DEBUG_INFO_H
+#define __OXEY_CCE_DEBUG_INFO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ostring.h"
+#include "ovec.h"
+#include "symbols.h"
+
+#define DEBUG_INFO_MAGIC "CDBG"
+#define DEBUG_INFO_VERSION 1
+
+/// The source position of the bytes starting at `addr`, up to the address of the next entry
+typedef struct LineEntry {
+    uint16_t addr;
+    uint16_t column;
+    uint32_t line;
+} LineEntry;
+
+/// Maps addresses of an executable back to its source. Produced by `assemble`, and can be saved
+/// to and loaded from a sidecar file so tools can symbolize without assembling again.
+typedef struct DebugInfo {
+    string_t file;
+    // LineEntry, sorted by address
+    vec_t lines;
+    SymbolTable symbols;
+} DebugInfo;
+
+DebugInfo newDebugInfo(slice_t file);
+void freeDebugInfo(DebugInfo* info);
+
+/// Returns the line entry covering `addr`, or NULL for addresses before the first entry. Bytes
+/// that don't come from a source line, like the HALT the assembler appends, map to line 0.
+const LineEntry* findLine(const DebugInfo* info, uint16_t addr);
+
+/// Writes `info` to `path` in a small binary format, returns false if the file couldn't be written
+bool writeDebugInfo(const DebugInfo* info, const char* path);
+/// Reads a file written by `writeDebugInfo`, returns false if it's missing or malformed
+bool readDebugInfo(DebugInfo* info, const char* path);
+
+#endif
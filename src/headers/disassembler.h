@@ -1,8 +1,37 @@
 #ifndef __OXEY_CCE_DISASSEMBLER_H
 #define __OXEY_CCE_DISASSEMBLER_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
 #include "assembler.h"
+#include "cpu.h"
+#include "symbols.h"
+
+/// One bit per address, set for every address an instruction starts at
+typedef uint64_t InstructionStarts[MEMORY_SIZE / 64];
+
+static inline bool isInstructionStart(const InstructionStarts starts, size_t addr) {
+    return (starts[addr / 64] >> (addr % 64)) & 1;
+}
+
+/// Decodes `memory[start..end)` front to back as if every byte was code. Data in between
+/// instructions throws the decoding off until it happens to line up again.
+void sweepLinear(const uint8_t* memory, size_t start, size_t end, InstructionStarts starts);
+/// Follows every jump, branch and call from `start`, only marking instructions that can actually
+/// run. Targets outside of `[start, end)` aren't followed.
+void findReachable(const uint8_t* memory, size_t start, size_t end, InstructionStarts starts);
+
+/// Prints `memory[start..end)` one instruction per line, with labels from `symbols` if it isn't
+/// NULL
+void disassembleLinear(FILE* out, const uint8_t* memory, size_t start, size_t end,
+                       const SymbolTable* symbols);
+/// Same as `disassembleLinear`, but bytes `findReachable` can't reach are printed as `.byte`
+void disassembleRecursive(FILE* out, const uint8_t* memory, size_t start, size_t end,
+                          const SymbolTable* symbols);
 
+/// Prints the reachable code of an assembled program to stdout
 void disassemble(Executable exec);
 
 #endif
@@ -26,8 +26,33 @@ typedef enum {
     U8_OVERFLOW_W,
 } ParserWarning;
 
-void printWarning(Token* tok, ParserWarning warning, Assembler* assembler);
-void printError(Token* tok, ParserError error, Assembler* assembler);
-void printHighlightedLine(Assembler* assembler, bool darken);
+typedef enum {
+    ERROR_SEVERITY,
+    WARNING_SEVERITY,
+} Severity;
+
+/// An error or warning found while assembling, everything it points at lives in the source
+typedef struct Diagnostic {
+    Severity severity;
+    union {
+        ParserError error;
+        ParserWarning warning;
+    };
+    Token token;
+    // the whole line `token` is on
+    slice_t line;
+    size_t line_nr;
+} Diagnostic;
+
+/// Records a warning for `tok` on the line `assembler` is at
+void reportWarning(Token* tok, ParserWarning warning, Assembler* assembler);
+/// Records an error for `tok` on the line `assembler` is at
+void reportError(Token* tok, ParserError error, Assembler* assembler);
+/// Number of diagnostics in `diagnostics` that are errors
+size_t countErrors(const vec_t* diagnostics);
+/// Prints every diagnostic with the lines leading up to it, `program` must be the source they
+/// were found in
+void printDiagnostics(const vec_t* diagnostics, slice_t program, slice_t path);
+void printHighlightedLine(slice_t line, size_t line_nr, bool darken);
 
 #endif
@@ -0,0 +1,55 @@
+#ifndef __OXEY_CCE_GDB_STUB_H
+#define __OXEY_CCE_GDB_STUB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "breakpoints.h"
+#include "cpu.h"
+#include "watchpoints.h"
+
+#define GDB_PACKET_SIZE 4096
+// instructions between checks for a new client or a ctrl-c
+#define GDB_POLL_INTERVAL 4096
+// memory reads from GDB_STACK_BASE on go to the stack, which isn't part of the address space
+#define GDB_STACK_BASE 0x10000
+
+/// Remote serial protocol server for a single VM, listening on `unix:/path` or `host:port`.
+/// The VM keeps running while nobody is attached, a client that connects stops it. Other VMs
+/// aren't affected since every stub only ever runs its own CPU.
+typedef struct GdbStub {
+    int listen_fd;
+    int client_fd;
+    // unix socket to remove when closing, empty for tcp
+    char path[108];
+    // don't run before the first client connects
+    bool wait;
+
+    Breakpoints breakpoints;
+    // the first breakpoints in the table were set before `runCpuGdb`, like the ones from --break,
+    // and stay when a client detaches
+    size_t kept_breakpoints;
+    Watchpoints* watchpoints;
+    size_t watch_count;
+
+    // set by the breakpoint and watchpoint handlers
+    bool stopped;
+    bool watch_hit;
+    WatchHit last_watch;
+    // breakpoint to run through instead of stopping on when resuming from it
+    bool skip_breakpoint;
+
+    char packet[GDB_PACKET_SIZE];
+} GdbStub;
+
+/// Starts listening on `address`, returns false if the socket couldn't be set up. With `wait` set
+/// the first `runCpuGdb` doesn't run anything until a client connects. Breakpoints set with
+/// `cpu->breakpoints` pointing at `stub->breakpoints` before running stop the VM for every client.
+bool openGdbStub(GdbStub* stub, const char* address, bool wait);
+void closeGdbStub(GdbStub* stub);
+
+/// Runs `cpu` until it halts or the client kills it, serving GDB requests along the way
+int runCpuGdb(CPU* cpu, GdbStub* stub);
+
+#endif
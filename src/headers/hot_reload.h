@@ -0,0 +1,68 @@
+#ifndef __OXEY_CCE_HOT_RELOAD_H
+#define __OXEY_CCE_HOT_RELOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "assembler.h"
+#include "cpu.h"
+#include "ostring.h"
+#include "ovec.h"
+
+// instructions between checks for a changed source
+#define HOT_RELOAD_POLL_INTERVAL (1 << 18)
+
+typedef struct MovedLabel {
+    // points into the source of the program that's running
+    slice_t name;
+    uint16_t from;
+    uint16_t to;
+} MovedLabel;
+
+typedef enum ReloadStatus {
+    RELOAD_PATCHED,
+    // a label in the program would end up somewhere else, so jumps and pointers the program keeps
+    // would point into the wrong code
+    RELOAD_MOVED,
+    // the program counter would end up in the middle of an instruction, or a return address on the
+    // stack would no longer return right after the call that pushed it
+    RELOAD_MISALIGNED,
+} ReloadStatus;
+
+/// Writes every byte in which `next` differs from `prev` into `cpu`'s memory, and leaves
+/// everything else alone: the registers, the stack, data the program changed since it was loaded
+/// and the framebuffer. Only call it between instructions. Nothing is written unless the result is
+/// RELOAD_PATCHED, labels that moved are pushed to `moved` (MovedLabel) for RELOAD_MOVED.
+ReloadStatus patchProgram(CPU* cpu, const Executable* prev, const Executable* next, vec_t* moved,
+                          size_t* patched);
+
+/// Watches a source with inotify, and reassembles and patches it into the running program
+/// whenever it's saved
+typedef struct HotReload {
+    const char* path;
+    int inotify_fd;
+    // name of the source in its directory, which is watched instead of the file itself so editors
+    // that save by replacing the file don't end the watch
+    const char* name;
+    AssemblySession session;
+    // the program that's running, `exec` points into `source`
+    string_t source;
+    Executable exec;
+    // number of times the program was patched
+    size_t reloads;
+} HotReload;
+
+/// Starts watching `path` and assembles it as the program that's running now, returns false if
+/// the source can't be watched
+bool openHotReload(HotReload* reload, const char* path);
+void closeHotReload(HotReload* reload);
+
+/// Reloads the source if it was saved since the last call, without waiting for it. Prints what
+/// happened and returns true if `cpu` was patched.
+bool pollHotReload(HotReload* reload, CPU* cpu);
+
+/// Runs `cpu` until it halts, reloading the source between instructions every time it's saved
+int runCpuHotReload(CPU* cpu, HotReload* reload);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __OXEY_CCE_LOCKSTEP_H
+#define __OXEY_CCE_LOCKSTEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu.h"
+
+// 16 byte lanes fill one SSE register, 32 fill an AVX2 one. Build with -DLOCKSTEP_LANES=32 (and
+// -mavx2) to run twice as many VMs per step.
+#ifndef LOCKSTEP_LANES
+#define LOCKSTEP_LANES 16
+#endif
+
+#define LANE_ALIGN 64
+
+/// Runs LOCKSTEP_LANES copies of the same program side by side. The registers of every lane are
+/// kept as a structure of arrays so instructions that all lanes agree on execute as a single pass
+/// over each register column, which the compiler turns into vector instructions. Every lane owns
+/// its own stack and memory, stored in `lanes`. Lanes that branch differently from the rest are
+/// masked out and rejoin once the others catch up to their program counter.
+typedef struct LockstepCpu {
+    _Alignas(LANE_ALIGN) uint16_t program_counter[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t accumulator[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t reg_0[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t reg_1[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t reg_H[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t reg_L[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) Flags flags[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t stackptr[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t baseptr[LOCKSTEP_LANES];
+    // 0xFF while a lane has not halted yet, 0 afterwards
+    _Alignas(LANE_ALIGN) uint8_t active[LOCKSTEP_LANES];
+    // Per lane stack and memory. The register fields of these are only up to date between a call
+    // to `gatherLane` and `scatterLane`.
+    CPU lanes[LOCKSTEP_LANES];
+} LockstepCpu;
+
+void initLockstep(LockstepCpu* ls);
+void freeLockstep(LockstepCpu* ls);
+void loadProgramLockstep(LockstepCpu* ls, const uint8_t* program, uint16_t length);
+
+/// Copies the registers of a lane into `ls->lanes[lane]` and returns it, so it can be inspected
+/// or modified like a regular CPU.
+CPU* gatherLane(LockstepCpu* ls, size_t lane);
+/// Writes the registers of `ls->lanes[lane]` back into the lane.
+void scatterLane(LockstepCpu* ls, size_t lane);
+
+/// Number of lanes that have not halted yet
+size_t activeLanes(const LockstepCpu* ls);
+
+/// Executes one instruction for every lane sitting at the lowest program counter, returns the
+/// number of lanes that took part.
+size_t stepLockstep(LockstepCpu* ls);
+/// Steps until every lane has halted or `max_steps` steps were taken, 0 meaning no limit. Returns
+/// the number of steps taken. Unlike `runCpu`, the trap flag is ignored.
+size_t runLockstep(LockstepCpu* ls, size_t max_steps);
+
+#endif
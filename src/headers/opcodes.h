@@ -0,0 +1,346 @@
+#ifndef __OXEY_CCE_OPCODES_H
+#define __OXEY_CCE_OPCODES_H
+
+#include <stdint.h>
+
+typedef enum AddrMode {
+    // no operand, or only registers
+    MODE_IMPLIED,
+    // the operand is the value
+    MODE_IMM,
+    // the operand is a memory address
+    MODE_ABS,
+    // memory at L
+    MODE_ML,
+    // memory at HL
+    MODE_MHL,
+    // the operand is the offset of a stack slot below BP
+    MODE_BPI,
+    // the operand is an address in the program to jump to
+    MODE_CODE,
+} AddrMode;
+
+/// Bytes following the opcode, 16 bit operands are big endian
+typedef enum OperandLayout {
+    OPERANDS_NONE,
+    OPERANDS_U8,
+    OPERANDS_U16,
+    // flag mask followed by a jump target, only used by JEXT
+    OPERANDS_U8_U16,
+} OperandLayout;
+
+/// Where execution can go after an instruction
+typedef enum Flow {
+    // the next instruction
+    FLOW_NEXT,
+    // only the operand's target
+    FLOW_JUMP,
+    // the operand's target or the next instruction
+    FLOW_BRANCH,
+    // the operand's target, and the next instruction once it returns
+    FLOW_CALL,
+    // wherever the stack says
+    FLOW_RET,
+    // nowhere, HALT and RESET
+    FLOW_STOP,
+} Flow;
+
+// clang-format off
+
+/// Every opcode of the CPU, `Opcode`, `OP_TABLE` and `OPCODE_INFO` are all generated from this:
+///
+///   X(opcode, name, addressing mode, operand layout, length in bytes, cycles, control flow)
+///
+/// Unused opcodes are marked with U(opcode) and execute as NOOP. Cycles are a rough relative cost:
+/// one per byte of the instruction, one per memory access and extra for MULW and DIVW.
+#define OPCODES(X, U)                                                     \
+    X(0x00, NOOP,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x01, HALT,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_STOP)   \
+    X(0x02, EI,         MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x03, DI,         MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x04, ET,         MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x05, DT,         MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x06, CLRA,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x07, RESET,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_STOP)   \
+    X(0x08, LOAD_I,     MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x09, LOAD_IM,    MODE_ABS,     OPERANDS_U16,    3, 4, FLOW_NEXT)   \
+    X(0x0A, LOAD_ML,    MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x0B, LOAD_MHL,   MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x0C, LOAD_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x0D, LOAD_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x0E, LOAD_L,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x0F, LOAD_H,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x10, LOAD_L_I,   MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x11, STORE_IM,   MODE_ABS,     OPERANDS_U16,    3, 4, FLOW_NEXT)   \
+    X(0x12, STORE_ML,   MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x13, STORE_MHL,  MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x14, STORE_R0,   MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x15, STORE_R1,   MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x16, STORE_L,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x17, STORE_H,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x18, LOAD_HL_I,  MODE_IMM,     OPERANDS_U16,    3, 3, FLOW_NEXT)   \
+    X(0x19, XCH_IM,     MODE_ABS,     OPERANDS_U16,    3, 5, FLOW_NEXT)   \
+    X(0x1A, XCH_ML,     MODE_ML,      OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x1B, XCH_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x1C, XCH_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x1D, XCH_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x1E, XCH_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x1F, XCH_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x20, ADD_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x21, ADD_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x22, ADD_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x23, ADD_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x24, ADD_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x25, ADD_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x26, ADD_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x27, ADD_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x28, ADC_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x29, ADC_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x2A, ADC_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x2B, ADC_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x2C, ADC_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x2D, ADC_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x2E, ADC_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x2F, ADC_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x30, SUB_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x31, SUB_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x32, SUB_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x33, SUB_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x34, SUB_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x35, SUB_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x36, SUB_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x37, SUB_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x38, SBC_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x39, SBC_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x3A, SBC_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x3B, SBC_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x3C, SBC_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x3D, SBC_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x3E, SBC_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x3F, SBC_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x40, INC_HL,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x41, INC_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x42, INC_ML,     MODE_ML,      OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x43, INC_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x44, INC_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x45, INC_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x46, INC_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x47, INC_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x48, DEC_HL,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x49, DEC_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x4A, DEC_ML,     MODE_ML,      OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x4B, DEC_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x4C, DEC_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x4D, DEC_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x4E, DEC_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x4F, DEC_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x50, NEG_HL,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x51, NEG_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x52, NEG_ML,     MODE_ML,      OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x53, NEG_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x54, NEG_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x55, NEG_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x56, NEG_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x57, NEG_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x58, NOT_HL,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x59, NOT_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x5A, NOT_ML,     MODE_ML,      OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x5B, NOT_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0x5C, NOT_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x5D, NOT_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x5E, NOT_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x5F, NOT_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x60, AND_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x61, AND_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x62, AND_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x63, AND_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x64, AND_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x65, AND_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x66, AND_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x67, AND_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x68, OR_I,       MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x69, OR_ACC,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x6A, OR_ML,      MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x6B, OR_MHL,     MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x6C, OR_R0,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x6D, OR_R1,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x6E, OR_L,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x6F, OR_H,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x70, XOR_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x71, XOR_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x72, XOR_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x73, XOR_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x74, XOR_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x75, XOR_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x76, XOR_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x77, XOR_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x78, SHL_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x79, MIN_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0x7A, SHL_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x7B, SHL_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x7C, SHL_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x7D, SHL_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x7E, SHL_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x7F, SHL_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x80, SHR_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0x81, MAX_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0x82, SHR_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x83, SHR_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x84, SHR_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x85, SHR_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x86, SHR_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x87, SHR_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x88, ROL_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    U(0x89)                                                               \
+    X(0x8A, ROL_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x8B, ROL_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x8C, ROL_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x8D, ROL_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x8E, ROL_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x8F, ROL_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x90, ROR_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    U(0x91)                                                               \
+    X(0x92, ROR_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x93, ROR_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0x94, ROR_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x95, ROR_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x96, ROR_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x97, ROR_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x98, ADDW_I,     MODE_IMM,     OPERANDS_U16,    3, 3, FLOW_NEXT)   \
+    X(0x99, ADDW_ACC,   MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x9A, ADDW_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x9B, ADDW_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x9C, SUBW_I,     MODE_IMM,     OPERANDS_U16,    3, 3, FLOW_NEXT)   \
+    X(0x9D, SUBW_ACC,   MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x9E, SUBW_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0x9F, SUBW_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xA0, MULW_I,     MODE_IMM,     OPERANDS_U16,    3, 5, FLOW_NEXT)   \
+    X(0xA1, MULW_ACC,   MODE_IMPLIED, OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0xA2, MULW_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0xA3, MULW_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 3, FLOW_NEXT)   \
+    X(0xA4, DIVW_I,     MODE_IMM,     OPERANDS_U16,    3, 9, FLOW_NEXT)   \
+    X(0xA5, DIVW_ACC,   MODE_IMPLIED, OPERANDS_NONE,   1, 7, FLOW_NEXT)   \
+    X(0xA6, DIVW_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 7, FLOW_NEXT)   \
+    X(0xA7, DIVW_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 7, FLOW_NEXT)   \
+    X(0xA8, JMP,        MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_JUMP)   \
+    X(0xA9, JS,         MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAA, JNS,        MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAB, JZ,         MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAC, JNZ,        MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAD, JC,         MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAE, JNC,        MODE_CODE,    OPERANDS_U16,    3, 3, FLOW_BRANCH) \
+    X(0xAF, JEXT,       MODE_CODE,    OPERANDS_U8_U16, 4, 4, FLOW_BRANCH) \
+    X(0xB0, CMP_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0xB1, CMP_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xB2, CMP_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xB3, CMP_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xB4, CMP_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xB5, CMP_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xB6, CMP_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xB7, CMP_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xB8, PUSH_I,     MODE_IMM,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xB9, PUSH_ACC,   MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBA, PUSH_R0,    MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBB, PUSH_R1,    MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBC, PUSH_L,     MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBD, PUSH_H,     MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBE, PUSH_BP,    MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xBF, PUSH_FLAGS, MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC0, POP_IM,     MODE_ABS,     OPERANDS_U16,    3, 5, FLOW_NEXT)   \
+    X(0xC1, POP_ACC,    MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC2, POP_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC3, POP_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC4, POP_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC5, POP_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC6, POP_BP,     MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC7, POP_FLAGS,  MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xC8, CALL,       MODE_CODE,    OPERANDS_U16,    3, 4, FLOW_CALL)   \
+    X(0xC9, RET,        MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_RET)    \
+    X(0xCA, ENTER,      MODE_IMM,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xCB, LEAVE,      MODE_IMPLIED, OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xCC, LOAD_BPI,   MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xCD, STORE_BPI,  MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xCE, ADD_L_I,    MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0xCF, ADD_HL_I,   MODE_IMM,     OPERANDS_U16,    3, 3, FLOW_NEXT)   \
+    X(0xD0, MIN_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0xD1, RET_I,      MODE_IMM,     OPERANDS_U8,     2, 3, FLOW_RET)    \
+    X(0xD2, MIN_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xD3, MIN_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xD4, MIN_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xD5, MIN_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xD6, MIN_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xD7, MIN_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xD8, MAX_I,      MODE_IMM,     OPERANDS_U8,     2, 2, FLOW_NEXT)   \
+    X(0xD9, CMP_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xDA, MAX_ML,     MODE_ML,      OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xDB, MAX_MHL,    MODE_MHL,     OPERANDS_NONE,   1, 2, FLOW_NEXT)   \
+    X(0xDC, MAX_R0,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xDD, MAX_R1,     MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xDE, MAX_L,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xDF, MAX_H,      MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    X(0xE0, XCH_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE1, ADD_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE2, ADC_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE3, SUB_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE4, SBC_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE5, INC_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE6, DEC_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE7, NEG_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE8, NOT_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xE9, AND_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xEA, OR_BPI,     MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xEB, XOR_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xEC, SHL_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xED, SHR_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xEE, ROL_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xEF, ROR_BPI,    MODE_BPI,     OPERANDS_U8,     2, 3, FLOW_NEXT)   \
+    X(0xF0, WAIT,       MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)   \
+    U(0xF1)                                                               \
+    U(0xF2)                                                               \
+    U(0xF3)                                                               \
+    U(0xF4)                                                               \
+    U(0xF5)                                                               \
+    U(0xF6)                                                               \
+    U(0xF7)                                                               \
+    U(0xF8)                                                               \
+    U(0xF9)                                                               \
+    U(0xFA)                                                               \
+    U(0xFB)                                                               \
+    U(0xFC)                                                               \
+    U(0xFD)                                                               \
+    U(0xFE)                                                               \
+    X(0xFF, BRK,        MODE_IMPLIED, OPERANDS_NONE,   1, 1, FLOW_NEXT)
+
+#define OPCODE_ENUM(code, name, ...) OP_##name = code,
+#define OPCODE_ENUM_UNUSED(code)
+
+typedef enum Opcode {
+    OPCODES(OPCODE_ENUM, OPCODE_ENUM_UNUSED)
+} Opcode;
+
+// clang-format on
+
+typedef struct OpcodeInfo {
+    // NULL for unused opcodes
+    const char* mnemonic;
+    AddrMode mode;
+    OperandLayout operands;
+    uint8_t length;
+    uint8_t cycles;
+    Flow flow;
+} OpcodeInfo;
+
+extern const OpcodeInfo OPCODE_INFO[256];
+
+// JEXT
+#define MAX_OPCODE_LENGTH 4
+
+static inline uint8_t opcodeLength(uint8_t op) { return OPCODE_INFO[op].length; }
+
+/// Returns where the jump, branch or call at `code` goes
+static inline uint16_t jumpTarget(const uint8_t* code) {
+    const uint8_t* addr = OPCODE_INFO[code[0]].operands == OPERANDS_U8_U16 ? &code[2] : &code[1];
+    return (uint16_t)((addr[0] << 8) | addr[1]);
+}
+
+#endif
@@ -6,12 +6,16 @@
 
 #define CAST(operation, type) (*(type*)(operation))
 
+struct Arena;
+
 typedef struct {
     size_t len;
     size_t capacity;
     size_t elem_size;
 
     void* ptr;
+    // NULL for vecs on the heap, otherwise the arena ptr comes from and grows in
+    struct Arena* arena;
 } vec_t;
 
 typedef struct {
@@ -22,6 +26,9 @@ typedef struct {
 } vec_iter_t;
 
 vec_t new_vec(size_t capacity, size_t elem_size);
+// a vec whose buffer lives in `arena`, freeing it is a no-op and it goes away with the arena.
+// Unlike `new_vec` the buffer isn't zeroed.
+vec_t new_vec_in(struct Arena* arena, size_t capacity, size_t elem_size);
 void free_vec(vec_t* vec, void elem_destructor(void*));
 
 size_t len_vec(const vec_t* vec);
@@ -3,6 +3,6 @@
 
 #include "tokenizer.h"
 
-size_t parse_immediate(Token* token);
+size_t parse_immediate(const Token* token);
 
 #endif
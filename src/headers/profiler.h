@@ -0,0 +1,32 @@
+#ifndef __OXEY_CCE_PROFILER_H
+#define __OXEY_CCE_PROFILER_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+#include "debug_info.h"
+#include "oslice.h"
+
+// rows printed per section of the report
+#define PROFILE_TOP 20
+
+/// Flat execution counters, one per opcode and one per guest address
+typedef struct Profile {
+    uint64_t instructions;
+    uint64_t opcodes[256];
+    uint64_t addresses[MEMORY_SIZE];
+} Profile;
+
+void initProfile(Profile* profile);
+
+/// Same as `runCpu`, but counts every instruction it executes into `profile`. The trap flag is
+/// ignored so stepping doesn't end up in the numbers.
+int runCpuProfiled(CPU* cpu, Profile* profile);
+
+/// Prints the hottest opcodes, addresses and source lines. Addresses are symbolized and mapped to
+/// lines with `info`, the text of the lines is taken from `source`.
+void printProfile(const Profile* profile, const DebugInfo* info, slice_t source);
+/// `printProfile` without the header, for counters that don't come from `runCpuProfiled`
+void printHotspots(const Profile* profile, const DebugInfo* info, slice_t source);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __OXEY_CCE_SAMPLER_H
+#define __OXEY_CCE_SAMPLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "callgraph.h"
+#include "cpu.h"
+#include "debug_info.h"
+#include "oslice.h"
+
+// about four and a half minutes at 1000 Hz, later samples are dropped
+#define SAMPLE_CAPACITY (1 << 18)
+
+typedef struct Sample {
+    uint16_t pc;
+    uint8_t opcode;
+    // top of the shadow call stack, UINT32_MAX without a call graph
+    uint32_t node;
+} Sample;
+
+/// Starts recording where `cpu` is `hz` times per second of process CPU time from a SIGPROF
+/// handler. Nothing in the run loop changes, so the cost is one signal per sample. If `graph` is
+/// not NULL the current call stack is recorded as well. Returns false if the timer couldn't be
+/// set up.
+bool startSampler(const CPU* cpu, const CallGraph* graph, unsigned hz);
+void stopSampler(void);
+
+/// Number of samples taken since the sampler was started, including dropped ones
+size_t samplesTaken(void);
+const Sample* samples(void);
+
+/// Prints the hottest sampled opcodes, addresses, source lines and call stacks
+void printSamples(const DebugInfo* info, slice_t source, const CallGraph* graph);
+
+#endif
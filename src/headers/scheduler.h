@@ -0,0 +1,53 @@
+#ifndef __OXEY_CCE_SCHEDULER_H
+#define __OXEY_CCE_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+#include "ovec.h"
+
+#define DEFAULT_SLICE 1024
+
+typedef enum VmState {
+    VM_READY,
+    // sitting on a WAIT instruction with an empty input buffer
+    VM_PARKED,
+    VM_HALTED,
+} VmState;
+
+typedef struct ScheduledVm {
+    CPU* cpu;
+    VmState state;
+} ScheduledVm;
+
+/// Runs any number of VMs on the calling thread. Each round every ready VM gets a slice of at most
+/// `slice` instructions. VMs that reach a WAIT instruction without input are parked and cost
+/// nothing until `postInput` hands them a value, so idle VMs don't use any host time.
+typedef struct Scheduler {
+    size_t slice;
+    // ScheduledVm, indexed by the id returned from `addVm`
+    vec_t vms;
+    // ids of the VMs that will run next round
+    vec_t ready;
+    vec_t next;
+} Scheduler;
+
+void initScheduler(Scheduler* s, size_t slice);
+/// Frees the scheduler itself, the CPUs are owned by the caller.
+void freeScheduler(Scheduler* s);
+
+/// Adds a loaded CPU to the scheduler and returns its id. The CPU must outlive the scheduler.
+size_t addVm(Scheduler* s, CPU* cpu);
+VmState vmState(const Scheduler* s, size_t id);
+
+/// Writes `input` into the VM's input ring buffer and unparks it. Returns false if the buffer is
+/// full.
+bool postInput(Scheduler* s, size_t id, char input);
+
+/// Gives every ready VM one slice, returns the number of VMs still ready afterwards.
+size_t runRound(Scheduler* s);
+/// Runs rounds until every VM is either parked or halted, returns the number of rounds.
+size_t runScheduler(Scheduler* s);
+
+#endif
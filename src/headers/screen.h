@@ -15,5 +15,7 @@ typedef struct {
 } screen_buffer;
 
 void initScreen(CPU* cpu);
+/// Like `initScreen`, but runs `run(data)` on the CPU thread instead of `runCpu(cpu)`
+void initScreenWith(CPU* cpu, SDL_ThreadFunction run, void* data);
 
 #endif
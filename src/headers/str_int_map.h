@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "oslice.h"
 
@@ -15,23 +16,30 @@ typedef struct si_kv {
     size_t value;
 } si_kv;
 
-typedef struct si_bucket_t {
-    slice_t key;
+// One slot of the table, 24 bytes so more of them fit in a cache line than a slice_t would allow.
+// `hash` is the low half of the key's hash and never 0 for a used slot, so 0 marks an empty one.
+typedef struct si_slot_t {
+    uint32_t hash;
+    uint32_t len;
+    const char* str;
     size_t value;
-    struct si_bucket_t* prev;
-    struct si_bucket_t* next;
-} si_bucket_t;
+} si_slot_t;
 
+// Open addressing with Robin Hood probing: an entry can take the slot of one that's closer to its
+// own home slot, which keeps every probe sequence short. Keys are borrowed, the map never copies
+// them, so whatever they point to has to outlive the map.
 typedef struct si_map_t {
+    // always a power of two
     size_t capacity;
     size_t len;
-    si_bucket_t* buckets;
+    si_slot_t* slots;
+    // NULL for maps on the heap, otherwise the slots come from the arena and go away with it
+    struct Arena* arena;
 } si_map_t;
 
 typedef struct si_map_iter_t {
-    si_bucket_t* ptr;
-    const si_bucket_t* end;
-    size_t bucket_idx;
+    const si_slot_t* ptr;
+    const si_slot_t* end;
 } si_map_iter_t;
 
 // FNV 1A 64-bit algorithm from wikipedia:
@@ -42,17 +50,21 @@ size_t hash_str(slice_t key);
 int cmp_str(slice_t lhs, slice_t rhs);
 
 si_map_t new_map();
-// si_map_t new_map_with_capacity(size_t capacity);
-inline size_t capacity_map(const si_map_t* map) { return map->capacity; }
-inline size_t len_map(const si_map_t* map) { return map->len; }
+// `capacity` is how many keys fit before the map first grows, 0 for the default
+si_map_t new_map_with_capacity(size_t capacity);
+si_map_t new_map_in(struct Arena* arena, size_t capacity);
+static inline size_t capacity_map(const si_map_t* map) { return map->capacity; }
+static inline size_t len_map(const si_map_t* map) { return map->len; }
 
 size_t* get_map(const si_map_t* map, slice_t key);
+// returns false without changing anything if `key` is already in the map
 bool insert_map(si_map_t* map, slice_t key, size_t value);
 bool remove_map(si_map_t* map, slice_t key);
 void clear_map(si_map_t* map);
 void free_map(si_map_t* map);
 
 si_map_iter_t iter_from_map(const si_map_t* str);
+// both return an entry with a NULL key once every entry has been visited
 si_kv map_iter_peek(const si_map_iter_t* iter);
 si_kv map_iter_next(si_map_iter_t* iter);
 
@@ -0,0 +1,39 @@
+#ifndef __OXEY_CCE_SYMBOLS_H
+#define __OXEY_CCE_SYMBOLS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cpu.h"
+#include "oslice.h"
+#include "ovec.h"
+#include "str_int_map.h"
+
+typedef struct Symbol {
+    slice_t name;
+    uint16_t addr;
+} Symbol;
+
+/// Labels of an executable sorted by address, used to turn guest addresses back into names
+typedef struct SymbolTable {
+    // Symbol, names are owned by the table
+    vec_t symbols;
+} SymbolTable;
+
+SymbolTable newSymbols(size_t capacity);
+/// Copies `name` into the table. Symbols have to be sorted with `sortSymbols` before lookups.
+void addSymbol(SymbolTable* table, slice_t name, uint16_t addr);
+void sortSymbols(SymbolTable* table);
+/// Collects every label pointing inside a program of `size` bytes
+SymbolTable symbolsFromLabels(const si_map_t* labels, size_t size);
+void freeSymbols(SymbolTable* table);
+
+/// Returns the closest label at or before `addr`, or NULL if there is none
+const Symbol* findSymbol(const SymbolTable* table, uint16_t addr);
+/// Prints `addr` as `label+offset`, or as a hex address if no label precedes it
+void fprintSymbolized(FILE* out, const SymbolTable* table, uint16_t addr);
+
+/// Returns line `line_nr` of `source` without its newline, counting from 1
+slice_t sourceLine(slice_t source, size_t line_nr);
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef __OXEY_CCE_TOKENIZER_H
 #define __OXEY_CCE_TOKENIZER_H
 
+#include "arena.h"
 #include "oslice.h"
 #include "ostring.h"
 #include "ovec.h"
+#include "str_int_map.h"
 
 typedef enum AssemblyToken {
     NOOP_T,
@@ -52,6 +54,7 @@ typedef enum AssemblyToken {
     LEAVE_T,
     MIN_T,
     MAX_T,
+    WAIT_T,
 
     ACC_T,
     R0_T,
@@ -87,27 +90,58 @@ typedef enum AssemblyToken {
     R_CURLY_T,
 } TokenSymbol;
 
+#define NO_LABEL UINT32_MAX
+
 typedef struct {
     TokenSymbol tok;
+    // id of the label a LABEL_DEF_T, LABEL_REF_T or LABEL_IDX_T token names, NO_LABEL for others.
+    // Every mention of the same name gets the same id, ids count up from 0.
+    uint32_t label;
     slice_t substr;
     size_t char_nr;
 } Token;
 
+/// A line with at least one token, its tokens are `count` consecutive entries of
+/// `TokenLines.tokens` starting at `offset`
 typedef struct {
-    vec_t tokens;
+    size_t offset;
+    size_t count;
     slice_t substr;
     size_t line_nr;
 } TokenLine;
 
+/// Every token of a program in one array, plus an index of the lines they're on. Empty lines
+/// aren't in the index.
 typedef struct {
+    vec_t tokens;
     vec_t lines;
+    // label name -> id
+    si_map_t label_ids;
+    // slice_t, the name of every label id
+    vec_t label_names;
+    // lines in the tokenized source, including the blank ones that aren't in `lines`
+    size_t line_count;
 } TokenLines;
 
-void freeTokenLine(void* tokenLine);
+/// Both arrays come from `arena` when it isn't NULL, `freeTokenLines` is a no-op for those
+TokenLines newTokenLines(Arena* arena, size_t token_capacity, size_t line_capacity);
 void freeTokenLines(void* tokenLines);
+/// Iterates over the tokens of `line`
+vec_iter_t iterTokenLine(const TokenLines* lines, const TokenLine* line);
+Token* firstToken(const TokenLines* lines, const TokenLine* line);
+static inline size_t labelCount(const TokenLines* lines) { return len_vec(&lines->label_names); }
+/// The name of label `id` without the `.` or `:` around it
+slice_t labelName(const TokenLines* lines, uint32_t id);
+/// The id of the label called `name`, a new one if `lines` hasn't seen it before
+uint32_t internLabelName(TokenLines* lines, slice_t name);
 TokenSymbol tokenizeSymbol(str_iter_t* iter);
-TokenLine tokenizeLine(str_iter_t* iter, size_t line_nr);
-TokenLines tokenizeProgram(slice_t program);
+/// Appends the tokens of the line `iter` is at to `out`, returns false for lines without any
+bool tokenizeLine(str_iter_t* iter, size_t line_nr, TokenLines* out);
+TokenLines tokenizeProgram(slice_t program, Arena* arena);
+/// Tokenizes `program` like `tokenizeProgram`, but stops at the first line that starts `until` or
+/// more bytes in. `tokenized` is where that line starts, or where a NUL or the end of `program`
+/// stopped the tokenizer before it got there.
+TokenLines tokenizeLinesUntil(slice_t program, size_t until, Arena* arena, size_t* tokenized);
 
 bool is_token_op(TokenSymbol token);
 bool is_token_register(TokenSymbol token);
@@ -0,0 +1,77 @@
+#ifndef __OXEY_CCE_TRACE_H
+#define __OXEY_CCE_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cpu.h"
+#include "ovec.h"
+
+#define TRACE_MAGIC "CTRC"
+#define TRACE_VERSION 1
+// size of a record in a trace file
+#define TRACE_RECORD_SIZE 16
+// keeps the last 64k instructions, 1 MiB of records
+#define DEFAULT_TRACE_CAPACITY (1 << 16)
+
+/// One executed instruction, with the registers as they were after it ran
+typedef struct TraceRecord {
+    // number of instructions executed before this one
+    uint64_t cycle;
+    uint16_t pc;
+    uint8_t opcode;
+    // the two bytes following the opcode, whether the instruction uses them or not
+    uint8_t operands[2];
+    uint8_t acc;
+    uint8_t flags;
+    uint8_t sp;
+} TraceRecord;
+
+/// Ring buffer holding the most recent `capacity` instructions. A writer thread can drain it into a
+/// file while the VM runs, if it falls more than `capacity` records behind the oldest ones are
+/// dropped instead of slowing the VM down.
+typedef struct Trace {
+    TraceRecord* ring;
+    // always a power of two
+    size_t capacity;
+    // total number of records written, the next one goes to `ring[head % capacity]`
+    _Atomic uint64_t head;
+
+    FILE* out;
+    // records handed to `out` so far, only touched by the writer
+    uint64_t written;
+    uint64_t dropped;
+    atomic_bool streaming;
+    void* writer;
+} Trace;
+
+/// `capacity` is rounded up to a power of two, 0 picks DEFAULT_TRACE_CAPACITY
+void initTrace(Trace* trace, size_t capacity);
+void freeTrace(Trace* trace);
+
+/// Like `runCpu`, but records every instruction into `trace`. Stops on the trap flag the same way.
+int runCpuTraced(CPU* cpu, Trace* trace);
+
+/// Starts a thread that streams every record into the file at `path`. Returns false if the file
+/// couldn't be created or the platform has no threads.
+bool startTraceWriter(Trace* trace, const char* path);
+/// Writes whatever is left, closes the file and returns the number of dropped records
+uint64_t stopTraceWriter(Trace* trace);
+
+/// Writes the records still in the ring, oldest first. That's at most `capacity - 1` of them, as
+/// the oldest slot may be getting overwritten. Safe to call while the VM is running.
+bool dumpTrace(Trace* trace, const char* path);
+
+/// Writes the ring to `path` like `dumpTrace` when the process gets a SIGSEGV, SIGBUS, SIGILL,
+/// SIGFPE, SIGABRT, SIGINT or SIGTERM, and then lets the signal end it the way it would have.
+/// Only one trace is dumped this way, returns false if the handlers couldn't be installed.
+bool dumpTraceOnSignal(Trace* trace, const char* path);
+/// Puts the default handlers back, call it before freeing the trace
+void stopDumpOnSignal(void);
+
+/// Reads every record of a trace file into `records`, which has to hold TraceRecord
+bool readTrace(const char* path, vec_t* records);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef __OXEY_UTIL_H
 #define __OXEY_UTIL_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -16,4 +17,19 @@ static inline size_t max(size_t a, size_t b) { return a > b ? a : b; }
 string_t read_file_to_str(const char* path);
 void write_file(const char* path, slice_t content);
 
+/// A file's contents, mapped read-only where the platform allows it and read into one buffer
+/// otherwise. Tokens and labels point straight into `content`, so keep the file around for as
+/// long as anything assembled from it is.
+typedef struct MappedFile {
+    slice_t content;
+    // length of the mapping, 0 when nothing is mapped
+    size_t mapped_len;
+    // the buffer the file was read into when it couldn't be mapped
+    char* buffer;
+} MappedFile;
+
+/// Returns false if `path` can't be opened, an empty file gives an empty `content`
+bool map_file(const char* path, MappedFile* file);
+void unmap_file(MappedFile* file);
+
 #endif
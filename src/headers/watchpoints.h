@@ -0,0 +1,53 @@
+#ifndef __OXEY_CCE_WATCHPOINTS_H
+#define __OXEY_CCE_WATCHPOINTS_H
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+#define WATCH_WORDS (MEMORY_SIZE / 64)
+
+typedef enum WatchKind {
+    WATCH_READ = 1 << 0,
+    WATCH_WRITE = 1 << 1,
+} WatchKind;
+
+typedef struct WatchHit {
+    // address of the instruction that accessed memory
+    uint16_t pc;
+    uint16_t addr;
+    WatchKind kind;
+    uint8_t old_value;
+    uint8_t new_value;
+} WatchHit;
+
+typedef void (*WatchHandler)(CPU* cpu, const WatchHit* hit, void* data);
+
+/// Shadow bitmaps with one bit per guest address. They're only checked by the instrumented
+/// handler table `runCpuWatched` uses, so `runCpu` doesn't pay anything for them.
+typedef struct Watchpoints {
+    uint64_t reads[WATCH_WORDS];
+    uint64_t writes[WATCH_WORDS];
+    WatchHandler on_hit;
+    void* data;
+    // the access of the instruction that is currently executing, if it hit a watchpoint
+    uint8_t pending;
+    uint16_t pending_addr;
+    uint8_t pending_old;
+} Watchpoints;
+
+void initWatchpoints(Watchpoints* w, WatchHandler on_hit, void* data);
+/// Watches every address from `lo` to `hi`, both inclusive, for the accesses in `kinds`
+void watchRange(Watchpoints* w, uint16_t lo, uint16_t hi, WatchKind kinds);
+void unwatchRange(Watchpoints* w, uint16_t lo, uint16_t hi, WatchKind kinds);
+
+/// Like `runCpu`, but calls `w->on_hit` after every instruction that read or wrote a watched
+/// address. Ignores the trap flag.
+int runCpuWatched(CPU* cpu, Watchpoints* w);
+/// Runs a single instruction like `stepCpu` does and returns the next opcode
+int stepCpuWatched(CPU* cpu, Watchpoints* w);
+
+/// Default handler, prints the access with `data` pointing to the program's `DebugInfo`
+void printWatchHit(CPU* cpu, const WatchHit* hit, void* data);
+
+#endif
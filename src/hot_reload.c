@@ -0,0 +1,242 @@
+#include "headers/hot_reload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "headers/errors.h"
+#include "headers/instructions.h"
+#include "headers/util.h"
+
+// Whether an instruction of `exec` starts at `addr`
+static bool startsInstruction(const Executable* exec, uint16_t addr) {
+    const LineEntry* line = findLine(&exec->debug_info, addr);
+    return addr < exec->size && line != NULL && line->addr == addr;
+}
+
+// Address of the call `ret` returns from in `exec`, 0 if no call ends there
+static uint16_t callBefore(const Executable* exec, uint16_t ret) {
+    if (ret <= PROGRAM_START || ret > exec->size) return 0;
+
+    const LineEntry* line = findLine(&exec->debug_info, (uint16_t)(ret - 1));
+    if (line == NULL || line->addr < PROGRAM_START) return 0;
+
+    const uint8_t op = exec->executable[line->addr];
+    const bool call = OPCODE_INFO[op].flow == FLOW_CALL && line->addr + opcodeLength(op) == ret;
+    return call ? line->addr : 0;
+}
+
+ReloadStatus patchProgram(CPU* cpu, const Executable* prev, const Executable* next, vec_t* moved,
+                          size_t* patched) {
+    *patched = 0;
+
+    // labels that were removed can't be jumped to anymore, only the ones still there can move
+    si_map_iter_t iter = iter_from_map(&prev->labels);
+    si_kv label;
+    while ((label = map_iter_next(&iter)).key.str != NULL) {
+        // constants point outside the program, changing one only changes the code using it
+        if (label.value < PROGRAM_START || label.value >= prev->size) continue;
+
+        const size_t* addr = get_map(&next->labels, label.key);
+        if (addr != NULL && *addr != label.value) {
+            MovedLabel move = (MovedLabel){
+                .name = label.key, .from = (uint16_t)label.value, .to = (uint16_t)*addr};
+            push_vec(moved, &move);
+        }
+    }
+    if (len_vec(moved) > 0) {
+        return RELOAD_MOVED;
+    }
+
+    if (PC >= PROGRAM_START && PC < prev->size && !startsInstruction(next, PC)) {
+        return RELOAD_MISALIGNED;
+    }
+
+    // CALL pushes the address after it high byte first. Anything on the stack that looks like one
+    // has to return right after the same call in the new program, data that happens to look like a
+    // return address only ever makes a reload be refused.
+    for (size_t i = 0; i + 1 < SP; ++i) {
+        const uint16_t ret = (uint16_t)(STACK(i) << 8 | STACK(i + 1));
+        const uint16_t call = callBefore(prev, ret);
+
+        if (call != 0 && (!startsInstruction(next, call) ||
+                          OPCODE_INFO[next->executable[call]].flow != FLOW_CALL ||
+                          opcodeLength(next->executable[call]) != ret - call)) {
+            return RELOAD_MISALIGNED;
+        }
+    }
+
+    // bytes the program changed itself stay as they are, unless the new source changes them too
+    const size_t size = max(prev->size, next->size);
+    for (size_t addr = 0; addr < size; ++addr) {
+        const uint8_t old = addr < prev->size ? prev->executable[addr] : 0;
+        const uint8_t new = addr < next->size ? next->executable[addr] : 0;
+
+        if (old != new) {
+            MEMORY_W(addr) = new;
+            (*patched)++;
+        }
+    }
+
+    return RELOAD_PATCHED;
+}
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Assembles the source at `reload->path` again, returns false if it has errors
+static bool reassembleSource(HotReload* reload, string_t* source, Executable* exec) {
+    *source = read_file_to_str(reload->path);
+    *exec = reassemble(&reload->session, from_str_slice(*source));
+
+    const slice_t path = from_cstr_slice(reload->path, strlen(reload->path));
+    printDiagnostics(&exec->diagnostics, from_str_slice(*source), path);
+
+    if (countErrors(&exec->diagnostics) > 0) {
+        freeExecutable(exec);
+        free_str(source);
+        return false;
+    }
+
+    return true;
+}
+
+// Patches the saved source into `cpu`, keeping the program that's running if that can't be done
+static bool reloadSource(HotReload* reload, CPU* cpu) {
+    string_t source;
+    Executable exec;
+
+    if (!reassembleSource(reload, &source, &exec)) {
+        printf("not reloading '%s', it has errors\n", reload->path);
+        return false;
+    }
+
+    vec_t moved = new_vec(4, sizeof(MovedLabel));
+    size_t patched;
+    const ReloadStatus status = patchProgram(cpu, &reload->exec, &exec, &moved, &patched);
+
+    if (status == RELOAD_PATCHED) {
+        freeExecutable(&reload->exec);
+        free_str(&reload->source);
+        reload->exec = exec;
+        reload->source = source;
+        reload->reloads++;
+        printf("reloaded '%s', %zu bytes changed\n", reload->path, patched);
+    } else {
+        if (status == RELOAD_MOVED) {
+            printf("not reloading '%s', labels would move under the running program:\n",
+                   reload->path);
+            vec_iter_t labels = iter_from_vec(&moved);
+            MovedLabel* label;
+            while ((label = iter_next(&labels))) {
+                printf("    %.*s: %#06x -> %#06x\n", (int)label->name.len, label->name.str,
+                       label->from, label->to);
+            }
+        } else {
+            printf("not reloading '%s', the program counter or a return address on the stack "
+                   "would end up inside an instruction\n",
+                   reload->path);
+        }
+        freeExecutable(&exec);
+        free_str(&source);
+    }
+
+    free_vec(&moved, NULL);
+    return status == RELOAD_PATCHED;
+}
+
+bool openHotReload(HotReload* reload, const char* path) {
+    const char* slash = strrchr(path, '/');
+    *reload = (HotReload){.path = path, .inotify_fd = -1, .name = slash ? slash + 1 : path};
+
+    reload->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reload->inotify_fd < 0) {
+        return false;
+    }
+
+    char* dir = slash == NULL ? strdup(".") : strndup(path, max((size_t)(slash - path), 1));
+    const int watch = dir != NULL ? inotify_add_watch(reload->inotify_fd, dir,
+                                                      IN_CLOSE_WRITE | IN_MOVED_TO)
+                                  : -1;
+    free(dir);
+    if (watch < 0) {
+        close(reload->inotify_fd);
+        return false;
+    }
+
+    initAssemblySession(&reload->session, from_cstr_slice(path, strlen(path)));
+    reload->source = read_file_to_str(path);
+    reload->exec = reassemble(&reload->session, from_str_slice(reload->source));
+
+    return true;
+}
+
+void closeHotReload(HotReload* reload) {
+    if (reload != NULL && reload->inotify_fd >= 0) {
+        close(reload->inotify_fd);
+        reload->inotify_fd = -1;
+        freeExecutable(&reload->exec);
+        free_str(&reload->source);
+        freeAssemblySession(&reload->session);
+    }
+}
+
+bool pollHotReload(HotReload* reload, CPU* cpu) {
+    // one save is often a few events, they're all handled by a single reload
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool saved = false;
+    ssize_t len;
+
+    while ((len = read(reload->inotify_fd, events, sizeof(events))) > 0) {
+        for (char* at = events; at < events + len;) {
+            const struct inotify_event* event = (const struct inotify_event*)at;
+            if (event->len > 0 && strcmp(event->name, reload->name) == 0) {
+                saved = true;
+            }
+            at += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    if (len < 0 && errno != EAGAIN && errno != EINTR) {
+        return false;
+    }
+
+    return saved && reloadSource(reload, cpu);
+}
+
+#else
+
+bool openHotReload(HotReload* reload, const char* path) {
+    *reload = (HotReload){.path = path, .inotify_fd = -1, .name = path};
+    return false;
+}
+
+void closeHotReload(HotReload* reload) { UNUSED(reload); }
+
+bool pollHotReload(HotReload* reload, CPU* cpu) {
+    UNUSED(reload);
+    UNUSED(cpu);
+    return false;
+}
+
+#endif
+
+int runCpuHotReload(CPU* cpu, HotReload* reload) {
+    uint8_t op = MEMORY(PC);
+
+    while (op != OP_HALT) {
+        for (size_t i = 0; i < HOT_RELOAD_POLL_INTERVAL && op != OP_HALT; ++i) {
+            op = stepCpu(cpu);
+        }
+
+        // a program that halted stays that way, even if a reload would change the HALT
+        if (op != OP_HALT) {
+            pollHotReload(reload, cpu);
+            op = MEMORY(PC);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include "headers/lockstep.h"
+
+#include <stdbool.h>
+
+#include "headers/instructions.h"
+
+#define LANE_LOOP for (size_t i = 0; i < LOCKSTEP_LANES; ++i)
+#define ZS_BITS (ZF_BIT | SF_BIT)
+
+/// The lanes taking part in a single lockstep instruction, plus their operands. Operands are read
+/// from every lane's own memory since lanes are free to modify their copy of the program.
+typedef struct LaneGroup {
+    _Alignas(LANE_ALIGN) uint8_t sel[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint8_t imm[LOCKSTEP_LANES];
+    _Alignas(LANE_ALIGN) uint16_t addr[LOCKSTEP_LANES];
+} LaneGroup;
+
+typedef void (*LaneInstruction)(LockstepCpu* ls, const LaneGroup* g);
+#define LANE_INSTRUCTION(name) static void LANE_##name(LockstepCpu* ls, const LaneGroup* g)
+
+// Branchless per lane select between the new value for selected lanes and the old one for the
+// lanes that are masked out. Written this way so the loops below vectorize.
+#define SELECT(old, val) (uint8_t)(((val) & g->sel[i]) | ((old) & ~g->sel[i]))
+
+#define S_I g->imm[i]
+#define S_ACC ls->accumulator[i]
+#define S_R0 ls->reg_0[i]
+#define S_R1 ls->reg_1[i]
+#define S_H ls->reg_H[i]
+#define S_L ls->reg_L[i]
+
+static inline Flags zs_flags(uint8_t res) {
+    return (Flags)((res == 0 ? ZF_BIT : 0) | ((res & SIGN_BIT) ? SF_BIT : 0));
+}
+
+// `res` and `flag_bits` may refer to `acc`, `val` and `cf`, `flag_bits` may also refer to the
+// result `r`. Only the flags in `flag_mask` are replaced by `flag_bits`.
+#define LANE_ALU(name, len, src, dst, res, flag_mask, flag_bits)                  \
+    LANE_INSTRUCTION(name) {                                                      \
+        LANE_LOOP {                                                               \
+            const uint16_t acc = ls->accumulator[i];                              \
+            const uint16_t val = src;                                             \
+            const uint16_t cf = ls->flags[i] & CF_BIT;                            \
+            UNUSED(acc);                                                          \
+            UNUSED(val);                                                          \
+            UNUSED(cf);                                                           \
+            const uint8_t r = (uint8_t)(res);                                     \
+            const Flags f = (Flags)((ls->flags[i] & ~(flag_mask)) | (flag_bits)); \
+            ls->dst[i] = SELECT(ls->dst[i], r);                                   \
+            ls->flags[i] = SELECT(ls->flags[i], f);                               \
+            ls->program_counter[i] += (uint16_t)(g->sel[i] & (len));              \
+        }                                                                         \
+    }
+
+#define LANE_LOAD(variation, len, src) \
+    LANE_ALU(LOAD_##variation, len, src, accumulator, val, ZS_BITS, zs_flags(r))
+#define LANE_STORE(variation, dst) \
+    LANE_ALU(STORE_##variation, 1, S_ACC, dst, val, ZS_BITS, zs_flags(r))
+#define LANE_ADD(variation, len, src)                                             \
+    LANE_ALU(ADD_##variation, len, src, accumulator, acc + val, ZS_BITS | CF_BIT, \
+             zs_flags(r) | (acc + val > UINT8_MAX ? CF_BIT : 0))
+#define LANE_ADC(variation, len, src)                                                  \
+    LANE_ALU(ADC_##variation, len, src, accumulator, acc + val + cf, ZS_BITS | CF_BIT, \
+             zs_flags(r) | (acc + val + cf > UINT8_MAX ? CF_BIT : 0))
+#define LANE_SUB(variation, len, src)                                             \
+    LANE_ALU(SUB_##variation, len, src, accumulator, acc - val, ZS_BITS | CF_BIT, \
+             zs_flags(r) | (r > val ? CF_BIT : 0))
+#define LANE_SBC(variation, len, src)                                                 \
+    LANE_ALU(SBC_##variation, len, src, accumulator, acc - (uint8_t)(val - (1 - cf)), \
+             ZS_BITS | CF_BIT, zs_flags(r) | (acc >= (uint16_t)(val - (1 - cf)) ? CF_BIT : 0))
+#define LANE_BITWISE(op, name, variation, len, src) \
+    LANE_ALU(name##_##variation, len, src, accumulator, acc op val, ZS_BITS, zs_flags(r))
+#define LANE_CMP(variation, len, src) \
+    LANE_ALU(CMP_##variation, len, src, accumulator, acc, ZS_BITS, zs_flags((uint8_t)(acc - val)))
+#define LANE_INC(variation, dst)                                             \
+    LANE_ALU(INC_##variation, 1, ls->dst[i], dst, val + 1, ZS_BITS | CF_BIT, \
+             zs_flags(r) | (r == 0 ? CF_BIT : 0))
+#define LANE_DEC(variation, dst)                                             \
+    LANE_ALU(DEC_##variation, 1, ls->dst[i], dst, val - 1, ZS_BITS | CF_BIT, \
+             zs_flags(r) | (r == UINT8_MAX ? CF_BIT : 0))
+
+#define LANE_ACC_ALU(family)     \
+    LANE_##family(I, 2, S_I)     \
+    LANE_##family(ACC, 1, S_ACC) \
+    LANE_##family(R0, 1, S_R0)   \
+    LANE_##family(R1, 1, S_R1)   \
+    LANE_##family(L, 1, S_L)     \
+    LANE_##family(H, 1, S_H)
+
+#define LANE_ACC_BITWISE(op, family)        \
+    LANE_BITWISE(op, family, I, 2, S_I)     \
+    LANE_BITWISE(op, family, ACC, 1, S_ACC) \
+    LANE_BITWISE(op, family, R0, 1, S_R0)   \
+    LANE_BITWISE(op, family, R1, 1, S_R1)   \
+    LANE_BITWISE(op, family, L, 1, S_L)     \
+    LANE_BITWISE(op, family, H, 1, S_H)
+
+#define LANE_REG_UNARY(family)      \
+    LANE_##family(ACC, accumulator) \
+    LANE_##family(R0, reg_0)        \
+    LANE_##family(R1, reg_1)        \
+    LANE_##family(L, reg_L)         \
+    LANE_##family(H, reg_H)
+
+LANE_INSTRUCTION(NOOP) { LANE_LOOP ls->program_counter[i] += (uint16_t)(g->sel[i] & 1); }
+LANE_ALU(CLRA, 1, 0, accumulator, 0, ZF_BIT, ZF_BIT)
+
+LANE_LOAD(I, 2, S_I)
+LANE_LOAD(R0, 1, S_R0)
+LANE_LOAD(R1, 1, S_R1)
+LANE_LOAD(L, 1, S_L)
+LANE_LOAD(H, 1, S_H)
+
+LANE_STORE(R0, reg_0)
+LANE_STORE(R1, reg_1)
+LANE_STORE(L, reg_L)
+LANE_STORE(H, reg_H)
+
+LANE_ACC_ALU(ADD)
+LANE_ACC_ALU(ADC)
+LANE_ACC_ALU(SUB)
+LANE_ACC_ALU(SBC)
+LANE_ACC_ALU(CMP)
+LANE_ACC_BITWISE(&, AND)
+LANE_ACC_BITWISE(|, OR)
+LANE_ACC_BITWISE(^, XOR)
+
+LANE_REG_UNARY(INC)
+LANE_REG_UNARY(DEC)
+
+#define LANE_JUMP(name, cond)                                                       \
+    LANE_INSTRUCTION(name) {                                                        \
+        LANE_LOOP {                                                                 \
+            const Flags f = ls->flags[i];                                           \
+            UNUSED(f);                                                              \
+            const uint16_t next = (cond) ? g->addr[i] : ls->program_counter[i] + 3; \
+            ls->program_counter[i] = g->sel[i] ? next : ls->program_counter[i];     \
+        }                                                                           \
+    }
+
+LANE_JUMP(JMP, true)
+LANE_JUMP(JS, f & SF_BIT)
+LANE_JUMP(JNS, !(f & SF_BIT))
+LANE_JUMP(JZ, f & ZF_BIT)
+LANE_JUMP(JNZ, !(f & ZF_BIT))
+LANE_JUMP(JC, f & CF_BIT)
+LANE_JUMP(JNC, !(f & CF_BIT))
+
+#define ACC_ALU_ENTRIES(op)                                           \
+    [OP_##op##_I] = LANE_##op##_I, [OP_##op##_ACC] = LANE_##op##_ACC, \
+    [OP_##op##_R0] = LANE_##op##_R0, [OP_##op##_R1] = LANE_##op##_R1, \
+    [OP_##op##_L] = LANE_##op##_L, [OP_##op##_H] = LANE_##op##_H
+
+#define REG_UNARY_ENTRIES(op)                                           \
+    [OP_##op##_ACC] = LANE_##op##_ACC, [OP_##op##_R0] = LANE_##op##_R0, \
+    [OP_##op##_R1] = LANE_##op##_R1, [OP_##op##_L] = LANE_##op##_L,     \
+    [OP_##op##_H] = LANE_##op##_H
+
+/// Vectorized instructions, every opcode missing from this table runs through `OP_TABLE` one lane
+/// at a time instead.
+static const LaneInstruction LANE_TABLE[256] = {
+    [OP_NOOP] = LANE_NOOP,       [OP_CLRA] = LANE_CLRA,
+
+    [OP_LOAD_I] = LANE_LOAD_I,   [OP_LOAD_R0] = LANE_LOAD_R0,   [OP_LOAD_R1] = LANE_LOAD_R1,
+    [OP_LOAD_L] = LANE_LOAD_L,   [OP_LOAD_H] = LANE_LOAD_H,
+
+    [OP_STORE_R0] = LANE_STORE_R0, [OP_STORE_R1] = LANE_STORE_R1,
+    [OP_STORE_L] = LANE_STORE_L,   [OP_STORE_H] = LANE_STORE_H,
+
+    ACC_ALU_ENTRIES(ADD), ACC_ALU_ENTRIES(ADC), ACC_ALU_ENTRIES(SUB), ACC_ALU_ENTRIES(SBC),
+    ACC_ALU_ENTRIES(CMP), ACC_ALU_ENTRIES(AND), ACC_ALU_ENTRIES(OR),  ACC_ALU_ENTRIES(XOR),
+
+    REG_UNARY_ENTRIES(INC), REG_UNARY_ENTRIES(DEC),
+
+    [OP_JMP] = LANE_JMP, [OP_JS] = LANE_JS, [OP_JNS] = LANE_JNS, [OP_JZ] = LANE_JZ,
+    [OP_JNZ] = LANE_JNZ, [OP_JC] = LANE_JC, [OP_JNC] = LANE_JNC,
+};
+
+void initLockstep(LockstepCpu* ls) {
+    LANE_LOOP {
+        initCpu(&ls->lanes[i]);
+        scatterLane(ls, i);
+        ls->active[i] = 0xFF;
+    }
+}
+
+void freeLockstep(LockstepCpu* ls) {
+    LANE_LOOP {
+        freeCpu(&ls->lanes[i]);
+    }
+}
+
+void loadProgramLockstep(LockstepCpu* ls, const uint8_t* program, uint16_t length) {
+    LANE_LOOP {
+        loadProgram(&ls->lanes[i], program, length);
+    }
+}
+
+CPU* gatherLane(LockstepCpu* ls, size_t lane) {
+    CPU* cpu = &ls->lanes[lane];
+
+    PC = ls->program_counter[lane];
+    ACC = ls->accumulator[lane];
+    R0 = ls->reg_0[lane];
+    R1 = ls->reg_1[lane];
+    H = ls->reg_H[lane];
+    L = ls->reg_L[lane];
+    FLAGS = ls->flags[lane];
+    SP = ls->stackptr[lane];
+    BP = ls->baseptr[lane];
+
+    return cpu;
+}
+
+void scatterLane(LockstepCpu* ls, size_t lane) {
+    CPU* cpu = &ls->lanes[lane];
+
+    ls->program_counter[lane] = PC;
+    ls->accumulator[lane] = ACC;
+    ls->reg_0[lane] = R0;
+    ls->reg_1[lane] = R1;
+    ls->reg_H[lane] = H;
+    ls->reg_L[lane] = L;
+    ls->flags[lane] = FLAGS;
+    ls->stackptr[lane] = SP;
+    ls->baseptr[lane] = BP;
+}
+
+size_t activeLanes(const LockstepCpu* ls) {
+    size_t count = 0;
+    LANE_LOOP {
+        count += ls->active[i] & 1;
+    }
+    return count;
+}
+
+size_t stepLockstep(LockstepCpu* ls) {
+    // Always run the lanes that are furthest behind. Lanes that took a forward branch wait at
+    // their target until the rest arrives there, which is where structured code reconverges.
+    uint32_t pc = UINT32_MAX;
+    LANE_LOOP {
+        uint32_t lane_pc = ls->active[i] ? ls->program_counter[i] : UINT32_MAX;
+        pc = lane_pc < pc ? lane_pc : pc;
+    }
+    if (pc == UINT32_MAX) {
+        return 0;
+    }
+
+    size_t leader = 0;
+    while (!ls->active[leader] || ls->program_counter[leader] != pc) {
+        ++leader;
+    }
+    const uint8_t opcode = ls->lanes[leader].memory[pc];
+
+    LaneGroup g = {0};
+    size_t count = 0;
+    LANE_LOOP {
+        bool in_group = ls->active[i] && ls->program_counter[i] == pc &&
+                        ls->lanes[i].memory[pc] == opcode;
+        g.sel[i] = in_group ? 0xFF : 0;
+        count += in_group;
+    }
+
+    if (opcode == OP_HALT) {
+        LANE_LOOP {
+            ls->active[i] &= ~g.sel[i];
+        }
+        return count;
+    }
+
+    const LaneInstruction instruction = LANE_TABLE[opcode];
+    if (instruction != NULL) {
+        LANE_LOOP {
+            if (g.sel[i]) {
+                const uint8_t* memory = ls->lanes[i].memory;
+                g.imm[i] = memory[(uint16_t)(pc + 1)];
+                g.addr[i] = ((uint16_t)memory[(uint16_t)(pc + 1)] << 8) |
+                            (uint16_t)memory[(uint16_t)(pc + 2)];
+            }
+        }
+        instruction(ls, &g);
+    } else {
+        LANE_LOOP {
+            if (g.sel[i]) {
+                CPU* cpu = gatherLane(ls, i);
+                OP_TABLE[opcode](cpu);
+                scatterLane(ls, i);
+            }
+        }
+    }
+
+    // same as `runCpu`, a lane stops once the next instruction is a HALT
+    LANE_LOOP {
+        if (g.sel[i] && ls->lanes[i].memory[ls->program_counter[i]] == OP_HALT) {
+            ls->active[i] = 0;
+        }
+    }
+
+    return count;
+}
+
+size_t runLockstep(LockstepCpu* ls, size_t max_steps) {
+    size_t steps = 0;
+
+    while ((max_steps == 0 || steps < max_steps) && stepLockstep(ls) > 0) {
+        ++steps;
+    }
+
+    return steps;
+}
@@ -1,41 +1,445 @@
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "headers/assembler.h"
+#include "headers/breakpoints.h"
+#include "headers/callgraph.h"
 #include "headers/cpu.h"
 #include "headers/debug.h"
+#include "headers/disassembler.h"
+#include "headers/errors.h"
+#include "headers/gdb_stub.h"
+#include "headers/hot_reload.h"
+#include "headers/profiler.h"
+#include "headers/sampler.h"
 #include "headers/screen.h"
+#include "headers/trace.h"
 #include "headers/util.h"
+#include "headers/watchpoints.h"
 
-#define USAGE "USAGE: build/vm <filename>.casm\n"
+// where the last instructions go when the VM crashes, unless --trace-last says otherwise
+#define CRASH_TRACE_PATH "vm-crash.trace"
+
+#define USAGE                                                                              \
+    "USAGE: build/vm [options] <filename>.casm\n"                                          \
+    "\n"                                                                                   \
+    "OPTIONS:\n"                                                                           \
+    "    --profile             print execution counts at exit\n"                           \
+    "    --flamegraph <file>   write folded call stacks for flamegraph.pl to <file>\n"     \
+    "    --sample <hz>         sample the program counter <hz> times per second\n"         \
+    "    --debug-info <file>   write line and symbol tables to <file>\n"                   \
+    "    --break <label|addr>  pause before the instruction at <label|addr>, repeatable\n" \
+    "    --watch <lo[:hi]>     print every write to the addresses or labels, repeatable\n" \
+    "    --rwatch <lo[:hi]>    same as --watch for reads\n"                                \
+    "    --trace <file>        stream a binary trace of every instruction to <file>\n"     \
+    "    --trace-last <file>   write the last instructions to <file> when the VM exits\n"  \
+    "    --no-trace            don't keep the last instructions for a crash dump\n"       \
+    "    --gdb <address>       serve GDB remotes on unix:<path> or <host>:<port>\n"        \
+    "    --hot-reload          patch the running program whenever the source is saved\n"   \
+    "    --disassemble         print the reachable code and exit without running it\n"
+
+typedef struct Options {
+    const char* filename;
+    bool profile;
+    const char* flamegraph;
+    unsigned sample_hz;
+    const char* debug_info;
+    // const char*, labels or addresses passed to --break
+    vec_t breaks;
+    // WatchOption
+    vec_t watches;
+    const char* trace;
+    const char* trace_last;
+    bool no_trace;
+    const char* gdb;
+    bool hot_reload;
+    bool disassemble;
+} Options;
+
+typedef struct WatchOption {
+    const char* range;
+    WatchKind kind;
+} WatchOption;
+
+typedef struct ProfiledRun {
+    CPU* cpu;
+    Profile* profile;
+    CallGraph* graph;
+    Watchpoints* watch;
+    Trace* trace;
+    GdbStub* gdb;
+    HotReload* reload;
+} ProfiledRun;
+
+static Profile profile;
+static Watchpoints watchpoints;
+static Trace trace;
+
+static bool parseArgs(int argc, char** argv, Options* options) {
+    *options = (Options){.filename = NULL,
+                         .profile = false,
+                         .flamegraph = NULL,
+                         .sample_hz = 0,
+                         .debug_info = NULL,
+                         .breaks = new_vec(4, sizeof(const char*)),
+                         .watches = new_vec(4, sizeof(WatchOption)),
+                         .trace = NULL,
+                         .trace_last = NULL,
+                         .no_trace = false,
+                         .gdb = NULL,
+                         .hot_reload = false,
+                         .disassemble = false};
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            options->profile = true;
+        } else if (strcmp(argv[i], "--flamegraph") == 0) {
+            if (++i == argc) {
+                printf("--flamegraph expects a file to write to\n");
+                return false;
+            }
+            options->flamegraph = argv[i];
+        } else if (strcmp(argv[i], "--debug-info") == 0) {
+            if (++i == argc) {
+                printf("--debug-info expects a file to write to\n");
+                return false;
+            }
+            options->debug_info = argv[i];
+        } else if (strcmp(argv[i], "--break") == 0) {
+            if (++i == argc) {
+                printf("--break expects a label or address\n");
+                return false;
+            }
+            push_vec(&options->breaks, &argv[i]);
+        } else if (strcmp(argv[i], "--watch") == 0 || strcmp(argv[i], "--rwatch") == 0) {
+            const WatchKind kind = argv[i][2] == 'w' ? WATCH_WRITE : WATCH_READ;
+            if (++i == argc) {
+                printf("%s expects an address range\n", argv[i - 1]);
+                return false;
+            }
+            WatchOption watch = (WatchOption){.range = argv[i], .kind = kind};
+            push_vec(&options->watches, &watch);
+        } else if (strcmp(argv[i], "--trace") == 0 || strcmp(argv[i], "--trace-last") == 0) {
+            if (++i == argc) {
+                printf("%s expects a file to write to\n", argv[i - 1]);
+                return false;
+            }
+            if (strcmp(argv[i - 1], "--trace") == 0) {
+                options->trace = argv[i];
+            } else {
+                options->trace_last = argv[i];
+            }
+        } else if (strcmp(argv[i], "--gdb") == 0) {
+            if (++i == argc) {
+                printf("--gdb expects unix:<path> or <host>:<port>\n");
+                return false;
+            }
+            options->gdb = argv[i];
+        } else if (strcmp(argv[i], "--no-trace") == 0) {
+            options->no_trace = true;
+        } else if (strcmp(argv[i], "--hot-reload") == 0) {
+            options->hot_reload = true;
+        } else if (strcmp(argv[i], "--disassemble") == 0) {
+            options->disassemble = true;
+        } else if (strcmp(argv[i], "--sample") == 0) {
+            if (++i == argc || (options->sample_hz = (unsigned)strtoul(argv[i], NULL, 10)) == 0) {
+                printf("--sample expects a sampling frequency in Hz\n");
+                return false;
+            }
+        } else if (argv[i][0] == '-') {
+            printf("unknown option '%s'\n", argv[i]);
+            return false;
+        } else if (options->filename != NULL) {
+            printf("compiling multiple assembly files is currently unsupported\n");
+            return false;
+        } else {
+            options->filename = argv[i];
+        }
+    }
+
+    // each of these runs the VM through its own loop
+    const int runners = (options->profile || options->flamegraph != NULL) +
+                        (len_vec(&options->watches) > 0) +
+                        (options->trace != NULL || options->trace_last != NULL) +
+                        (options->gdb != NULL || len_vec(&options->breaks) > 0) +
+                        options->hot_reload;
+    if (runners > 1) {
+        printf("--profile and --flamegraph, --watch, --trace, --gdb or --break and --hot-reload "
+               "can't be combined\n");
+        return false;
+    }
+    if (options->no_trace && (options->trace != NULL || options->trace_last != NULL)) {
+        printf("--no-trace can't be combined with --trace or --trace-last\n");
+        return false;
+    }
+
+    return options->filename != NULL;
+}
+
+// Resolves `target` as a label first and falls back to a number in any base strtoul understands
+static bool resolveAddress(const Executable* exec, const char* target, uint16_t* addr) {
+    const size_t* label = get_map(&exec->labels, from_cstr_slice(target, strlen(target)));
+    if (label != NULL) {
+        *addr = (uint16_t)*label;
+        return true;
+    }
+
+    char* end;
+    unsigned long value = strtoul(target, &end, 0);
+    if (*target == '\0' || *end != '\0' || value >= MEMORY_SIZE) {
+        return false;
+    }
+
+    *addr = (uint16_t)value;
+    return true;
+}
+
+// Parses `lo:hi` or a single `lo`, where both ends are labels or addresses
+static bool resolveRange(const Executable* exec, const char* range, uint16_t* lo, uint16_t* hi) {
+    const char* colon = strchr(range, ':');
+    if (colon == NULL) {
+        return resolveAddress(exec, range, lo) && resolveAddress(exec, range, hi);
+    }
+
+    char low[64];
+    size_t len = (size_t)(colon - range);
+    if (len >= sizeof(low)) {
+        return false;
+    }
+    memcpy(low, range, len);
+    low[len] = '\0';
+
+    return resolveAddress(exec, low, lo) && resolveAddress(exec, colon + 1, hi) && *lo <= *hi;
+}
+
+static int runProfiledSdl(void* data) {
+    ProfiledRun* run = (ProfiledRun*)data;
+
+    if (run->watch != NULL) {
+        return runCpuWatched(run->cpu, run->watch);
+    }
+    if (run->trace != NULL) {
+        return runCpuTraced(run->cpu, run->trace);
+    }
+    if (run->gdb != NULL) {
+        return runCpuGdb(run->cpu, run->gdb);
+    }
+    if (run->reload != NULL) {
+        return runCpuHotReload(run->cpu, run->reload);
+    }
+    if (run->graph != NULL) {
+        return runCpuCallGraph(run->cpu, run->graph, run->profile);
+    }
+    return runCpuProfiled(run->cpu, run->profile);
+}
 
 int main(int argc, char** argv) {
-    if (argc <= 1) {
+    Options options;
+
+    if (!parseArgs(argc, argv, &options)) {
         printf(USAGE);
-    } else if (argc == 2) {
-        CPU cpu;
-        initCpu(&cpu);
+        return 0;
+    }
 
-        const char* filename = argv[1];
-        const string_t programStr = read_file_to_str(filename);
-        const Executable exec =
-            assemble(from_str_slice(programStr), from_cstr_slice(filename, strlen(filename)));
+    const char* filename = options.filename;
+    MappedFile source;
+    if (!map_file(filename, &source)) {
+        printf("couldn't open '%s'\n", filename);
+        free_vec(&options.breaks, NULL);
+        free_vec(&options.watches, NULL);
+        return 1;
+    }
 
-        printf("created executable with size %lu\n", exec.size - PROGRAM_START);
+    CPU cpu;
+    initCpu(&cpu);
 
-        loadProgram(&cpu, exec.executable, exec.size);
-        initScreen(&cpu);
+    const slice_t path = from_cstr_slice(filename, strlen(filename));
+    Executable exec = assemble(source.content, path);
+    printDiagnostics(&exec.diagnostics, source.content, path);
 
-        printCpu(&cpu);
-        printStack(&cpu, 10);
+    printf("created executable with size %lu\n", exec.size - PROGRAM_START);
 
-        free(exec.executable);
-        free_str((string_t*)&programStr);
+    loadProgram(&cpu, exec.executable, exec.size);
+
+    if (options.disassemble) {
+        disassemble(exec);
+
+        free_vec(&options.breaks, NULL);
+        free_vec(&options.watches, NULL);
+        freeExecutable(&exec);
+        unmap_file(&source);
         freeCpu(&cpu);
+
+        return 0;
+    }
+
+    GdbStub gdb;
+    bool gdb_open = false;
+    if (options.gdb != NULL) {
+        gdb_open = openGdbStub(&gdb, options.gdb, false);
+        if (gdb_open) {
+            printf("gdb stub listening on %s\n", options.gdb);
+        } else {
+            printf("couldn't listen on '%s'\n", options.gdb);
+        }
+    }
+
+    // with --gdb the breakpoints go into the stub's table, so they stop the VM for the client
+    Breakpoints breakpoints;
+    const bool own_breakpoints = len_vec(&options.breaks) > 0 && !gdb_open;
+    if (len_vec(&options.breaks) > 0) {
+        if (gdb_open) {
+            cpu.breakpoints = &gdb.breakpoints;
+        } else {
+            initBreakpoints(&breakpoints, pauseOnBreakpoint, NULL);
+            cpu.breakpoints = &breakpoints;
+        }
+
+        for (size_t i = 0; i < len_vec(&options.breaks); ++i) {
+            const char* target = CAST(get_vec(&options.breaks, i), const char*);
+            uint16_t addr;
+
+            if (!resolveAddress(&exec, target, &addr)) {
+                printf("can't set a breakpoint at '%s', no such label or address\n", target);
+            } else if (!setBreakpoint(&cpu, addr)) {
+                printf("there already is a breakpoint at %u\n", addr);
+            }
+        }
+    }
+
+    if (options.debug_info != NULL && !writeDebugInfo(&exec.debug_info, options.debug_info)) {
+        printf("couldn't write debug info to '%s'\n", options.debug_info);
+    }
+
+    CallGraph graph;
+    ProfiledRun run = (ProfiledRun){.cpu = &cpu,
+                                    .profile = NULL,
+                                    .graph = NULL,
+                                    .watch = NULL,
+                                    .trace = NULL,
+                                    .gdb = NULL,
+                                    .reload = NULL};
+
+    if (len_vec(&options.watches) > 0) {
+        initWatchpoints(&watchpoints, printWatchHit, &exec.debug_info);
+        run.watch = &watchpoints;
+
+        for (size_t i = 0; i < len_vec(&options.watches); ++i) {
+            const WatchOption* watch = get_vec(&options.watches, i);
+            uint16_t lo, hi;
+
+            if (resolveRange(&exec, watch->range, &lo, &hi)) {
+                watchRange(&watchpoints, lo, hi, watch->kind);
+            } else {
+                printf("can't watch '%s', expected <lo[:hi]> with labels or addresses\n",
+                       watch->range);
+            }
+        }
+    }
+
+    if (options.profile) {
+        initProfile(&profile);
+        run.profile = &profile;
+    }
+    if (options.flamegraph != NULL) {
+        initCallGraph(&graph, PROGRAM_START);
+        run.graph = &graph;
+    }
+
+    if (gdb_open) {
+        run.gdb = &gdb;
+    }
+
+    HotReload reload;
+    if (options.hot_reload) {
+        if (openHotReload(&reload, filename)) {
+            printf("reloading '%s' whenever it's saved\n", filename);
+            run.reload = &reload;
+        } else {
+            printf("couldn't watch '%s' for changes\n", filename);
+        }
+    }
+
+    // the default loop keeps the last instructions too, so a crash or ^C leaves them behind
+    const bool other_runner = run.profile != NULL || run.graph != NULL || run.watch != NULL ||
+                              run.gdb != NULL || run.reload != NULL;
+    if (!other_runner && !options.no_trace) {
+        initTrace(&trace, 0);
+        run.trace = &trace;
+
+        const char* dump = options.trace_last != NULL ? options.trace_last : CRASH_TRACE_PATH;
+        if (!dumpTraceOnSignal(&trace, dump)) {
+            printf("couldn't set up writing the trace to '%s' on a crash\n", dump);
+        }
+        if (options.trace != NULL && !startTraceWriter(&trace, options.trace)) {
+            printf("couldn't stream the trace to '%s'\n", options.trace);
+        }
+    }
+
+    if (options.sample_hz != 0 && !startSampler(&cpu, run.graph, options.sample_hz)) {
+        printf("couldn't start the sampling timer\n");
+        options.sample_hz = 0;
+    }
+
+    if (run.profile != NULL || run.graph != NULL || run.watch != NULL || run.trace != NULL ||
+        run.gdb != NULL || run.reload != NULL) {
+        initScreenWith(&cpu, runProfiledSdl, &run);
     } else {
-        printf("compiling multiple assembly files is currently unsupported\n");
-        printf(USAGE);
+        initScreen(&cpu);
+    }
+
+    if (options.sample_hz != 0) {
+        stopSampler();
+    }
+
+    printCpu(&cpu);
+    printStack(&cpu, 10);
+
+    if (run.trace != NULL) {
+        stopDumpOnSignal();
+        if (options.trace != NULL) {
+            printf("trace dropped %lu instructions\n", (unsigned long)stopTraceWriter(&trace));
+        }
+        if (options.trace_last != NULL && !dumpTrace(&trace, options.trace_last)) {
+            printf("couldn't write the trace to '%s'\n", options.trace_last);
+        }
+        freeTrace(&trace);
+    }
+
+    if (options.profile) {
+        printProfile(&profile, &exec.debug_info, source.content);
+    }
+    if (options.sample_hz != 0) {
+        printSamples(&exec.debug_info, source.content, run.graph);
+    }
+    if (options.flamegraph != NULL) {
+        printCallGraph(&graph, &exec.debug_info);
+
+        FILE* out = fopen(options.flamegraph, "w");
+        if (out != NULL) {
+            writeFoldedStacks(&graph, &exec.debug_info, out);
+            fclose(out);
+        } else {
+            printf("couldn't open '%s' for writing\n", options.flamegraph);
+        }
+        freeCallGraph(&graph);
+    }
+
+    if (own_breakpoints) {
+        freeBreakpoints(&breakpoints);
+    }
+    if (run.gdb != NULL) {
+        closeGdbStub(&gdb);
+    }
+    if (run.reload != NULL) {
+        closeHotReload(&reload);
     }
+    free_vec(&options.breaks, NULL);
+    free_vec(&options.watches, NULL);
+    freeExecutable(&exec);
+    unmap_file(&source);
+    freeCpu(&cpu);
 
     return 0;
 }
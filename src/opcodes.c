@@ -0,0 +1,16 @@
+#include "headers/opcodes.h"
+
+#include <stddef.h>
+
+// clang-format off
+
+#define OPCODE_INFO_ENTRY(code, name, mode, operands, length, cycles, flow) \
+    [code] = {#name, mode, operands, length, cycles, flow},
+#define OPCODE_INFO_UNUSED(code) \
+    [code] = {NULL, MODE_IMPLIED, OPERANDS_NONE, 1, 1, FLOW_NEXT},
+
+const OpcodeInfo OPCODE_INFO[256] = {
+    OPCODES(OPCODE_INFO_ENTRY, OPCODE_INFO_UNUSED)
+};
+
+// clang-format on
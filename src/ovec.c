@@ -6,9 +6,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "headers/arena.h"
 #include "headers/util.h"
 
 static void __grow_vec(vec_t* vec);
+static void __realloc_vec(vec_t* vec, size_t capacity);
 
 inline vec_t new_vec(size_t item_capacity, size_t elem_size) {
     vec_t res = (vec_t){
@@ -16,11 +18,24 @@ inline vec_t new_vec(size_t item_capacity, size_t elem_size) {
         .elem_size = elem_size,
         .len = 0,
         .ptr = calloc(item_capacity, elem_size),
+        .arena = NULL,
     };
 
     return res;
 }
 
+vec_t new_vec_in(Arena* arena, size_t item_capacity, size_t elem_size) {
+    assert(arena != NULL);
+
+    return (vec_t){
+        .capacity = item_capacity,
+        .elem_size = elem_size,
+        .len = 0,
+        .ptr = arenaAlloc(arena, item_capacity * elem_size),
+        .arena = arena,
+    };
+}
+
 void free_vec(vec_t* vec, void elem_destructor(void*)) {
     if (vec != NULL) {
         if (elem_destructor != NULL) {
@@ -29,7 +44,9 @@ void free_vec(vec_t* vec, void elem_destructor(void*)) {
             }
         }
 
-        free(vec->ptr);
+        if (vec->arena == NULL) {
+            free(vec->ptr);
+        }
     }
 }
 
@@ -184,11 +201,8 @@ void resize_vec(vec_t* vec, size_t len) {
         return;
     }
 
-    size_t new_size = len * vec->elem_size;
-
-    vec->ptr = realloc(vec->ptr, new_size);
+    __realloc_vec(vec, len);
     vec->len = min(vec->len, len);
-    vec->capacity = len;
 }
 
 void reserve_vec(vec_t* vec, size_t elements) {
@@ -233,11 +247,18 @@ void debug_vec(const vec_t* vec) {
 
 static inline void __grow_vec(vec_t* vec) {
     if (vec->len >= vec->capacity) {
-        size_t new_capacity = (vec->capacity + 1) * 2;
+        __realloc_vec(vec, (vec->capacity + 1) * 2);
+    }
+}
 
-        vec->ptr = realloc(vec->ptr, new_capacity * vec->elem_size);
-        vec->capacity = new_capacity;
+static void __realloc_vec(vec_t* vec, size_t capacity) {
+    if (vec->arena != NULL) {
+        vec->ptr = arenaGrow(vec->arena, vec->ptr, vec->capacity * vec->elem_size,
+                             capacity * vec->elem_size);
+    } else {
+        vec->ptr = realloc(vec->ptr, capacity * vec->elem_size);
     }
+    vec->capacity = capacity;
 }
 
 inline vec_iter_t iter_from_vec(const vec_t* vec) {
@@ -2,7 +2,7 @@
 #include "stdio.h"
 #include "stdlib.h"
 
-size_t parse_immediate(Token* token) {
+size_t parse_immediate(const Token* token) {
     switch (token->tok) {
         case BINARY_T:
             return strtol(&token->substr.str[2], NULL, 2);
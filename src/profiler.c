@@ -0,0 +1,125 @@
+#include "headers/profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "headers/debug.h"
+#include "headers/instructions.h"
+#include "headers/util.h"
+
+typedef struct ProfileEntry {
+    size_t key;
+    uint64_t count;
+} ProfileEntry;
+
+void initProfile(Profile* profile) { memset(profile, 0, sizeof(Profile)); }
+
+int runCpuProfiled(CPU* cpu, Profile* profile) {
+    uint8_t op = MEMORY(PC);
+
+    do {
+        profile->opcodes[op]++;
+        profile->addresses[PC]++;
+        OP_TABLE[op](cpu);
+        op = MEMORY(PC);
+    } while (op != OP_HALT);
+
+    profile->instructions = 0;
+    for (size_t i = 0; i < 256; ++i) {
+        profile->instructions += profile->opcodes[i];
+    }
+
+    return 0;
+}
+
+static int cmpEntry(const void* lhs, const void* rhs) {
+    const ProfileEntry* a = lhs;
+    const ProfileEntry* b = rhs;
+
+    if (a->count != b->count) return a->count < b->count ? 1 : -1;
+    return a->key < b->key ? -1 : a->key > b->key;
+}
+
+// Collects the non-zero counters, hottest first
+static vec_t sortedEntries(const uint64_t* counts, size_t len) {
+    vec_t entries = new_vec(16, sizeof(ProfileEntry));
+
+    for (size_t i = 0; i < len; ++i) {
+        if (counts[i] != 0) {
+            ProfileEntry entry = (ProfileEntry){.key = i, .count = counts[i]};
+            push_vec(&entries, &entry);
+        }
+    }
+
+    qsort(entries.ptr, entries.len, sizeof(ProfileEntry), cmpEntry);
+
+    return entries;
+}
+
+static double percentage(uint64_t count, uint64_t total) {
+    return total == 0 ? 0.0 : 100.0 * (double)count / (double)total;
+}
+
+static void printLine(slice_t source, size_t line_nr) {
+    if (line_nr == 0) return;
+
+    slice_t line = sourceLine(source, line_nr);
+    printf("%4lu | %.*s", line_nr, (int)line.len, line.str);
+}
+
+void printProfile(const Profile* profile, const DebugInfo* info, slice_t source) {
+    printf("\nexecuted %lu instructions\n", (unsigned long)profile->instructions);
+    printHotspots(profile, info, source);
+}
+
+void printHotspots(const Profile* profile, const DebugInfo* info, slice_t source) {
+    const uint64_t total = profile->instructions;
+
+    printf("\n      count       %%  opcode\n");
+    vec_t opcodes = sortedEntries(profile->opcodes, 256);
+    for (size_t i = 0; i < min(opcodes.len, PROFILE_TOP); ++i) {
+        ProfileEntry* e = get_vec(&opcodes, i);
+        printf("%11lu  %5.1f%%  ", (unsigned long)e->count, percentage(e->count, total));
+        printOpcode((Opcode)e->key);
+        printf("\n");
+    }
+
+    printf("\n      count       %%  address  symbol\n");
+    vec_t addresses = sortedEntries(profile->addresses, MEMORY_SIZE);
+    for (size_t i = 0; i < min(addresses.len, PROFILE_TOP); ++i) {
+        ProfileEntry* e = get_vec(&addresses, i);
+        printf("%11lu  %5.1f%%  0x%04lx   ", (unsigned long)e->count, percentage(e->count, total),
+               e->key);
+        fprintSymbolized(stdout, &info->symbols, (uint16_t)e->key);
+        printf("\n");
+    }
+
+    // add up the addresses that were assembled from the same line
+    size_t line_count = 1;
+    for (size_t i = 0; i < info->lines.len; ++i) {
+        line_count = max(line_count, ((LineEntry*)get_vec(&info->lines, i))->line + 1);
+    }
+    uint64_t* line_counts = calloc(line_count, sizeof(uint64_t));
+    for (size_t i = 0; i < addresses.len; ++i) {
+        ProfileEntry* e = get_vec(&addresses, i);
+        const LineEntry* line = findLine(info, (uint16_t)e->key);
+        if (line != NULL) line_counts[line->line] += e->count;
+    }
+    // the HALT at the end and everything past the program doesn't belong to any line
+    line_counts[0] = 0;
+
+    printf("\n      count       %%  line\n");
+    vec_t lines = sortedEntries(line_counts, line_count);
+    for (size_t i = 0; i < min(lines.len, PROFILE_TOP); ++i) {
+        ProfileEntry* e = get_vec(&lines, i);
+        printf("%11lu  %5.1f%%  ", (unsigned long)e->count, percentage(e->count, total));
+        printLine(source, e->key);
+        printf("\n");
+    }
+
+    free(line_counts);
+    free_vec(&opcodes, NULL);
+    free_vec(&addresses, NULL);
+    free_vec(&lines, NULL);
+}
@@ -0,0 +1,148 @@
+#include "headers/sampler.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "headers/profiler.h"
+#include "headers/util.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#define NO_SAMPLE_NODE UINT32_MAX
+
+static Sample sample_buf[SAMPLE_CAPACITY];
+static atomic_size_t sample_count;
+static const volatile CPU* _Atomic sampled_cpu;
+static const volatile CallGraph* _Atomic sampled_graph;
+static unsigned sample_hz;
+
+#ifndef _WIN32
+// Only touches memory that stays put while the VM runs and a lock free counter, which keeps it
+// async signal safe
+static void onSample(int sig) {
+    (void)sig;
+
+    const volatile CPU* cpu = atomic_load_explicit(&sampled_cpu, memory_order_relaxed);
+    const volatile CallGraph* graph = atomic_load_explicit(&sampled_graph, memory_order_relaxed);
+    if (cpu == NULL) return;
+
+    size_t idx = atomic_fetch_add_explicit(&sample_count, 1, memory_order_relaxed);
+    if (idx >= SAMPLE_CAPACITY) return;
+
+    const uint16_t pc = cpu->program_counter;
+    sample_buf[idx] = (Sample){
+        .pc = pc,
+        .opcode = cpu->memory[pc],
+        .node = graph == NULL ? NO_SAMPLE_NODE : (uint32_t)graph->stack[graph->depth - 1],
+    };
+}
+
+static bool setTimer(unsigned hz) {
+    struct itimerval timer = {0};
+
+    if (hz != 0) {
+        // tv_usec has to stay below a second, 1 Hz is a whole second and no microseconds
+        timer.it_interval.tv_sec = (time_t)(1 / hz);
+        timer.it_interval.tv_usec = (suseconds_t)((1000000 / hz) % 1000000);
+        timer.it_value = timer.it_interval;
+    }
+
+    return setitimer(ITIMER_PROF, &timer, NULL) == 0;
+}
+
+bool startSampler(const CPU* cpu, const CallGraph* graph, unsigned hz) {
+    if (hz == 0 || hz > 1000000) return false;
+
+    atomic_store(&sample_count, 0);
+    atomic_store(&sampled_graph, graph);
+    atomic_store(&sampled_cpu, cpu);
+    sample_hz = hz;
+
+    struct sigaction action = {0};
+    action.sa_handler = onSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGPROF, &action, NULL) != 0) return false;
+
+    return setTimer(hz);
+}
+
+void stopSampler(void) {
+    setTimer(0);
+    atomic_store(&sampled_cpu, NULL);
+    atomic_store(&sampled_graph, NULL);
+}
+#else
+bool startSampler(const CPU* cpu, const CallGraph* graph, unsigned hz) {
+    (void)cpu;
+    (void)graph;
+    (void)hz;
+    return false;
+}
+
+void stopSampler(void) {}
+#endif
+
+size_t samplesTaken(void) { return atomic_load(&sample_count); }
+
+const Sample* samples(void) { return sample_buf; }
+
+static int cmpCount(const void* lhs, const void* rhs) {
+    const uint64_t* a = lhs;
+    const uint64_t* b = rhs;
+
+    if (a[1] != b[1]) return a[1] < b[1] ? 1 : -1;
+    return a[0] < b[0] ? -1 : a[0] > b[0];
+}
+
+static void printSampledStacks(const DebugInfo* info, const CallGraph* graph, size_t count) {
+    const size_t node_count = graph->nodes.len;
+    // pairs of node index and sample count
+    uint64_t* stacks = calloc(node_count * 2, sizeof(uint64_t));
+
+    for (size_t i = 0; i < node_count; ++i) {
+        stacks[i * 2] = i;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (sample_buf[i].node < node_count) stacks[sample_buf[i].node * 2 + 1]++;
+    }
+
+    qsort(stacks, node_count, 2 * sizeof(uint64_t), cmpCount);
+
+    printf("\n    samples  call stack\n");
+    for (size_t i = 0; i < min(node_count, PROFILE_TOP) && stacks[i * 2 + 1] != 0; ++i) {
+        printf("%11lu  ", (unsigned long)stacks[i * 2 + 1]);
+        fprintCallStack(stdout, graph, &info->symbols, stacks[i * 2]);
+        printf("\n");
+    }
+
+    free(stacks);
+}
+
+void printSamples(const DebugInfo* info, slice_t source, const CallGraph* graph) {
+    const size_t taken = samplesTaken();
+    const size_t count = min(taken, SAMPLE_CAPACITY);
+
+    printf("\ncollected %lu samples at %u Hz", (unsigned long)count, sample_hz);
+    if (taken > count) printf(", dropped %lu", (unsigned long)(taken - count));
+    printf("\n");
+
+    Profile* profile = calloc(1, sizeof(Profile));
+    if (profile == NULL) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        profile->opcodes[sample_buf[i].opcode]++;
+        profile->addresses[sample_buf[i].pc]++;
+    }
+    profile->instructions = count;
+
+    printHotspots(profile, info, source);
+    if (graph != NULL) printSampledStacks(info, graph, count);
+
+    free(profile);
+}
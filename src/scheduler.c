@@ -0,0 +1,86 @@
+#include "headers/scheduler.h"
+
+#include "headers/instructions.h"
+
+void initScheduler(Scheduler* s, size_t slice) {
+    s->slice = slice == 0 ? DEFAULT_SLICE : slice;
+    s->vms = new_vec(16, sizeof(ScheduledVm));
+    s->ready = new_vec(16, sizeof(size_t));
+    s->next = new_vec(16, sizeof(size_t));
+}
+
+void freeScheduler(Scheduler* s) {
+    free_vec(&s->vms, NULL);
+    free_vec(&s->ready, NULL);
+    free_vec(&s->next, NULL);
+}
+
+size_t addVm(Scheduler* s, CPU* cpu) {
+    size_t id = len_vec(&s->vms);
+    ScheduledVm vm = {.cpu = cpu, .state = VM_READY};
+
+    push_vec(&s->vms, &vm);
+    push_vec(&s->ready, &id);
+
+    return id;
+}
+
+VmState vmState(const Scheduler* s, size_t id) {
+    return ((ScheduledVm*)get_vec(&s->vms, id))->state;
+}
+
+bool postInput(Scheduler* s, size_t id, char input) {
+    ScheduledVm* vm = get_vec(&s->vms, id);
+
+    if (!writeInput(vm->cpu, input)) return false;
+
+    if (vm->state == VM_PARKED) {
+        vm->state = VM_READY;
+        push_vec(&s->ready, &id);
+    }
+
+    return true;
+}
+
+static VmState runSlice(CPU* cpu, size_t slice) {
+    uint8_t op = MEMORY(PC);
+
+    for (size_t i = 0; i < slice && op != OP_HALT; ++i) {
+        if (op == OP_WAIT && INPUT_EMPTY()) return VM_PARKED;
+        op = stepCpu(cpu);
+    }
+
+    if (op == OP_HALT) return VM_HALTED;
+    if (op == OP_WAIT && INPUT_EMPTY()) return VM_PARKED;
+
+    return VM_READY;
+}
+
+size_t runRound(Scheduler* s) {
+    for (size_t i = 0; i < len_vec(&s->ready); ++i) {
+        size_t id = CAST(get_vec(&s->ready, i), size_t);
+        ScheduledVm* vm = get_vec(&s->vms, id);
+
+        vm->state = runSlice(vm->cpu, s->slice);
+
+        if (vm->state == VM_READY) push_vec(&s->next, &id);
+    }
+
+    vec_t done = s->ready;
+    s->ready = s->next;
+    s->next = done;
+    clear_vec(&s->next);
+
+    return len_vec(&s->ready);
+}
+
+size_t runScheduler(Scheduler* s) {
+    size_t rounds = 0;
+
+    while (len_vec(&s->ready) > 0) {
+        runRound(s);
+        rounds++;
+    }
+
+    return rounds;
+}
@@ -12,11 +12,6 @@
 #include "SDL3/SDL_thread.h"
 #include "headers/instructions.h"
 
-#define WRITE_IDX 0x9fed
-#define READ_IDX 0x9fee
-#define RINGBUF 0x9fef
-#define BUF_SIZE 0x0010
-
 static SDL_Window* window = NULL;
 static SDL_Renderer* renderer = NULL;
 static SDL_Texture* texture = NULL;
@@ -182,18 +177,6 @@ static char convert_input(SDL_Event* e) {
     }
 }
 
-static void write_input(CPU* cpu, char input) {
-    // work directly in the CPU's memory to create and manage the ringbuffer that
-    // the keyboard will use. The CPU's interrupts will also use this ringbuffer
-    // internally to process keyboard input.
-    if ((MEMORY(WRITE_IDX) + 1) % BUF_SIZE == MEMORY(READ_IDX)) {
-        printf("buffer full?");
-        return;
-    }
-    MEMORY(RINGBUF + MEMORY(WRITE_IDX)) = input;
-    MEMORY(WRITE_IDX) = (MEMORY(WRITE_IDX) + 1) % BUF_SIZE;
-}
-
 static int render_thread(void* cpuData) {
     CPU* cpu = (CPU*)cpuData;
 
@@ -220,7 +203,7 @@ static int render_thread(void* cpuData) {
                     quit = true;
                     memset(cpu->memory, OP_HALT, MEMORY_SIZE);
                 } else if (input) {
-                    write_input(cpu, input);
+                    if (!writeInput(cpu, input)) printf("buffer full?");
                 }
             } else if (e.type == SDL_EVENT_QUIT) {
                 quit = true;
@@ -244,10 +227,12 @@ int runCpuSdl(void* cpuData) {
     return runCpu(cpu);
 }
 
-void initScreen(CPU* cpu) {
-    SDL_Thread* screen_thread_handle = SDL_CreateThread(runCpuSdl, "SDL VM CPU Thread", cpu);
+void initScreenWith(CPU* cpu, SDL_ThreadFunction run, void* data) {
+    SDL_Thread* screen_thread_handle = SDL_CreateThread(run, "SDL VM CPU Thread", data);
 
     SDL_DetachThread(screen_thread_handle);
 
     render_thread(cpu);
 }
+
+void initScreen(CPU* cpu) { initScreenWith(cpu, runCpuSdl, cpu); }
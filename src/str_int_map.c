@@ -2,10 +2,11 @@
 
 #include <assert.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "headers/arena.h"
+
 // FNV 1A 64-bit algorithm from wikipedia:
 // https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
 // Adapted for use on null-terminated strings
@@ -28,203 +29,202 @@ inline int cmp_str(slice_t lhs, slice_t rhs) {
     return strncmp(lhs.str, rhs.str, lhs.len);
 }
 
-inline si_map_t new_map() {
-    return (si_map_t){
-        .capacity = DEFAULT_MAP_CAPACITY,
-        .len = 0,
-        .buckets = (si_bucket_t*)calloc(DEFAULT_MAP_CAPACITY, sizeof(si_bucket_t)),
-    };
+// 0 marks empty slots
+static inline uint32_t slot_hash(slice_t key) {
+    const uint32_t h = (uint32_t)hash_str(key);
+    return h != 0 ? h : 1;
 }
 
-static inline si_map_t new_map_with_capacity(size_t capacity) {
-    return (si_map_t){
-        .capacity = capacity,
-        .len = 0,
-        .buckets = (si_bucket_t*)calloc(capacity, sizeof(si_bucket_t)),
-    };
+static inline slice_t slot_key(const si_slot_t* slot) {
+    return (slice_t){.str = slot->str, .len = slot->len};
+}
+
+static inline uint64_t load_word(const char* p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
 }
 
-static size_t* get_bucket(const si_bucket_t* bucket, slice_t key) {
-    if (bucket == NULL) {
-        return NULL;
+// Compares eight bytes at a time, labels are short enough that this beats calling memcmp
+static inline bool keys_eq(slice_t lhs, slice_t rhs) {
+    if (lhs.len != rhs.len) {
+        return false;
     }
 
-    do {
-        if (bucket->key.str == NULL) {
-            printf("key is null while trying to get something\n");
-            return NULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= lhs.len; i += sizeof(uint64_t)) {
+        if (load_word(lhs.str + i) != load_word(rhs.str + i)) {
+            return false;
         }
-        if (cmp_str(bucket->key, key) == 0) {
-            return (size_t*)&bucket->value;
+    }
+    for (; i < lhs.len; ++i) {
+        if (lhs.str[i] != rhs.str[i]) {
+            return false;
         }
-    } while ((bucket = bucket->next));
+    }
 
-    printf("Went through bucket without finding anything\n");
-    return NULL;
+    return true;
 }
 
-size_t* get_map(const si_map_t* map, slice_t key) {
-    size_t idx = hash_str(key) % map->capacity;
+// how far the entry in `idx` is from the slot its hash points to
+static inline size_t probe_distance(const si_map_t* map, uint32_t hash, size_t idx) {
+    return (idx - (size_t)hash) & (map->capacity - 1);
+}
 
-    return get_bucket(&map->buckets[idx], key);
+static si_slot_t* alloc_slots(Arena* arena, size_t capacity) {
+    si_slot_t* slots = arena != NULL ? arenaCalloc(arena, capacity, sizeof(si_slot_t))
+                                     : calloc(capacity, sizeof(si_slot_t));
+    if (slots == NULL) {
+        exit(1);
+    }
+    return slots;
 }
 
-static bool insert_bucket(si_bucket_t* bucket, slice_t key, size_t value) {
-    if (bucket == NULL) {
-        return false;
+// Smallest power of two that holds `len` keys without going over the load factor
+static size_t capacity_for(size_t len) {
+    size_t capacity = DEFAULT_MAP_CAPACITY;
+    while (len > capacity / 4 * 3) {
+        capacity *= 2;
     }
+    return capacity;
+}
 
-    do {
-        if (bucket->key.str == NULL) {
-            bucket->key.str = strndup(key.str, key.len);
-            bucket->key.len = key.len;
-            bucket->value = value;
-            return true;
-        }
-        if (cmp_str(bucket->key, key) == 0) {
-            return false;
-        }
-        if (bucket->next == NULL) {
-            si_bucket_t* new = (si_bucket_t*)malloc(1 * sizeof(si_bucket_t));
+si_map_t new_map_in(Arena* arena, size_t capacity) {
+    const size_t slots = capacity_for(capacity);
 
-            new->key.str = strndup(key.str, key.len);
-            new->key.len = key.len;
-            new->value = value;
+    return (si_map_t){
+        .capacity = slots,
+        .len = 0,
+        .slots = alloc_slots(arena, slots),
+        .arena = arena,
+    };
+}
 
-            new->prev = bucket;
-            new->next = NULL;
-            bucket->next = new;
+si_map_t new_map_with_capacity(size_t capacity) { return new_map_in(NULL, capacity); }
 
-            return true;
+si_map_t new_map() { return new_map_in(NULL, 0); }
+
+static si_slot_t* find_slot(const si_map_t* map, slice_t key) {
+    const uint32_t hash = slot_hash(key);
+    const size_t mask = map->capacity - 1;
+
+    for (size_t idx = (size_t)hash & mask, dist = 0;; idx = (idx + 1) & mask, ++dist) {
+        si_slot_t* slot = &map->slots[idx];
+
+        // an entry this close to home means `key` would have taken its slot
+        if (slot->hash == 0 || probe_distance(map, slot->hash, idx) < dist) {
+            return NULL;
+        }
+        if (slot->hash == hash && keys_eq(slot_key(slot), key)) {
+            return slot;
         }
-    } while ((bucket = bucket->next));
+    }
+}
+
+size_t* get_map(const si_map_t* map, slice_t key) {
+    si_slot_t* slot = find_slot(map, key);
 
-    // should be unreachable
-    exit(1);
+    return slot != NULL ? &slot->value : NULL;
 }
 
-bool insert_map(si_map_t* map, slice_t key, size_t value) {
-    // Grow if length > 0.75 * capacity
-    if (map->len > map->capacity / 4 * 3) {
-        si_map_t new = new_map_with_capacity(map->capacity * 2);
-
-        si_bucket_t* bucket;
-
-        for (size_t i = 0; i < map->capacity; ++i) {
-            bucket = &map->buckets[i];
-            do {
-                if (bucket->key.str != NULL) {
-                    insert_map(&new, bucket->key, bucket->value);
-                }
-            } while ((bucket = bucket->next));
+// Places an entry that's known not to be in the map yet
+static void place(si_map_t* map, si_slot_t entry) {
+    const size_t mask = map->capacity - 1;
+
+    for (size_t idx = (size_t)entry.hash & mask, dist = 0;; idx = (idx + 1) & mask, ++dist) {
+        si_slot_t* slot = &map->slots[idx];
+
+        if (slot->hash == 0) {
+            *slot = entry;
+            return;
         }
 
-        free_map(map);
-        *map = new;
+        // take from the rich: whoever is closer to home moves on
+        const size_t slot_dist = probe_distance(map, slot->hash, idx);
+        if (slot_dist < dist) {
+            const si_slot_t displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+            dist = slot_dist;
+        }
     }
+}
 
-    size_t idx = hash_str(key) % map->capacity;
+static void grow(si_map_t* map) {
+    si_map_t grown = (si_map_t){.capacity = map->capacity * 2,
+                                .len = map->len,
+                                .slots = alloc_slots(map->arena, map->capacity * 2),
+                                .arena = map->arena};
 
-    if (insert_bucket(&map->buckets[idx], key, value)) {
-        map->len++;
-        return true;
+    // the hashes are stored, so rehashing doesn't have to look at a single key
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->slots[i].hash != 0) {
+            place(&grown, map->slots[i]);
+        }
+    }
+
+    if (map->arena == NULL) {
+        free(map->slots);
     }
-    return false;
+    *map = grown;
 }
 
-static bool remove_bucket(si_bucket_t* bucket, slice_t key) {
-    if (bucket == NULL) {
+bool insert_map(si_map_t* map, slice_t key, size_t value) {
+    if (find_slot(map, key) != NULL) {
         return false;
     }
 
-    si_bucket_t* current = bucket;
-    while (current != NULL) {
-        if (current->key.str == NULL) {
-            printf("key is null while trying to remove something\n");
-            return false;
-        }
-        if (cmp_str(current->key, key) == 0) {
-            if (current->prev == NULL) {
-                // Head node removal
-                if (current->next == NULL) {
-                    // Only node in chain
-                    free((void*)current->key.str);
-                    current->key.str = NULL;
-                    current->key.len = 0;
-                    current->value = 0;
-                } else {
-                    // Replace head with next node
-                    si_bucket_t* next_node = current->next;
-                    free((void*)current->key.str);
-                    current->key = next_node->key;
-                    current->value = next_node->value;
-                    current->next = next_node->next;
-                    if (next_node->next) {
-                        next_node->next->prev = current;
-                    }
-                    free(next_node);
-                }
-            } else {
-                // Non-head node removal
-                current->prev->next = current->next;
-                if (current->next) {
-                    current->next->prev = current->prev;
-                }
-                free((void*)current->key.str);
-                free(current);
-            }
-            return true;
-        }
-        current = current->next;
+    // Grow if length > 0.75 * capacity
+    if (map->len + 1 > map->capacity / 4 * 3) {
+        grow(map);
     }
 
-    printf("Went through bucket without finding anything\n");
-    return false;
-}
-
-bool remove_map(si_map_t* map, slice_t key) {
-    size_t idx = hash_str(key) % map->capacity;
+    assert(key.len <= UINT32_MAX);
+    place(map, (si_slot_t){.hash = slot_hash(key),
+                           .len = (uint32_t)key.len,
+                           .str = key.str,
+                           .value = value});
+    map->len++;
 
-    return remove_bucket(&map->buckets[idx], key);
+    return true;
 }
 
-void clear_map(si_map_t* map) {
-    free_map(map);
-    *map = new_map();
-}
+bool remove_map(si_map_t* map, slice_t key) {
+    si_slot_t* slot = find_slot(map, key);
+    if (slot == NULL) {
+        return false;
+    }
 
-static void free_bucket(si_bucket_t* bucket) {
-    assert(bucket != NULL);
+    // shift the entries after it back by one until one is already in its home slot, so no probe
+    // sequence ever runs into a hole
+    const size_t mask = map->capacity - 1;
+    size_t idx = (size_t)(slot - map->slots);
+    size_t next = (idx + 1) & mask;
 
-    si_bucket_t* current = bucket->next;
-    while (current != NULL) {
-        si_bucket_t* next = current->next;
-        if (current->key.str != NULL) {
-            free((void*)current->key.str);
-        }
-        free(current);
-        current = next;
+    while (map->slots[next].hash != 0 && probe_distance(map, map->slots[next].hash, next) > 0) {
+        map->slots[idx] = map->slots[next];
+        idx = next;
+        next = (next + 1) & mask;
     }
+    map->slots[idx] = (si_slot_t){0};
+    map->len--;
 
-    if (bucket->key.str != NULL) {
-        free((void*)bucket->key.str);
-        bucket->key.str = NULL;
-    }
+    return true;
+}
+
+void clear_map(si_map_t* map) {
+    memset(map->slots, 0, map->capacity * sizeof(si_slot_t));
+    map->len = 0;
 }
 
 void free_map(si_map_t* map) {
     assert(map != NULL);
 
-    if (map->buckets == NULL) {
-        return;
+    if (map->arena == NULL) {
+        free(map->slots);
     }
 
-    for (size_t i = 0; i < map->capacity; ++i) {
-        free_bucket(&map->buckets[i]);
-    }
-
-    free(map->buckets);
-    map->buckets = NULL;
+    map->slots = NULL;
     map->capacity = 0;
     map->len = 0;
 }
@@ -232,65 +232,39 @@ void free_map(si_map_t* map) {
 si_map_iter_t iter_from_map(const si_map_t* map) {
     assert(map != NULL);
 
-    const si_bucket_t* end = &map->buckets[map->capacity - 1];
-
     return (si_map_iter_t){
-        .ptr = map->buckets,
-        .end = end,
-        .bucket_idx = 0,
+        .ptr = map->slots,
+        .end = map->slots + map->capacity,
     };
 }
 
+static const si_slot_t* skip_empty(const si_map_iter_t* iter) {
+    const si_slot_t* ptr = iter->ptr;
+    while (ptr != iter->end && ptr->hash == 0) {
+        ptr++;
+    }
+    return ptr;
+}
+
 si_kv map_iter_peek(const si_map_iter_t* iter) {
     assert(iter != NULL);
 
-    si_bucket_t* ptr = (si_bucket_t*)iter->ptr;
-
-    while (ptr->key.str == NULL && ptr != iter->end) {
-        ptr++;
-    }
+    const si_slot_t* ptr = skip_empty(iter);
     if (ptr == iter->end) {
         return (si_kv){.key = (slice_t){.len = 0, .str = NULL}, .value = 0};
     }
-    for (size_t i = 0; i < iter->bucket_idx; ++i) {
-        if (ptr->next != NULL) {
-            ptr = ptr->next;
-        } else {
-            printf("BLOW THIS BUILDING UP NOW\n");
-            exit(1);
-        }
-    }
-    return (si_kv){.key = ptr->key, .value = ptr->value};
+    return (si_kv){.key = slot_key(ptr), .value = ptr->value};
 }
 
 si_kv map_iter_next(si_map_iter_t* iter) {
     assert(iter != NULL);
 
-    // printf("bucket idx: %lu\n", iter->bucket_idx);
-
-    si_bucket_t* bucketptr = (si_bucket_t*)iter->ptr;
-
-    while (bucketptr->key.str == NULL && bucketptr != iter->end) {
-        bucketptr++;
-    }
-    if (bucketptr == iter->end) {
+    const si_slot_t* ptr = skip_empty(iter);
+    if (ptr == iter->end) {
+        iter->ptr = ptr;
         return (si_kv){.key = (slice_t){.len = 0, .str = NULL}, .value = 0};
     }
-    for (size_t i = 0; i < iter->bucket_idx; ++i) {
-        if (bucketptr->next != NULL) {
-            bucketptr = bucketptr->next;
-        } else {
-            printf("BLOW THIS BUILDING UP NOW\n");
-            exit(1);
-        }
-    }
-    if (bucketptr->next != NULL) {
-        // printf("incr bucket idx\n");
-        iter->bucket_idx++;
-    } else {
-        // printf("incr pointer\n");
-        iter->bucket_idx = 0;
-        iter->ptr++;
-    }
-    return (si_kv){.key = bucketptr->key, .value = bucketptr->value};
+
+    iter->ptr = ptr + 1;
+    return (si_kv){.key = slot_key(ptr), .value = ptr->value};
 }
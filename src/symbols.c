@@ -0,0 +1,97 @@
+#include "headers/symbols.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int cmpSymbol(const void* lhs, const void* rhs) {
+    const Symbol* a = lhs;
+    const Symbol* b = rhs;
+
+    return (int)a->addr - (int)b->addr;
+}
+
+SymbolTable newSymbols(size_t capacity) {
+    return (SymbolTable){.symbols = new_vec(capacity + 1, sizeof(Symbol))};
+}
+
+void addSymbol(SymbolTable* table, slice_t name, uint16_t addr) {
+    slice_t owned = (slice_t){.str = strndup(name.str, name.len), .len = name.len};
+    Symbol sym = (Symbol){.name = owned, .addr = addr};
+    push_vec(&table->symbols, &sym);
+}
+
+void sortSymbols(SymbolTable* table) {
+    qsort(table->symbols.ptr, table->symbols.len, sizeof(Symbol), cmpSymbol);
+}
+
+SymbolTable symbolsFromLabels(const si_map_t* labels, size_t size) {
+    SymbolTable table = newSymbols(labels->len);
+
+    si_map_iter_t iter = iter_from_map(labels);
+    si_kv label;
+
+    while ((label = map_iter_next(&iter)).key.str != NULL) {
+        // constants like `.video = 0x9fff` point outside the program and would only make
+        // addresses in it look like they belong to memory mapped io
+        if (label.value >= PROGRAM_START && label.value < size) {
+            addSymbol(&table, label.key, (uint16_t)label.value);
+        }
+    }
+
+    sortSymbols(&table);
+
+    return table;
+}
+
+static void freeSymbol(void* symbol) { free((char*)((Symbol*)symbol)->name.str); }
+
+void freeSymbols(SymbolTable* table) {
+    if (table != NULL) {
+        free_vec(&table->symbols, freeSymbol);
+    }
+}
+
+const Symbol* findSymbol(const SymbolTable* table, uint16_t addr) {
+    const Symbol* symbols = table->symbols.ptr;
+    size_t lo = 0;
+    size_t hi = table->symbols.len;
+
+    // first symbol with an address past addr
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (symbols[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo == 0 ? NULL : &symbols[lo - 1];
+}
+
+void fprintSymbolized(FILE* out, const SymbolTable* table, uint16_t addr) {
+    const Symbol* sym = findSymbol(table, addr);
+
+    if (sym == NULL) {
+        fprintf(out, "0x%04x", addr);
+    } else if (sym->addr == addr) {
+        fprintf(out, "%.*s", (int)sym->name.len, sym->name.str);
+    } else {
+        fprintf(out, "%.*s+%u", (int)sym->name.len, sym->name.str, addr - sym->addr);
+    }
+}
+
+slice_t sourceLine(slice_t source, size_t line_nr) {
+    size_t start = 0;
+
+    for (size_t line = 1; line < line_nr && start < source.len; ++start) {
+        if (source.str[start] == '\n') line++;
+    }
+
+    size_t end = start;
+    while (end < source.len && source.str[end] != '\n' && source.str[end] != '\r') {
+        end++;
+    }
+
+    return (slice_t){.str = source.str + start, .len = end - start};
+}
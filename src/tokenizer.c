@@ -1,6 +1,7 @@
 #include "headers/tokenizer.h"
 
 #include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "headers/ostring.h"
@@ -19,20 +20,122 @@ static bool istokdelim(char c) {
     }
 }
 
-static void str_iter_skip_space(str_iter_t* iter) {
-    char p;
-    while ((p = str_iter_peek(iter)) && p == ' ') {
-        str_iter_next(iter);
+// The skip functions below scan a whole block of characters at a time where the target supports
+// it. Every block is turned into a bitmask of the characters the scan stops at, so the first set
+// bit is where the run ends. The leftover tail, and targets without SIMD, use the scalar loop.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_WIDTH 32
+#define FULL_MASK 0xFFFFFFFFU
+typedef __m256i block_t;
+
+static inline block_t loadBlock(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+
+static inline uint32_t eqMask(block_t block, char c) {
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)));
+}
+
+// only used for ASCII ranges, so the signed comparison doesn't matter
+static inline uint32_t rangeMask(block_t block, char lo, char hi) {
+    const __m256i above = _mm256_cmpgt_epi8(block, _mm256_set1_epi8((char)(lo - 1)));
+    const __m256i below = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(hi + 1)), block);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(above, below));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_WIDTH 16
+#define FULL_MASK 0xFFFFU
+typedef __m128i block_t;
+
+static inline block_t loadBlock(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+
+static inline uint32_t eqMask(block_t block, char c) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+}
+
+// only used for ASCII ranges, so the signed comparison doesn't matter
+static inline uint32_t rangeMask(block_t block, char lo, char hi) {
+    const __m128i above = _mm_cmpgt_epi8(block, _mm_set1_epi8((char)(lo - 1)));
+    const __m128i below = _mm_cmplt_epi8(block, _mm_set1_epi8((char)(hi + 1)));
+    return (uint32_t)_mm_movemask_epi8(_mm_and_si128(above, below));
+}
+#endif
+
+/// What a scan skips over. Like `str_iter_peek` returning 0, a NUL always ends a scan.
+typedef enum ScanClass {
+    // spaces
+    SPACE_RUN,
+    // everything up to a newline
+    UNTIL_NEWLINE,
+    // everything up to a doublequote
+    UNTIL_DOUBLEQUOTE,
+    // letters, digits and underscores
+    LABEL_RUN,
+} ScanClass;
+
+static inline bool isLabelChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline bool isScanStop(char c, ScanClass class) {
+    switch (class) {
+        case SPACE_RUN:
+            return c != ' ';
+        case UNTIL_NEWLINE:
+            return c == '\n' || c == '\0';
+        case UNTIL_DOUBLEQUOTE:
+            return c == '"' || c == '\0';
+        case LABEL_RUN:
+            return !isLabelChar(c);
     }
+    return true;
 }
 
-static void str_iter_skip_comment(str_iter_t* iter) {
-    char p;
-    while ((p = str_iter_peek(iter)) && p != '\n') {
-        str_iter_next(iter);
+#ifdef SCAN_WIDTH
+static inline uint32_t scanStopMask(block_t block, ScanClass class) {
+    switch (class) {
+        case SPACE_RUN:
+            return ~eqMask(block, ' ') & FULL_MASK;
+        case UNTIL_NEWLINE:
+            return eqMask(block, '\n') | eqMask(block, '\0');
+        case UNTIL_DOUBLEQUOTE:
+            return eqMask(block, '"') | eqMask(block, '\0');
+        case LABEL_RUN:
+            return ~(rangeMask(block, 'a', 'z') | rangeMask(block, 'A', 'Z') |
+                     rangeMask(block, '0', '9') | eqMask(block, '_')) &
+                   FULL_MASK;
+    }
+    return FULL_MASK;
+}
+#endif
+
+/// Moves `iter` to the first character that ends a run of `class`, or past the end
+static void str_iter_scan(str_iter_t* iter, ScanClass class) {
+    const char* p = iter->ptr;
+    // `end` of an iterator is inclusive
+    const char* end = iter->end + 1;
+
+#ifdef SCAN_WIDTH
+    while (end - p >= SCAN_WIDTH) {
+        const uint32_t stop = scanStopMask(loadBlock(p), class);
+        if (stop != 0) {
+            iter->ptr = (char*)p + __builtin_ctz(stop);
+            return;
+        }
+        p += SCAN_WIDTH;
     }
+#endif
+
+    while (p < end && !isScanStop(*p, class)) {
+        p++;
+    }
+    iter->ptr = (char*)p;
 }
 
+static void str_iter_skip_space(str_iter_t* iter) { str_iter_scan(iter, SPACE_RUN); }
+
+static void str_iter_skip_comment(str_iter_t* iter) { str_iter_scan(iter, UNTIL_NEWLINE); }
+
 static void str_iter_skip_number(str_iter_t* iter) {
     char p;
     if ((p = tolower(str_iter_peek(iter))) && (p == 'b' || p == 'o' || p == 'x')) {
@@ -43,18 +146,10 @@ static void str_iter_skip_number(str_iter_t* iter) {
     }
 }
 
-static void str_iter_skip_label(str_iter_t* iter) {
-    char p;
-    while ((p = tolower(str_iter_peek(iter))) && (islower(p) || isdigit(p) || p == '_')) {
-        str_iter_next(iter);
-    }
-}
+static void str_iter_skip_label(str_iter_t* iter) { str_iter_scan(iter, LABEL_RUN); }
 
 static void str_iter_skip_until_doublequotes(str_iter_t* iter) {
-    char p;
-    while ((p = str_iter_peek(iter)) && p != '"') {
-        str_iter_next(iter);
-    }
+    str_iter_scan(iter, UNTIL_DOUBLEQUOTE);
     str_iter_next(iter);  // skip final doublequote
 }
 
@@ -344,6 +439,11 @@ TokenSymbol tokenizeSymbol(str_iter_t* iter) {
                     }
             }
             return unknown(iter);
+        case 'W':
+            if (str_iter_next(iter) == 'A' && str_iter_next(iter) == 'I' &&
+                str_iter_next(iter) == 'T' && istokdelim(str_iter_peek(iter)))
+                return WAIT_T;
+            return unknown(iter);
         case 'X':
             switch (str_iter_next(iter)) {
                 case 'C':
@@ -418,18 +518,52 @@ TokenSymbol tokenizeSymbol(str_iter_t* iter) {
     return unknown(iter);
 }
 
-TokenLine tokenizeLine(str_iter_t* iter, size_t line_nr) {
+// Gives label tokens the id of the name they mention, the first mention of a name picks a new one
+static uint32_t internLabel(TokenLines* lines, TokenSymbol symbol, slice_t substr) {
+    slice_t name;
+    switch (symbol) {
+        case LABEL_DEF_T:
+            // definitions end with :
+            name = from_cstr_slice(substr.str, substr.len - 1);
+            break;
+        case LABEL_REF_T:
+            // references start with .
+            name = from_cstr_slice(substr.str + 1, substr.len - 1);
+            break;
+        case LABEL_IDX_T:
+            name = substr;
+            break;
+        default:
+            return NO_LABEL;
+    }
+
+    return internLabelName(lines, name);
+}
+
+uint32_t internLabelName(TokenLines* lines, slice_t name) {
+    const size_t* id = get_map(&lines->label_ids, name);
+    if (id != NULL) {
+        return (uint32_t)*id;
+    }
+
+    const size_t new_id = len_vec(&lines->label_names);
+    insert_map(&lines->label_ids, name, new_id);
+    push_vec(&lines->label_names, &name);
+
+    return (uint32_t)new_id;
+}
+
+bool tokenizeLine(str_iter_t* iter, size_t line_nr, TokenLines* out) {
     const char* line_start = iter->ptr;
+    const size_t offset = out->tokens.len;
 
     str_iter_skip_space(iter);
 
     if (str_iter_peek(iter) == '\n') {
         str_iter_next(iter);
-        return (TokenLine){0};
+        return false;
     }
 
-    vec_t res = new_vec(10, sizeof(Token));
-
     char p;
     while ((p = str_iter_peek(iter)) && p != '\n') {
         str_iter_skip_space(iter);
@@ -442,16 +576,18 @@ TokenLine tokenizeLine(str_iter_t* iter, size_t line_nr) {
         const slice_t substr = from_cstr_slice(start, (size_t)(end - start));
         const size_t char_nr = (size_t)(start - line_start);
 
-        Token tok = (Token){.substr = substr, .tok = symbol, .char_nr = char_nr};
-        push_vec(&res, &tok);
+        Token tok = (Token){.substr = substr,
+                            .tok = symbol,
+                            .label = internLabel(out, symbol, substr),
+                            .char_nr = char_nr};
+        push_vec(&out->tokens, &tok);
 
         str_iter_skip_space(iter);  // skip spaces until potential newline
     }
 
-    // if for whatever reason no tokens were encountered on the line, free underlying vec
-    if (res.len == 0) {
-        free_vec(&res, NULL);
-        return (TokenLine){0};
+    // if for whatever reason no tokens were encountered on the line, it doesn't get an entry
+    if (out->tokens.len == offset) {
+        return false;
     }
 
     slice_t substr = from_cstr_slice(line_start, (size_t)(iter->ptr - line_start));
@@ -459,38 +595,78 @@ TokenLine tokenizeLine(str_iter_t* iter, size_t line_nr) {
     // skip newline if while loop exited because of it while not putting it in the substr
     if (str_iter_peek(iter) == '\n') str_iter_next(iter);
 
-    return (TokenLine){.tokens = res, .substr = substr, .line_nr = line_nr};
+    TokenLine line = (TokenLine){
+        .offset = offset, .count = out->tokens.len - offset, .substr = substr, .line_nr = line_nr};
+    push_vec(&out->lines, &line);
+
+    return true;
+}
+
+TokenLines newTokenLines(Arena* arena, size_t token_capacity, size_t line_capacity) {
+    // guess that about every fourth line mentions a label no earlier line did
+    const size_t label_capacity = line_capacity / 4 + 1;
+
+    if (arena != NULL) {
+        return (TokenLines){.tokens = new_vec_in(arena, token_capacity, sizeof(Token)),
+                            .lines = new_vec_in(arena, line_capacity, sizeof(TokenLine)),
+                            .label_ids = new_map_in(arena, label_capacity),
+                            .label_names = new_vec_in(arena, label_capacity, sizeof(slice_t)),
+                            .line_count = 0};
+    }
+    return (TokenLines){.tokens = new_vec(token_capacity, sizeof(Token)),
+                        .lines = new_vec(line_capacity, sizeof(TokenLine)),
+                        .label_ids = new_map_with_capacity(label_capacity),
+                        .label_names = new_vec(label_capacity, sizeof(slice_t)),
+                        .line_count = 0};
+}
+
+TokenLines tokenizeProgram(slice_t program, Arena* arena) {
+    size_t tokenized;
+    return tokenizeLinesUntil(program, program.len, arena, &tokenized);
 }
 
-TokenLines tokenizeProgram(slice_t program) {
-    vec_t res = new_vec(10, sizeof(TokenLine));
+TokenLines tokenizeLinesUntil(slice_t program, size_t until, Arena* arena, size_t* tokenized) {
+    // rough guesses for typical assembly, both vecs double whenever they run out so the number of
+    // allocations doesn't depend on the number of lines either way
+    const size_t len = until < program.len ? until : program.len;
+    TokenLines res = newTokenLines(arena, len / 8 + 16, len / 24 + 16);
     size_t lineNr = 1;  // first line in an editor is 1
 
     str_iter_t iter = iter_from_slice(program);
 
-    while (str_iter_peek(&iter)) {
-        TokenLine line = tokenizeLine(&iter, lineNr);
-
-        if (line.tokens.len > 0) {
-            push_vec(&res, &line);
-        }
+    // a line only returns before a NUL or the end if it ended at a newline, so once it has the
+    // next one starts right after that newline
+    while (str_iter_peek(&iter) && (size_t)(iter.ptr - program.str) < until) {
+        tokenizeLine(&iter, lineNr, &res);
         ++lineNr;
     }
+    res.line_count = lineNr - 1;
+    *tokenized = (size_t)(iter.ptr - program.str);
 
-    return (TokenLines){.lines = res};
+    return res;
 }
 
-void freeTokenLine(void* tokenLine) {
-    if (tokenLine != NULL) {
-        TokenLine* line = tokenLine;
-        free_vec(&line->tokens, NULL);
-    }
+vec_iter_t iterTokenLine(const TokenLines* lines, const TokenLine* line) {
+    Token* first = firstToken(lines, line);
+
+    return (vec_iter_t){.elem_size = sizeof(Token), .ptr = first, .end = first + line->count - 1};
+}
+
+Token* firstToken(const TokenLines* lines, const TokenLine* line) {
+    return (Token*)lines->tokens.ptr + line->offset;
+}
+
+slice_t labelName(const TokenLines* lines, uint32_t id) {
+    return CAST(get_vec(&lines->label_names, id), slice_t);
 }
 
 void freeTokenLines(void* tokenLines) {
     if (tokenLines != NULL) {
         TokenLines* t = tokenLines;
-        free_vec(&t->lines, freeTokenLine);
+        free_vec(&t->tokens, NULL);
+        free_vec(&t->lines, NULL);
+        free_map(&t->label_ids);
+        free_vec(&t->label_names, NULL);
     }
 }
 
@@ -540,6 +716,7 @@ bool is_token_op(TokenSymbol token) {
         case LEAVE_T:
         case MIN_T:
         case MAX_T:
+        case WAIT_T:
             return true;
         default:
             return false;
@@ -0,0 +1,352 @@
+#include "headers/trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "headers/instructions.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Every integer in a trace file is little endian:
+//
+//   "CTRC" u8 version, u8 record size, u16 reserved
+//   (u64 cycle, u16 pc, u8 opcode, u8 operands[2], u8 acc, u8 flags, u8 sp) per record
+
+#define TRACE_HEADER_SIZE 8
+// records the writer copies out of the ring at once
+#define TRACE_BATCH 1024
+
+void initTrace(Trace* trace, size_t capacity) {
+    size_t cap = 1;
+    while (cap < (capacity == 0 ? DEFAULT_TRACE_CAPACITY : capacity)) {
+        cap <<= 1;
+    }
+
+    trace->ring = calloc(cap, sizeof(TraceRecord));
+    if (trace->ring == NULL) {
+        exit(1);
+    }
+    trace->capacity = cap;
+    atomic_init(&trace->head, 0);
+
+    trace->out = NULL;
+    trace->written = 0;
+    trace->dropped = 0;
+    atomic_init(&trace->streaming, false);
+    trace->writer = NULL;
+}
+
+void freeTrace(Trace* trace) {
+    if (trace->out != NULL) {
+        stopTraceWriter(trace);
+    }
+    free(trace->ring);
+    trace->ring = NULL;
+}
+
+int runCpuTraced(CPU* cpu, Trace* trace) {
+    const size_t mask = trace->capacity - 1;
+    uint64_t head = atomic_load_explicit(&trace->head, memory_order_relaxed);
+    uint8_t op = MEMORY(PC);
+
+    do {
+        TraceRecord* rec = &trace->ring[head & mask];
+        rec->cycle = head;
+        rec->pc = PC;
+        rec->opcode = op == OP_BRK ? *programByte(cpu, PC) : op;
+        rec->operands[0] = MEMORY((uint16_t)(PC + 1));
+        rec->operands[1] = MEMORY((uint16_t)(PC + 2));
+
+        OP_TABLE[op](cpu);
+
+        rec->acc = ACC;
+        rec->flags = FLAGS;
+        rec->sp = SP;
+        // publishes the record to the writer, a plain store on x86
+        atomic_store_explicit(&trace->head, ++head, memory_order_release);
+
+        if (FLAGS & TF_BIT) {
+            stopOnTrap(cpu);
+        }
+
+        op = MEMORY(PC);
+        // a breakpoint on the HALT ends the run too, like in stepCpu
+    } while ((op == OP_BRK ? *programByte(cpu, PC) : op) != OP_HALT);
+
+    return 0;
+}
+
+static void encodeRecord(const TraceRecord* rec, uint8_t* buf) {
+    for (size_t i = 0; i < 8; ++i) {
+        buf[i] = (uint8_t)(rec->cycle >> (i * 8));
+    }
+    buf[8] = (uint8_t)(rec->pc & 0xFF);
+    buf[9] = (uint8_t)(rec->pc >> 8);
+    buf[10] = rec->opcode;
+    buf[11] = rec->operands[0];
+    buf[12] = rec->operands[1];
+    buf[13] = rec->acc;
+    buf[14] = rec->flags;
+    buf[15] = rec->sp;
+}
+
+static void decodeRecord(const uint8_t* buf, TraceRecord* rec) {
+    rec->cycle = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        rec->cycle |= (uint64_t)buf[i] << (i * 8);
+    }
+    rec->pc = (uint16_t)(buf[8] | (buf[9] << 8));
+    rec->opcode = buf[10];
+    rec->operands[0] = buf[11];
+    rec->operands[1] = buf[12];
+    rec->acc = buf[13];
+    rec->flags = buf[14];
+    rec->sp = buf[15];
+}
+
+// Where encoded records go, a FILE or, in a signal handler, a file descriptor
+typedef void (*Emit)(const uint8_t* bytes, size_t len, void* out);
+
+static void emitFile(const uint8_t* bytes, size_t len, void* out) {
+    fwrite(bytes, 1, len, (FILE*)out);
+}
+
+static void writeHeader(Emit emit, void* out) {
+    const uint8_t header[TRACE_HEADER_SIZE] = {
+        TRACE_MAGIC[0], TRACE_MAGIC[1], TRACE_MAGIC[2], TRACE_MAGIC[3],
+        TRACE_VERSION,  TRACE_RECORD_SIZE, 0, 0};
+
+    emit(header, sizeof(header), out);
+}
+
+// Copies the records from `from` up to `to` into `out`. A record is only known to be intact if the
+// head hasn't lapped it once the copy is done, the ones the VM overwrote in the meantime are
+// dropped. Returns the index of the first record that wasn't looked at. Only uses the stack, so it
+// can run in a signal handler.
+static uint64_t copyRecords(Trace* trace, Emit emit, void* out, uint64_t from, uint64_t to,
+                            uint64_t* dropped) {
+    const size_t mask = trace->capacity - 1;
+    uint8_t buf[TRACE_BATCH * TRACE_RECORD_SIZE];
+
+    if (to - from > trace->capacity) {
+        *dropped += to - from - trace->capacity;
+        from = to - trace->capacity;
+    }
+
+    while (from < to) {
+        const uint64_t end = from + TRACE_BATCH < to ? from + TRACE_BATCH : to;
+        TraceRecord batch[TRACE_BATCH];
+
+        for (uint64_t i = from; i < end; ++i) {
+            batch[i - from] = trace->ring[i & mask];
+        }
+
+        // the VM may already be writing record `head`, which takes the slot of `head - capacity`
+        const uint64_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+        uint64_t first_valid = head + 1 > trace->capacity ? head + 1 - trace->capacity : 0;
+        if (first_valid < from) first_valid = from;
+
+        if (first_valid >= end) {
+            *dropped += end - from;
+        } else {
+            *dropped += first_valid - from;
+            size_t count = 0;
+            for (uint64_t i = first_valid; i < end; ++i) {
+                encodeRecord(&batch[i - from], &buf[count++ * TRACE_RECORD_SIZE]);
+            }
+            emit(buf, count * TRACE_RECORD_SIZE, out);
+        }
+
+        from = end;
+    }
+
+    return from;
+}
+
+static void drainTrace(Trace* trace) {
+    const uint64_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+    trace->written =
+        copyRecords(trace, emitFile, trace->out, trace->written, head, &trace->dropped);
+}
+
+#ifndef _WIN32
+static void* traceWriter(void* data) {
+    Trace* trace = (Trace*)data;
+    const struct timespec idle = {.tv_sec = 0, .tv_nsec = 1000000};
+
+    while (atomic_load_explicit(&trace->streaming, memory_order_relaxed)) {
+        const uint64_t before = trace->written;
+        drainTrace(trace);
+
+        if (trace->written == before) {
+            nanosleep(&idle, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+bool startTraceWriter(Trace* trace, const char* path) {
+    trace->out = fopen(path, "wb");
+    if (trace->out == NULL) return false;
+
+    writeHeader(emitFile, trace->out);
+    trace->written = atomic_load(&trace->head);
+    trace->dropped = 0;
+    atomic_store(&trace->streaming, true);
+
+    pthread_t* writer = malloc(sizeof(pthread_t));
+    if (writer == NULL || pthread_create(writer, NULL, traceWriter, trace) != 0) {
+        free(writer);
+        fclose(trace->out);
+        trace->out = NULL;
+        atomic_store(&trace->streaming, false);
+        return false;
+    }
+    trace->writer = writer;
+
+    return true;
+}
+
+uint64_t stopTraceWriter(Trace* trace) {
+    if (trace->out == NULL) return 0;
+
+    atomic_store(&trace->streaming, false);
+    pthread_join(*(pthread_t*)trace->writer, NULL);
+    free(trace->writer);
+    trace->writer = NULL;
+
+    drainTrace(trace);
+    fclose(trace->out);
+    trace->out = NULL;
+
+    return trace->dropped;
+}
+#else
+bool startTraceWriter(Trace* trace, const char* path) {
+    (void)trace;
+    (void)path;
+    return false;
+}
+
+uint64_t stopTraceWriter(Trace* trace) {
+    (void)trace;
+    return 0;
+}
+#endif
+
+// Writes a header and the records still in the ring, oldest first
+static void writeRing(Trace* trace, Emit emit, void* out) {
+    const uint64_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+    const uint64_t from = head > trace->capacity ? head - trace->capacity : 0;
+    uint64_t dropped = 0;
+
+    writeHeader(emit, out);
+    copyRecords(trace, emit, out, from, head, &dropped);
+}
+
+bool dumpTrace(Trace* trace, const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return false;
+
+    writeRing(trace, emitFile, fp);
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+
+    return ok;
+}
+
+#ifndef _WIN32
+static Trace* signal_trace = NULL;
+static const char* signal_path = NULL;
+static const int DUMP_SIGNALS[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGINT, SIGTERM};
+#define DUMP_SIGNAL_COUNT (sizeof(DUMP_SIGNALS) / sizeof(int))
+
+static void emitFd(const uint8_t* bytes, size_t len, void* out) {
+    const int fd = *(const int*)out;
+    while (len > 0) {
+        const ssize_t n = write(fd, bytes, len);
+        if (n <= 0) return;
+        bytes += n;
+        len -= (size_t)n;
+    }
+}
+
+// Only uses async-signal-safe calls, the handler resets itself so raising the signal again ends
+// the process the way it would have without it
+static void dumpOnSignal(int sig) {
+    Trace* trace = signal_trace;
+
+    if (trace != NULL) {
+        int fd = open(signal_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            writeRing(trace, emitFd, &fd);
+            close(fd);
+        }
+    }
+
+    raise(sig);
+}
+
+bool dumpTraceOnSignal(Trace* trace, const char* path) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dumpOnSignal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    signal_path = path;
+    signal_trace = trace;
+    for (size_t i = 0; i < DUMP_SIGNAL_COUNT; ++i) {
+        if (sigaction(DUMP_SIGNALS[i], &action, NULL) != 0) return false;
+    }
+
+    return true;
+}
+
+void stopDumpOnSignal(void) {
+    for (size_t i = 0; i < DUMP_SIGNAL_COUNT; ++i) {
+        signal(DUMP_SIGNALS[i], SIG_DFL);
+    }
+    signal_trace = NULL;
+}
+#else
+bool dumpTraceOnSignal(Trace* trace, const char* path) {
+    UNUSED(trace);
+    UNUSED(path);
+    return false;
+}
+
+void stopDumpOnSignal(void) {}
+#endif
+
+bool readTrace(const char* path, vec_t* records) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return false;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (fread(header, 1, TRACE_HEADER_SIZE, fp) != TRACE_HEADER_SIZE ||
+        memcmp(header, TRACE_MAGIC, 4) != 0 || header[4] != TRACE_VERSION ||
+        header[5] != TRACE_RECORD_SIZE) {
+        fclose(fp);
+        return false;
+    }
+
+    uint8_t buf[TRACE_RECORD_SIZE];
+    while (fread(buf, 1, TRACE_RECORD_SIZE, fp) == TRACE_RECORD_SIZE) {
+        TraceRecord rec;
+        decodeRecord(buf, &rec);
+        push_vec(records, &rec);
+    }
+
+    fclose(fp);
+
+    return true;
+}
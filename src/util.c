@@ -2,19 +2,47 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAS_MMAP
+#endif
+
+// Reads all of `fp` into a string that's sized up front where that's possible
+static string_t readAll(FILE* fp) {
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+        rewind(fp);
+    }
+
+    string_t res = new_str(size > 0 ? (size_t)size : 100);
+
+    if (size > 0) {
+        res.len = fread(res.str, sizeof(char), (size_t)size, fp);
+    }
+
+    // pipes and the like have no size, and the file may have grown since
+    char buf[4096];
+    size_t count;
+    while ((count = fread(buf, sizeof(char), sizeof(buf), fp)) > 0) {
+        push_cstr_str(&res, buf, count);
+    }
+
+    return res;
+}
 
 string_t read_file_to_str(const char* path) {
     assert(path != NULL);
 
-    FILE* fp = fopen(path, "r");
+    FILE* fp = fopen(path, "rb");
 
     if (fp) {
-        string_t res = new_str(100);
-
-        char c;
-        while ((c = fgetc(fp)) != -1) {
-            push_str(&res, c);
-        }
+        string_t res = readAll(fp);
 
         fclose(fp);
 
@@ -24,6 +52,74 @@ string_t read_file_to_str(const char* path) {
     return new_str(0);
 }
 
+bool map_file(const char* path, MappedFile* file) {
+    assert(path != NULL);
+    assert(file != NULL);
+
+    *file = (MappedFile){.content = from_cstr_slice("", 0), .mapped_len = 0, .buffer = NULL};
+
+#ifdef HAS_MMAP
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        // mmap can't map zero bytes, an empty file is just an empty slice
+        if (st.st_size == 0) {
+            close(fd);
+            return true;
+        }
+
+        void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(mapped, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            close(fd);
+
+            file->mapped_len = (size_t)st.st_size;
+            file->content = from_cstr_slice((const char*)mapped, file->mapped_len);
+            return true;
+        }
+    }
+
+    close(fd);
+#endif
+
+    // not a regular file or it can't be mapped, so read it instead
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    string_t buffer = readAll(fp);
+    fclose(fp);
+
+    file->buffer = buffer.str;
+    if (buffer.len > 0) {
+        file->content = from_cstr_slice(buffer.str, buffer.len);
+    }
+
+    return true;
+}
+
+void unmap_file(MappedFile* file) {
+    if (file == NULL) {
+        return;
+    }
+
+#ifdef HAS_MMAP
+    if (file->mapped_len > 0) {
+        munmap((void*)file->content.str, file->mapped_len);
+    }
+#endif
+    free(file->buffer);
+
+    *file = (MappedFile){.content = from_cstr_slice("", 0), .mapped_len = 0, .buffer = NULL};
+}
+
 void write_file(const char* path, slice_t content) {
     assert(path != NULL);
     assert(content.str != NULL);
@@ -0,0 +1,119 @@
+#include "headers/watchpoints.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "headers/cpu.h"
+#include "headers/debug_info.h"
+
+#define WATCHED(map, idx) (((map)[(idx) >> 6] >> ((idx) & 63)) & 1)
+
+static inline uint8_t watchRead(CPU* cpu, uint16_t idx) {
+    Watchpoints* w = cpu->watchpoints;
+
+    if (WATCHED(w->reads, idx) && w->pending == 0) {
+        w->pending = WATCH_READ;
+        w->pending_addr = idx;
+        w->pending_old = MEMORY(idx);
+    }
+
+    return MEMORY(idx);
+}
+
+// Handlers can go through `MEMORY_W` more than once, like INC does, so only the first access of an
+// instruction is recorded. A write to an address that was read before still counts as a write.
+static inline uint8_t* watchWrite(CPU* cpu, uint16_t idx) {
+    Watchpoints* w = cpu->watchpoints;
+
+    if (WATCHED(w->writes, idx) && !(w->pending & WATCH_WRITE)) {
+        w->pending = WATCH_WRITE;
+        w->pending_addr = idx;
+        w->pending_old = MEMORY(idx);
+    }
+
+    return markDirty(cpu, idx);
+}
+
+// Builds a second copy of every handler in this translation unit, with the memory accesses going
+// through the shadow bitmaps
+#undef MEMORY_R
+#undef MEMORY_W
+#define MEMORY_R(idx) watchRead(cpu, (uint16_t)(idx))
+#define MEMORY_W(idx) (*watchWrite(cpu, (uint16_t)(idx)))
+
+#include "headers/instructions.h"
+
+static void setRange(uint64_t* map, uint16_t lo, uint16_t hi, bool watched) {
+    for (uint32_t i = lo; i <= hi; ++i) {
+        if (watched) {
+            map[i >> 6] |= 1ULL << (i & 63);
+        } else {
+            map[i >> 6] &= ~(1ULL << (i & 63));
+        }
+    }
+}
+
+void initWatchpoints(Watchpoints* w, WatchHandler on_hit, void* data) {
+    memset(w, 0, sizeof(Watchpoints));
+    w->on_hit = on_hit;
+    w->data = data;
+}
+
+void watchRange(Watchpoints* w, uint16_t lo, uint16_t hi, WatchKind kinds) {
+    if (kinds & WATCH_READ) setRange(w->reads, lo, hi, true);
+    if (kinds & WATCH_WRITE) setRange(w->writes, lo, hi, true);
+}
+
+void unwatchRange(Watchpoints* w, uint16_t lo, uint16_t hi, WatchKind kinds) {
+    if (kinds & WATCH_READ) setRange(w->reads, lo, hi, false);
+    if (kinds & WATCH_WRITE) setRange(w->writes, lo, hi, false);
+}
+
+int stepCpuWatched(CPU* cpu, Watchpoints* w) {
+    const uint16_t pc = PC;
+
+    cpu->watchpoints = w;
+    w->pending = 0;
+    OP_TABLE[MEMORY(PC)](cpu);
+
+    if (w->pending != 0) {
+        WatchHit hit = (WatchHit){.pc = pc,
+                                  .addr = w->pending_addr,
+                                  .kind = (WatchKind)w->pending,
+                                  .old_value = w->pending_old,
+                                  .new_value = MEMORY(w->pending_addr)};
+        w->on_hit(cpu, &hit, w->data);
+    }
+
+    const uint8_t op = MEMORY(PC);
+    return op == OP_BRK ? *programByte(cpu, PC) : op;
+}
+
+int runCpuWatched(CPU* cpu, Watchpoints* w) {
+    if (*programByte(cpu, PC) != OP_HALT) {
+        while (stepCpuWatched(cpu, w) != OP_HALT) {
+        }
+    }
+
+    cpu->watchpoints = NULL;
+
+    return 0;
+}
+
+void printWatchHit(CPU* cpu, const WatchHit* hit, void* data) {
+    UNUSED(cpu);
+    const DebugInfo* info = (const DebugInfo*)data;
+
+    if (hit->kind == WATCH_WRITE) {
+        printf("write 0x%02x -> 0x%02x at 0x%04x by ", hit->old_value, hit->new_value, hit->addr);
+    } else {
+        printf("read 0x%02x at 0x%04x by ", hit->old_value, hit->addr);
+    }
+    fprintSymbolized(stdout, &info->symbols, hit->pc);
+
+    const LineEntry* line = findLine(info, hit->pc);
+    if (line != NULL) {
+        printf(" (%.*s:%u)", (int)info->file.len, info->file.str, line->line);
+    }
+    printf("\n");
+}
@@ -0,0 +1,109 @@
+#include "../src/headers/arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/headers/ovec.h"
+#include "../src/headers/str_int_map.h"
+#include "greatest.h"
+
+TEST allocations_are_aligned_and_distinct(void) {
+    Arena* arena = newArena(256);
+
+    uint8_t* prev = NULL;
+    for (size_t size = 1; size < 1000; size += 37) {
+        uint8_t* ptr = arenaAlloc(arena, size);
+
+        ASSERT_EQ(0, (uintptr_t)ptr % ARENA_ALIGN);
+        memset(ptr, 0xAB, size);
+        if (prev != NULL) {
+            ASSERT(ptr != prev);
+        }
+        prev = ptr;
+    }
+
+    // bigger than any chunk so far
+    uint8_t* big = arenaCalloc(arena, 1, 100000);
+    ASSERT_EQ(0, big[0]);
+    ASSERT_EQ(0, big[99999]);
+
+    freeArena(arena);
+    PASS();
+}
+
+TEST grow_extends_the_last_allocation(void) {
+    Arena* arena = newArena(1024);
+
+    char* first = arenaAlloc(arena, 32);
+    strcpy(first, "first");
+    char* last = arenaAlloc(arena, 32);
+    strcpy(last, "last");
+
+    // there's room behind the last allocation, so it stays put
+    ASSERT_EQ(last, arenaGrow(arena, last, 32, 512));
+    ASSERT_STR_EQ("last", last);
+
+    // anything else gets copied
+    char* moved = arenaGrow(arena, first, 32, 64);
+    ASSERT(moved != first);
+    ASSERT_STR_EQ("first", moved);
+
+    // as does the last allocation once its chunk is full
+    char* full = arenaGrow(arena, moved, 64, 4096);
+    ASSERT(full != moved);
+    ASSERT_STR_EQ("first", full);
+
+    freeArena(arena);
+    PASS();
+}
+
+TEST vec_in_arena(void) {
+    Arena* arena = newArena(64);
+    vec_t vec = new_vec_in(arena, 1, sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < 10000; ++i) {
+        push_vec(&vec, &i);
+    }
+    for (uint32_t i = 0; i < 10000; ++i) {
+        ASSERT_EQ(i, CAST(get_vec(&vec, i), uint32_t));
+    }
+
+    // the memory belongs to the arena, so this must not free it
+    free_vec(&vec, NULL);
+    freeArena(arena);
+    PASS();
+}
+
+TEST map_in_arena(void) {
+    Arena* arena = newArena(64);
+    si_map_t map = new_map_in(arena, 0);
+    // keys are borrowed, so they need to stay around
+    static char keys[1000][16];
+    char key[16];
+
+    for (size_t i = 0; i < 1000; ++i) {
+        snprintf(keys[i], sizeof(keys[i]), "label_%zu", i);
+        ASSERT(insert_map(&map, from_cstr_slice(keys[i], strlen(keys[i])), i));
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "label_%zu", i);
+        size_t* value = get_map(&map, from_cstr_slice(key, strlen(key)));
+        ASSERT(value != NULL);
+        ASSERT_EQ(i, *value);
+    }
+
+    ASSERT(remove_map(&map, static_slice("label_7")));
+    ASSERT_FALSE(insert_map(&map, static_slice("label_8"), 0));
+
+    free_map(&map);
+    freeArena(arena);
+    PASS();
+}
+
+SUITE(ARENA_SUITE) {
+    RUN_TEST(allocations_are_aligned_and_distinct);
+    RUN_TEST(grow_extends_the_last_allocation);
+    RUN_TEST(vec_in_arena);
+    RUN_TEST(map_in_arena);
+}
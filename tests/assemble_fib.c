@@ -1,3 +1,7 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "../src/headers/assembler.h"
 #include "../src/headers/instructions.h"
 #include "../src/headers/util.h"
@@ -49,9 +53,10 @@ TEST assemble_fibonacci(void) {
 
     const char* path = "./programs/fibonacci.casm";
 
-    string_t program = read_file_to_str(path);
+    MappedFile program;
+    ASSERT(map_file(path, &program));
 
-    const Executable exec = assemble(from_str_slice(program), from_cstr_slice(path, strlen(path)));
+    Executable exec = assemble(program.content, from_cstr_slice(path, strlen(path)));
 
     // load compiled assembly into cpu1
     loadProgram(&cpu1, exec.executable, exec.size);
@@ -70,7 +75,55 @@ TEST assemble_fibonacci(void) {
         ASSERT(cpus_eq(&cpu1, &cpu2));
     }
 
+    free(exec2.executable);
+    freeExecutable(&exec);
+    unmap_file(&program);
+    freeCpu(&cpu1);
+    freeCpu(&cpu2);
+    PASS();
+}
+
+TEST map_file_matches_read(void) {
+    const char* path = "./programs/fibonacci.casm";
+
+    MappedFile mapped;
+    ASSERT(map_file(path, &mapped));
+    string_t read = read_file_to_str(path);
+
+    ASSERT(mapped.content.len > 0);
+    ASSERT_EQ(read.len, mapped.content.len);
+    ASSERT_MEM_EQ(read.str, mapped.content.str, read.len);
+
+    unmap_file(&mapped);
+    free_str(&read);
     PASS();
 }
 
-SUITE(ASSEMBLE_FIB_SUITE) { RUN_TEST(assemble_fibonacci); }
+TEST map_file_missing_and_empty(void) {
+    MappedFile file;
+    ASSERT_FALSE(map_file("./programs/does_not_exist.casm", &file));
+
+    char path[] = "/tmp/vm-empty-source-XXXXXX";
+    const int fd = mkstemp(path);
+    ASSERT(fd >= 0);
+    close(fd);
+
+    ASSERT(map_file(path, &file));
+    ASSERT_EQ(0, file.content.len);
+
+    // an empty program assembles to just the HALT that ends every program
+    Executable exec = assemble(file.content, static_slice("empty"));
+    ASSERT_EQ(PROGRAM_START + 1, exec.size);
+    ASSERT_EQ(OP_HALT, exec.executable[PROGRAM_START]);
+
+    freeExecutable(&exec);
+    unmap_file(&file);
+    remove(path);
+    PASS();
+}
+
+SUITE(ASSEMBLE_FIB_SUITE) {
+    RUN_TEST(assemble_fibonacci);
+    RUN_TEST(map_file_matches_read);
+    RUN_TEST(map_file_missing_and_empty);
+}
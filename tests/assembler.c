@@ -0,0 +1,439 @@
+#include "../src/headers/assembler.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/headers/errors.h"
+#include "../src/headers/util.h"
+#include "greatest.h"
+
+#define THREADS 8
+#define MODULES 256
+#define MODULE_SRC_SIZE 256
+
+// every fifth module jumps to a label that's never defined
+static void moduleSource(size_t module, char* src) {
+    snprintf(src, MODULE_SRC_SIZE,
+             "start:\n"
+             "    LOAD %zu\n"
+             "    STORE R0\n"
+             "loop:\n"
+             "    DEC R0\n"
+             "    JNZ .loop\n"
+             "    CALL .func\n"
+             "    %s\n"
+             "func:\n"
+             "    ADD data[%zu]\n"
+             "    RET\n"
+             "data:\n"
+             "    %zu %zu\n",
+             module % 200 + 1, module % 5 == 0 ? "JMP .missing" : "HALT", module % 2,
+             module % 256, (module * 7) % 256);
+}
+
+typedef struct ModuleResult {
+    uint8_t bytes[MODULE_SRC_SIZE];
+    size_t size;
+    size_t errors;
+    // substr of the first diagnostic, empty without any
+    char first_token[16];
+} ModuleResult;
+
+static void assembleModule(size_t module, ModuleResult* result) {
+    char src[MODULE_SRC_SIZE];
+    moduleSource(module, src);
+
+    Executable exec = assemble(from_cstr_slice(src, strlen(src)), static_slice("module"));
+
+    result->size = min(exec.size - PROGRAM_START, sizeof(result->bytes));
+    memcpy(result->bytes, exec.executable + PROGRAM_START, result->size);
+    result->errors = countErrors(&exec.diagnostics);
+    result->first_token[0] = '\0';
+    if (len_vec(&exec.diagnostics) > 0) {
+        const Diagnostic* diag = first_vec(&exec.diagnostics);
+        snprintf(result->first_token, sizeof(result->first_token), "%.*s",
+                 (int)diag->token.substr.len, diag->token.substr.str);
+    }
+
+    freeExecutable(&exec);
+}
+
+typedef struct Worker {
+    size_t first;
+    ModuleResult* results;
+} Worker;
+
+// Each worker takes every THREADS-th module, so all of them are busy at the same time
+static void* assembleModules(void* data) {
+    Worker* worker = (Worker*)data;
+    for (size_t m = worker->first; m < MODULES; m += THREADS) {
+        assembleModule(m, &worker->results[m]);
+    }
+    return NULL;
+}
+
+TEST assembles_modules_in_parallel(void) {
+    static ModuleResult expected[MODULES];
+    static ModuleResult parallel[MODULES];
+
+    for (size_t m = 0; m < MODULES; ++m) {
+        assembleModule(m, &expected[m]);
+    }
+
+    pthread_t threads[THREADS];
+    Worker workers[THREADS];
+    for (size_t t = 0; t < THREADS; ++t) {
+        workers[t] = (Worker){.first = t, .results = parallel};
+        ASSERT_EQ(0, pthread_create(&threads[t], NULL, assembleModules, &workers[t]));
+    }
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    for (size_t m = 0; m < MODULES; ++m) {
+        ASSERT_EQ(expected[m].size, parallel[m].size);
+        ASSERT_MEM_EQ(expected[m].bytes, parallel[m].bytes, expected[m].size);
+        ASSERT_EQ(m % 5 == 0 ? 1 : 0, parallel[m].errors);
+        ASSERT_STR_EQ(m % 5 == 0 ? "missing" : "", parallel[m].first_token);
+    }
+
+    PASS();
+}
+
+TEST diagnostics_are_returned(void) {
+    const char* src =
+        "LOAD 1\n"
+        "FOO\n"
+        "\n"
+        "300\n"
+        "JMP .nowhere\n";
+
+    Executable exec = assemble(from_cstr_slice(src, strlen(src)), static_slice("diagnostics"));
+
+    // pass 1 reports in source order, undefined labels only come up in pass 2
+    ASSERT_EQ(3, len_vec(&exec.diagnostics));
+    ASSERT_EQ(2, countErrors(&exec.diagnostics));
+
+    const Diagnostic* unknown = get_vec(&exec.diagnostics, 0);
+    ASSERT_EQ(ERROR_SEVERITY, unknown->severity);
+    ASSERT_EQ(UNKNOWN_TOKEN_E, unknown->error);
+    ASSERT_EQ(2, unknown->line_nr);
+    ASSERT_MEM_EQ("FOO", unknown->line.str, unknown->line.len);
+
+    const Diagnostic* overflow = get_vec(&exec.diagnostics, 1);
+    ASSERT_EQ(WARNING_SEVERITY, overflow->severity);
+    ASSERT_EQ(U8_OVERFLOW_W, overflow->warning);
+    ASSERT_EQ(4, overflow->line_nr);
+
+    const Diagnostic* undefined = get_vec(&exec.diagnostics, 2);
+    ASSERT_EQ(UNDEFINED_LABEL_E, undefined->error);
+    ASSERT_EQ(5, undefined->line_nr);
+    ASSERT_EQ(strlen("nowhere"), undefined->token.substr.len);
+    ASSERT_MEM_EQ("nowhere", undefined->token.substr.str, undefined->token.substr.len);
+
+    freeExecutable(&exec);
+    PASS();
+}
+
+// Labels used before, after and across every split, repeated definitions, a blank line and
+// a few errors and warnings
+static const char* chunked_src =
+    "; chunks start all over this\n"
+    ".far = 0x8000\n"
+    "start:\n"
+    "    LOAD 3\n"
+    "    STORE R0\n"
+    "\n"
+    "loop:\n"
+    "    CALL .helper\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    "    STORE far[1]\n"
+    "    LOAD table[HL]\n"
+    "    JMP .done\n"
+    "   \n"
+    "helper:\n"
+    "    ADD table[2]\n"
+    "    FOO\n"
+    "    RET\n"
+    "loop:\n"
+    "    500\n"
+    "    JMP .nowhere\n"
+    "table:\n"
+    "    1 2 3 4 \"text\"\n"
+    ".far = 0x9000\n"
+    "done:\n"
+    "    JMP .start\n"
+    "HALT\n";
+
+static enum greatest_test_res sameExecutable(const Executable* expected, const Executable* got) {
+    ASSERT_EQ(expected->size, got->size);
+    ASSERT_MEM_EQ(expected->executable, got->executable, expected->size);
+
+    ASSERT_EQ(len_map(&expected->labels), len_map(&got->labels));
+    si_map_iter_t iter = iter_from_map(&expected->labels);
+    si_kv label;
+    while ((label = map_iter_next(&iter)).key.str != NULL) {
+        const size_t* addr = get_map(&got->labels, label.key);
+        ASSERT(addr != NULL);
+        ASSERT_EQ(label.value, *addr);
+    }
+
+    const vec_t* lines = &expected->debug_info.lines;
+    ASSERT_EQ(len_vec(lines), len_vec(&got->debug_info.lines));
+    for (size_t i = 0; i < len_vec(lines); ++i) {
+        const LineEntry* want = get_vec(lines, i);
+        const LineEntry* have = get_vec(&got->debug_info.lines, i);
+        ASSERT_EQ(want->addr, have->addr);
+        ASSERT_EQ(want->line, have->line);
+        ASSERT_EQ(want->column, have->column);
+    }
+
+    ASSERT_EQ(len_vec(&expected->diagnostics), len_vec(&got->diagnostics));
+    for (size_t i = 0; i < len_vec(&expected->diagnostics); ++i) {
+        const Diagnostic* want = get_vec(&expected->diagnostics, i);
+        const Diagnostic* have = get_vec(&got->diagnostics, i);
+        ASSERT_EQ(want->severity, have->severity);
+        ASSERT_EQ(want->error, have->error);
+        ASSERT_EQ(want->line_nr, have->line_nr);
+        ASSERT_EQ(want->token.substr.str, have->token.substr.str);
+        ASSERT_EQ(want->token.char_nr, have->token.char_nr);
+        ASSERT_EQ(want->line.str, have->line.str);
+    }
+
+    PASS();
+}
+
+TEST chunks_match_one_piece(void) {
+    const slice_t src = from_cstr_slice(chunked_src, strlen(chunked_src));
+    Executable expected = assembleInChunks(src, static_slice("chunked"), 1, NULL, NULL);
+
+    ASSERT_EQ(2, countErrors(&expected.diagnostics));
+
+    for (size_t chunks = 2; chunks <= 40; ++chunks) {
+        Executable got = assembleInChunks(src, static_slice("chunked"), chunks, NULL, NULL);
+        CHECK_CALL(sameExecutable(&expected, &got));
+        freeExecutable(&got);
+    }
+
+    freeExecutable(&expected);
+    PASS();
+}
+
+TEST chunks_stop_at_nul(void) {
+    const char src[] = "LOAD 1\nJMP .after\nHALT\n\0after:\nJMP .after\nADD 2\n";
+    const slice_t program = from_cstr_slice(src, sizeof(src) - 1);
+    Executable expected = assembleInChunks(program, static_slice("nul"), 1, NULL, NULL);
+
+    ASSERT_EQ(1, countErrors(&expected.diagnostics));
+
+    for (size_t chunks = 2; chunks <= 8; ++chunks) {
+        Executable got = assembleInChunks(program, static_slice("nul"), chunks, NULL, NULL);
+        CHECK_CALL(sameExecutable(&expected, &got));
+        freeExecutable(&got);
+    }
+
+    freeExecutable(&expected);
+    PASS();
+}
+
+// Strings that span lines, with newlines, comments and code inside them, so the chunks get split
+// in the middle of a string
+static const char* quoted_src =
+    "start:\n"
+    "    LOAD 1\n"
+    "    JMP .end\n"
+    "text:\n"
+    "    \"spans\n"
+    "FOO ; not a comment\n"
+    "  LOAD 5\n"
+    "\" 7\n"
+    "    \"short\"\n"
+    "more:\n"
+    "    \"two\n"
+    "lines\" \"and\n"
+    "\n"
+    "\"\n"
+    "end:\n"
+    "    JMP .more\n"
+    "HALT\n";
+
+TEST chunks_split_outside_strings(void) {
+    const slice_t src = from_cstr_slice(quoted_src, strlen(quoted_src));
+    Executable expected = assembleInChunks(src, static_slice("quoted"), 1, NULL, NULL);
+
+    ASSERT_EQ(0, len_vec(&expected.diagnostics));
+
+    for (size_t chunks = 2; chunks <= 40; ++chunks) {
+        Executable got = assembleInChunks(src, static_slice("quoted"), chunks, NULL, NULL);
+        CHECK_CALL(sameExecutable(&expected, &got));
+        freeExecutable(&got);
+    }
+
+    freeExecutable(&expected);
+    PASS();
+}
+
+TEST chunks_read_past_nul_in_a_line(void) {
+    // the NULs in the string and in the unknown token don't end the source, the one at the start
+    // of a line does
+    const char src[] = "LOAD 1\n    \"a\0b\" 2\nA\0\nafter:\nJMP .after\n\0ADD 2\n";
+    const slice_t program = from_cstr_slice(src, sizeof(src) - 1);
+    Executable expected = assembleInChunks(program, static_slice("nul"), 1, NULL, NULL);
+
+    ASSERT(get_map(&expected.labels, static_slice("after")) != NULL);
+
+    for (size_t chunks = 2; chunks <= 8; ++chunks) {
+        Executable got = assembleInChunks(program, static_slice("nul"), chunks, NULL, NULL);
+        CHECK_CALL(sameExecutable(&expected, &got));
+        freeExecutable(&got);
+    }
+
+    freeExecutable(&expected);
+    PASS();
+}
+
+#define SESSION_LINES 6000
+
+// Label names can't have digits in them, so the number is spelled out in letters
+static void spellNumber(size_t n, char* name) {
+    size_t len = 0;
+    do {
+        name[len++] = (char)('a' + n % 26);
+        n /= 26;
+    } while (n > 0);
+    name[len] = '\0';
+}
+
+// A few hundred KB of functions calling each other, long enough for a session to split it up
+static string_t sessionSource(void) {
+    string_t src = new_str(SESSION_LINES * 16);
+    char line[64];
+    char name[16];
+    char callee[16];
+
+    for (size_t i = 0; i < SESSION_LINES / 4; ++i) {
+        spellNumber(i, name);
+        spellNumber((i * 7 + 3) % (SESSION_LINES / 4), callee);
+        const int len = snprintf(line, sizeof(line), "f%s:\n    ADD %zu\n    CALL .f%s\n    RET\n",
+                                 name, i % 256, callee);
+        push_cstr_str(&src, line, (size_t)len);
+    }
+
+    return src;
+}
+
+static void replaceText(string_t* src, const char* find, const char* with) {
+    const char* at = strstr(src->str, find);
+    const size_t offset = (size_t)(at - src->str);
+    string_t edited = new_str(src->len + strlen(with));
+
+    push_cstr_str(&edited, src->str, offset);
+    push_cstr_str(&edited, with, strlen(with));
+    push_cstr_str(&edited, at + strlen(find), src->len - offset - strlen(find));
+    free_str(src);
+    *src = edited;
+}
+
+// Reassembles a copy of `src` that's freed right after, the session can't hold on to it
+static enum greatest_test_res sameAsAssemble(AssemblySession* session, const string_t* src) {
+    char* copy = malloc(src->len);
+    memcpy(copy, src->str, src->len);
+    const slice_t program = from_cstr_slice(copy, src->len);
+
+    Executable expected = assemble(program, static_slice("session"));
+    Executable got = reassemble(session, program);
+    CHECK_CALL(sameExecutable(&expected, &got));
+
+    freeExecutable(&expected);
+    freeExecutable(&got);
+    free(copy);
+    PASS();
+}
+
+TEST session_matches_assemble(void) {
+    string_t src = sessionSource();
+    AssemblySession session;
+    initAssemblySession(&session, static_slice("session"));
+
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    // nothing changed
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // an immediate in the middle, then a new label used from the first line
+    replaceText(&src, "ADD 77\n", "ADD 78\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    replaceText(&src, "fbcb:\n", "fbcb:\nnew:\n    JMP .fbcb\n");
+    replaceText(&src, "fa:\n", "fa:\n    CALL .new\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // a deleted line, then the last line changed and one more added without a newline
+    replaceText(&src, "    ADD 200\n", "");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    src.len -= strlen("RET\n");
+    push_cstr_str(&src, "HALT\n    JMP .fa", strlen("HALT\n    JMP .fa"));
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // an error that gets fixed again, and a label defined twice
+    replaceText(&src, "CALL .fbcb\n", "CALL .fbcb\n    FOO\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    replaceText(&src, "    FOO\n", "fa:\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // an empty source and back
+    string_t empty = new_str(1);
+    CHECK_CALL(sameAsAssemble(&session, &empty));
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    free_str(&empty);
+    free_str(&src);
+    freeAssemblySession(&session);
+    PASS();
+}
+
+TEST session_follows_quotes_and_nuls(void) {
+    string_t src = sessionSource();
+    AssemblySession session;
+    initAssemblySession(&session, static_slice("session"));
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // a quote opened near the start takes every later line into the string, and closing it
+    // somewhere else gives them back, neither changes the bytes of the chunks after the edit
+    replaceText(&src, "    ADD 5\n", "    \"ADD 5\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    replaceText(&src, "    ADD 250\n", "    ADD 250\"\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    replaceText(&src, "    \"ADD 5\n", "    ADD 5\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    replaceText(&src, "    ADD 250\"\n", "    ADD 250\n");
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    // a NUL in a string is read past, one at the start of a line ends the source until it's gone
+    replaceText(&src, "    ADD 9\n", "    \"a_\"\n");
+    replaceText(&src, "    ADD 99\n", "_   ADD 99\n");
+    char* in_string = strstr(src.str, "a_\"") + 1;
+    char* line_start = strstr(src.str, "_   ADD 99\n");
+    *in_string = '\0';
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    *line_start = '\0';
+    CHECK_CALL(sameAsAssemble(&session, &src));
+    *line_start = ' ';
+    CHECK_CALL(sameAsAssemble(&session, &src));
+
+    free_str(&src);
+    freeAssemblySession(&session);
+    PASS();
+}
+
+SUITE(ASSEMBLER_SUITE) {
+    RUN_TEST(assembles_modules_in_parallel);
+    RUN_TEST(diagnostics_are_returned);
+    RUN_TEST(chunks_match_one_piece);
+    RUN_TEST(chunks_stop_at_nul);
+    RUN_TEST(chunks_split_outside_strings);
+    RUN_TEST(chunks_read_past_nul_in_a_line);
+    RUN_TEST(session_matches_assemble);
+    RUN_TEST(session_follows_quotes_and_nuls);
+}
@@ -0,0 +1,145 @@
+#include "../src/headers/breakpoints.h"
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* loop_src =
+    "    LOAD 5\n"
+    "    STORE R0\n"
+    "loop:\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    "    LOAD 42\n"
+    "HALT\n";
+
+typedef struct Hits {
+    size_t count;
+    uint16_t last;
+    uint8_t r0;
+} Hits;
+
+static bool countHit(CPU* cpu, uint16_t addr, void* data) {
+    Hits* hits = (Hits*)data;
+    hits->count++;
+    hits->last = addr;
+    hits->r0 = cpu->registers.reg_0;
+    return true;
+}
+
+TEST breakpoint_hits_every_pass(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+    const uint16_t loop = (uint16_t)*get_map(&exec.labels, static_slice("loop"));
+
+    Hits hits = {0};
+    Breakpoints bps;
+    initBreakpoints(&bps, countHit, &hits);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    cpu.breakpoints = &bps;
+
+    ASSERT(setBreakpoint(&cpu, loop));
+    ASSERT_FALSE(setBreakpoint(&cpu, loop));
+    ASSERT_EQ(OP_BRK, cpu.memory[loop]);
+
+    runCpu(&cpu);
+
+    ASSERT_EQ(5, hits.count);
+    ASSERT_EQ(loop, hits.last);
+    // the handler runs before the DEC it replaced
+    ASSERT_EQ(1, hits.r0);
+    ASSERT_EQ(0, cpu.registers.reg_0);
+    ASSERT_EQ(42, cpu.accumulator);
+
+    freeCpu(&cpu);
+    freeBreakpoints(&bps);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST cleared_breakpoint_restores_program(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+    const uint16_t loop = (uint16_t)*get_map(&exec.labels, static_slice("loop"));
+
+    Hits hits = {0};
+    Breakpoints bps;
+    initBreakpoints(&bps, countHit, &hits);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    cpu.breakpoints = &bps;
+
+    ASSERT(setBreakpoint(&cpu, loop));
+    ASSERT(clearBreakpoint(&cpu, loop));
+    ASSERT_FALSE(clearBreakpoint(&cpu, loop));
+    ASSERT_MEM_EQ(exec.executable + PROGRAM_START, cpu.memory + PROGRAM_START,
+                  exec.size - PROGRAM_START);
+
+    runCpu(&cpu);
+
+    ASSERT_EQ(0, hits.count);
+    ASSERT_EQ(42, cpu.accumulator);
+
+    freeCpu(&cpu);
+    freeBreakpoints(&bps);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST stray_brk_is_skipped(void) {
+    CPU cpu;
+    initCpu(&cpu);
+
+    cpu.memory[PROGRAM_START] = OP_BRK;
+    cpu.memory[PROGRAM_START + 1] = OP_HALT;
+
+    ASSERT_EQ(OP_HALT, stepCpu(&cpu));
+    ASSERT_EQ(PROGRAM_START + 1, cpu.program_counter);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST breakpoint_on_final_halt_ends_the_run(void) {
+    const char* src = "    LOAD 42\nend:\nHALT\n";
+    Executable exec = assemble(from_cstr_slice(src, strlen(src)), static_slice("halt"));
+    const uint16_t end = (uint16_t)*get_map(&exec.labels, static_slice("end"));
+
+    Hits hits = {0};
+    Breakpoints bps;
+    initBreakpoints(&bps, countHit, &hits);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    cpu.breakpoints = &bps;
+    ASSERT(setBreakpoint(&cpu, end));
+
+    // the HALT under the breakpoint doesn't move PC, so the run has to see through the BRK and end
+    // right before it like it does without a breakpoint
+    runCpu(&cpu);
+
+    ASSERT_EQ(0, hits.count);
+    ASSERT_EQ(end, cpu.program_counter);
+    ASSERT_EQ(42, cpu.accumulator);
+
+    freeCpu(&cpu);
+    freeBreakpoints(&bps);
+    freeExecutable(&exec);
+    PASS();
+}
+
+SUITE(BREAKPOINTS_SUITE) {
+    RUN_TEST(breakpoint_hits_every_pass);
+    RUN_TEST(cleared_breakpoint_restores_program);
+    RUN_TEST(stray_brk_is_skipped);
+    RUN_TEST(breakpoint_on_final_halt_ends_the_run);
+}
@@ -0,0 +1,64 @@
+#include "../src/headers/callgraph.h"
+
+#include <stdio.h>
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* calls_src =
+    "main:\n"
+    "    CALL .outer\n"
+    "    CALL .leaf\n"
+    "HALT\n"
+    "outer:\n"
+    "    CALL .leaf\n"
+    "    PUSH 0\n"
+    "    CALL .pops\n"
+    "    RET\n"
+    "leaf:\n"
+    "    NOOP\n"
+    "    RET\n"
+    "pops:\n"
+    "    RET 1\n";
+
+TEST callgraph_folded_stacks(void) {
+    const char* path = "calls";
+    Executable exec = assemble(from_cstr_slice(calls_src, strlen(calls_src)), static_slice(path));
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+
+    CallGraph graph;
+    initCallGraph(&graph, PROGRAM_START);
+    runCpuCallGraph(&cpu, &graph, NULL);
+
+    // back at the root after returning from everything
+    ASSERT_EQ(1, graph.depth);
+    // root, outer, outer;leaf, outer;pops and leaf
+    ASSERT_EQ(5, graph.nodes.len);
+
+    char folded[512] = {0};
+    FILE* out = tmpfile();
+    ASSERT(out != NULL);
+    writeFoldedStacks(&graph, &exec.debug_info, out);
+    rewind(out);
+    size_t len = fread(folded, 1, sizeof(folded) - 1, out);
+    fclose(out);
+
+    ASSERT(len > 0);
+    ASSERT(strstr(folded, "main 2\n") != NULL);
+    ASSERT(strstr(folded, "main;outer 4\n") != NULL);
+    ASSERT(strstr(folded, "main;outer;leaf 2\n") != NULL);
+    ASSERT(strstr(folded, "main;outer;pops 1\n") != NULL);
+    ASSERT(strstr(folded, "main;leaf 2\n") != NULL);
+
+    freeCallGraph(&graph);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+SUITE(CALLGRAPH_SUITE) { RUN_TEST(callgraph_folded_stacks); }
@@ -0,0 +1,113 @@
+#include "../src/headers/cpu_pool.h"
+
+#include <string.h>
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+// Writes to two pages far away from the program and then halts
+static const char* scribble_src =
+    "    LOAD 0x42\n"
+    "    STORE far[0]\n"
+    "    STORE far[1]\n"
+    "    LOAD 0x40\n"
+    "    STORE H\n"
+    "    LOAD 0x10\n"
+    "    STORE L\n"
+    "    LOAD 7\n"
+    "    STORE (HL)\n"
+    "    INC (HL)\n"
+    "HALT\n"
+    ".far = 0x8000\n";
+
+static bool memoryMatches(const CPU* cpu, const uint8_t* image) {
+    return memcmp(cpu->memory, image, MEMORY_SIZE) == 0;
+}
+
+TEST cpu_pool_alignment(void) {
+    const uint8_t program[PROGRAM_START + 1] = {[PROGRAM_START] = OP_HALT};
+
+    CpuPool pool;
+    initCpuPool(&pool, 4, program, sizeof(program), true);
+
+    CPU* cpus[4];
+    for (size_t i = 0; i < 4; ++i) {
+        cpus[i] = acquireCpu(&pool);
+        ASSERT(cpus[i] != NULL);
+        ASSERT_EQ(0, (size_t)cpus[i] % CPU_ALIGN);
+        ASSERT_EQ(0, (size_t)cpus[i]->memory % CPU_ALIGN);
+        ASSERT_EQ(OP_HALT, cpus[i]->memory[PROGRAM_START]);
+    }
+    ASSERT_EQ(NULL, acquireCpu(&pool));
+
+    releaseCpu(&pool, cpus[2]);
+    ASSERT_EQ(cpus[2], acquireCpu(&pool));
+
+    freeCpuPool(&pool);
+
+    PASS();
+}
+
+TEST cpu_pool_reset_restores_baseline(void) {
+    const char* path = "scribble";
+    Executable exec =
+        assemble(from_cstr_slice(scribble_src, strlen(scribble_src)), static_slice(path));
+
+    CpuPool pool;
+    initCpuPool(&pool, 2, exec.executable, exec.size, false);
+
+    CPU* cpu = acquireCpu(&pool);
+    ASSERT(memoryMatches(cpu, pool.baseline));
+
+    runCpu(cpu);
+    ASSERT_EQ(0x42, MEMORY(0x8001));
+    ASSERT_EQ(8, MEMORY(0x4010));
+
+    // only the two pages that were written to are marked
+    size_t dirty_pages = 0;
+    for (size_t i = 0; i < DIRTY_WORDS; ++i) {
+        dirty_pages += (size_t)__builtin_popcountll(cpu->dirty[i]);
+    }
+    ASSERT_EQ(2, dirty_pages);
+
+    releaseCpu(&pool, cpu);
+    cpu = acquireCpu(&pool);
+
+    ASSERT(memoryMatches(cpu, pool.baseline));
+    ASSERT_EQ(PROGRAM_START, PC);
+    ASSERT_EQ(0, ACC);
+
+    freeCpuPool(&pool);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST reset_without_baseline_clears_memory(void) {
+    const uint8_t program[] = {OP_LOAD_I, 9, OP_STORE_IM, 0x12, 0x34, OP_RESET};
+    const uint8_t zeroes[MEMORY_SIZE] = {0};
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, program, sizeof(program));
+    cpu.program_counter = 0;
+
+    stepCpu(&cpu);
+    stepCpu(&cpu);
+    ASSERT_EQ(9, cpu.memory[0x1234]);
+    stepCpu(&cpu);
+
+    ASSERT(memoryMatches(&cpu, zeroes));
+    ASSERT_EQ(PROGRAM_START, cpu.program_counter);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+SUITE(CPU_POOL_SUITE) {
+    RUN_TEST(cpu_pool_alignment);
+    RUN_TEST(cpu_pool_reset_restores_baseline);
+    RUN_TEST(reset_without_baseline_clears_memory);
+}
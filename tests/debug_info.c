@@ -0,0 +1,85 @@
+#include "../src/headers/debug_info.h"
+
+#include <stdio.h>
+
+#include "../src/headers/assembler.h"
+#include "greatest.h"
+
+static const char* lines_src =
+    "; comment\n"
+    "    LOAD 5\n"
+    "\n"
+    "loop:\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    ".video = 0x9fff\n";
+
+TEST debug_info_line_table(void) {
+    const char* path = "lines.casm";
+    Executable exec = assemble(from_cstr_slice(lines_src, strlen(lines_src)), static_slice(path));
+    const DebugInfo* info = &exec.debug_info;
+
+    ASSERT(eq_cstr(&info->file, path, strlen(path)));
+    ASSERT_EQ(NULL, findLine(info, PROGRAM_START - 1));
+
+    // LOAD 5
+    ASSERT_EQ(2, findLine(info, PROGRAM_START)->line);
+    ASSERT_EQ(5, findLine(info, PROGRAM_START)->column);
+    ASSERT_EQ(2, findLine(info, PROGRAM_START + 1)->line);
+    // the label itself doesn't take up any bytes
+    ASSERT_EQ(5, findLine(info, PROGRAM_START + 2)->line);
+    ASSERT_EQ(6, findLine(info, PROGRAM_START + 3)->line);
+    // appended HALT, and everything after it
+    ASSERT_EQ(0, findLine(info, (uint16_t)(exec.size - 1))->line);
+    ASSERT_EQ(0, findLine(info, 0x9fff)->line);
+
+    ASSERT_EQ(1, info->symbols.symbols.len);
+    ASSERT_EQ(PROGRAM_START + 2, findSymbol(&info->symbols, PROGRAM_START + 3)->addr);
+
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST debug_info_sidecar_roundtrip(void) {
+    const char* path = "lines.casm";
+    Executable exec = assemble(from_cstr_slice(lines_src, strlen(lines_src)), static_slice(path));
+    const DebugInfo* info = &exec.debug_info;
+
+    char sidecar[] = "/tmp/vm-debug-info-XXXXXX";
+    FILE* tmp = fdopen(mkstemp(sidecar), "w");
+    ASSERT(tmp != NULL);
+    fclose(tmp);
+
+    ASSERT(writeDebugInfo(info, sidecar));
+
+    DebugInfo read;
+    ASSERT(readDebugInfo(&read, sidecar));
+
+    ASSERT(eq_cstr(&read.file, path, strlen(path)));
+    ASSERT_EQ(info->lines.len, read.lines.len);
+    ASSERT_MEM_EQ(info->lines.ptr, read.lines.ptr, info->lines.len * sizeof(LineEntry));
+    ASSERT_EQ(info->symbols.symbols.len, read.symbols.symbols.len);
+
+    const Symbol* sym = findSymbol(&read.symbols, PROGRAM_START + 2);
+    ASSERT(sym != NULL);
+    ASSERT(eq_cstr_slice(sym->name, "loop", 4));
+
+    freeDebugInfo(&read);
+
+    // anything else is rejected
+    FILE* fp = fopen(sidecar, "wb");
+    fputs("not debug info", fp);
+    fclose(fp);
+    ASSERT_FALSE(readDebugInfo(&read, sidecar));
+
+    remove(sidecar);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+SUITE(DEBUG_INFO_SUITE) {
+    RUN_TEST(debug_info_line_table);
+    RUN_TEST(debug_info_sidecar_roundtrip);
+}
@@ -0,0 +1,618 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/headers/debug.h"
+#include "../src/headers/instructions.h"
+#include "../src/headers/lockstep.h"
+#include "../src/headers/opcodes.h"
+#include "../src/headers/watchpoints.h"
+#include "greatest.h"
+
+// Generated instructions per program, followed by a JMP back to the start
+#define DIFF_INSTRUCTIONS 48
+#define DIFF_PROGRAM_SIZE (DIFF_INSTRUCTIONS * MAX_OPCODE_LENGTH + 3)
+#define DIFF_STEPS 512
+// Instructions every engine runs between two comparisons
+#define DIFF_BLOCK 32
+// Both can be overridden with the DIFF_CASES and DIFF_SEED environment variables
+#define DIFF_CASES 256
+#define DIFF_SEED 0x5eed
+
+/// Everything the engines are compared on. Memory is compared through a hash since it's too large
+/// to compare after every block.
+typedef struct DiffState {
+    uint16_t pc;
+    uint8_t acc;
+    uint8_t r0;
+    uint8_t r1;
+    uint8_t h;
+    uint8_t l;
+    Flags flags;
+    uint8_t sp;
+    uint8_t bp;
+    uint8_t stack[STACK_SIZE];
+    uint64_t memory_hash;
+} DiffState;
+
+/// A random program together with the state it starts from
+typedef struct DiffCase {
+    uint64_t seed;
+    // memory_hash is unused
+    DiffState start;
+    // memory below the program, where ML reads and writes land
+    uint8_t data[PROGRAM_START];
+    uint8_t program[DIFF_PROGRAM_SIZE];
+    size_t program_size;
+    size_t steps;
+} DiffCase;
+
+/// One way of executing instructions. Every engine has to end up in exactly the same state as the
+/// first one in its list after every instruction.
+typedef struct Engine {
+    const char* name;
+    void (*load)(const DiffCase* c);
+    // Runs a single instruction, returns false without running it if it can't be tested
+    bool (*step)(void);
+    void (*snapshot)(DiffState* s);
+} Engine;
+
+typedef struct Divergence {
+    const Engine* engine;
+    // instructions the reference ran before the states differed
+    size_t step;
+    DiffState expected;
+    DiffState got;
+} Divergence;
+
+static uint64_t nextRandom(uint64_t* state) {
+    // splitmix64
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t hashMemory(const uint8_t* memory) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < MEMORY_SIZE; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &memory[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static void snapshotCpu(const CPU* cpu, DiffState* s) {
+    *s = (DiffState){.pc = PC,
+                     .acc = ACC,
+                     .r0 = R0,
+                     .r1 = R1,
+                     .h = H,
+                     .l = L,
+                     .flags = FLAGS,
+                     .sp = SP,
+                     .bp = BP,
+                     .memory_hash = hashMemory(cpu->memory)};
+    memcpy(s->stack, cpu->stack, STACK_SIZE);
+}
+
+static bool sameState(const DiffState* a, const DiffState* b) {
+    return a->pc == b->pc && a->acc == b->acc && a->r0 == b->r0 && a->r1 == b->r1 &&
+           a->h == b->h && a->l == b->l && a->flags == b->flags && a->sp == b->sp &&
+           a->bp == b->bp && a->memory_hash == b->memory_hash &&
+           memcmp(a->stack, b->stack, STACK_SIZE) == 0;
+}
+
+static void loadCase(CPU* cpu, const DiffCase* c) {
+    memset(cpu->memory, 0, MEMORY_SIZE);
+    memcpy(cpu->memory, c->data, PROGRAM_START);
+    memcpy(&cpu->memory[PROGRAM_START], c->program, c->program_size);
+    memcpy(cpu->stack, c->start.stack, STACK_SIZE);
+
+    PC = c->start.pc;
+    ACC = c->start.acc;
+    R0 = c->start.r0;
+    R1 = c->start.r1;
+    H = c->start.h;
+    L = c->start.l;
+    FLAGS = c->start.flags;
+    SP = c->start.sp;
+    BP = c->start.bp;
+}
+
+// Instructions that wait for the outside world, reset the whole CPU, divide by zero or read past
+// the end of memory end a case instead of being compared
+static bool runnable(const CPU* cpu) {
+    const uint8_t op = MEMORY(PC);
+
+    if (PC + OPCODE_INFO[op].length > MEMORY_SIZE) return false;
+
+    switch (op) {
+        case OP_HALT:
+        case OP_RESET:
+        case OP_WAIT:
+        case OP_BRK:
+            return false;
+        case OP_DIVW_I:
+            return MEMORY(PC + 1) != 0 || MEMORY(PC + 2) != 0;
+        case OP_DIVW_ACC:
+            return ACC != 0;
+        case OP_DIVW_R0:
+            return R0 != 0;
+        case OP_DIVW_R1:
+            return R1 != 0;
+        default:
+            return true;
+    }
+}
+
+// Reference, the plain table interpreter
+
+static CPU reference;
+
+static void referenceLoad(const DiffCase* c) { loadCase(&reference, c); }
+
+static bool referenceStep(void) {
+    if (!runnable(&reference)) return false;
+    stepCpu(&reference);
+    return true;
+}
+
+static void referenceSnapshot(DiffState* s) { snapshotCpu(&reference, s); }
+
+// The handlers built with watchpoint hooks, with every address watched
+
+static CPU watched;
+static Watchpoints watch_all;
+
+static void ignoreHit(CPU* cpu, const WatchHit* hit, void* data) {
+    UNUSED(cpu);
+    UNUSED(hit);
+    UNUSED(data);
+}
+
+static void watchedLoad(const DiffCase* c) { loadCase(&watched, c); }
+
+static bool watchedStep(void) {
+    if (!runnable(&watched)) return false;
+    stepCpuWatched(&watched, &watch_all);
+    return true;
+}
+
+static void watchedSnapshot(DiffState* s) { snapshotCpu(&watched, s); }
+
+// Random registers, stack and memory below the program
+static void randomStart(DiffCase* c, uint64_t* rng) {
+    c->start = (DiffState){.pc = PROGRAM_START,
+                           .acc = (uint8_t)nextRandom(rng),
+                           .r0 = (uint8_t)nextRandom(rng),
+                           .r1 = (uint8_t)nextRandom(rng),
+                           .h = (uint8_t)nextRandom(rng),
+                           .l = (uint8_t)nextRandom(rng),
+                           .flags = (Flags)nextRandom(rng),
+                           .sp = (uint8_t)nextRandom(rng),
+                           .bp = (uint8_t)nextRandom(rng)};
+    for (size_t i = 0; i < STACK_SIZE; ++i) {
+        c->start.stack[i] = (uint8_t)nextRandom(rng);
+    }
+    for (size_t i = 0; i < PROGRAM_START; ++i) {
+        c->data[i] = (uint8_t)nextRandom(rng);
+    }
+}
+
+// Lockstep, lane 0 runs the case and the other lanes run its program from starting states of their
+// own, so they branch apart and rejoin. Every lane is checked against a reference run of its own,
+// and the last lane sits the case out masked off.
+
+#define MASKED_LANE (LOCKSTEP_LANES - 1)
+
+static LockstepCpu lockstep;
+static CPU lane_references[LOCKSTEP_LANES];
+static size_t lane_steps[LOCKSTEP_LANES];
+static size_t lane_budget;
+static DiffState masked_start;
+
+static bool sameCpu(const CPU* a, const CPU* b) {
+    return a->program_counter == b->program_counter && a->accumulator == b->accumulator &&
+           a->registers.reg_0 == b->registers.reg_0 && a->registers.reg_1 == b->registers.reg_1 &&
+           a->registers.reg_H == b->registers.reg_H && a->registers.reg_L == b->registers.reg_L &&
+           a->flags == b->flags && a->stackptr == b->stackptr && a->baseptr == b->baseptr &&
+           memcmp(a->stack, b->stack, STACK_SIZE) == 0 &&
+           memcmp(a->memory, b->memory, MEMORY_SIZE) == 0;
+}
+
+static void lockstepLoad(const DiffCase* c) {
+    static DiffCase lane_case;
+
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        lane_case = *c;
+        if (lane != 0) {
+            uint64_t rng = c->seed ^ ((uint64_t)lane << 32);
+            randomStart(&lane_case, &rng);
+        }
+
+        loadCase(&lockstep.lanes[lane], &lane_case);
+        scatterLane(&lockstep, lane);
+        loadCase(&lane_references[lane], &lane_case);
+        lockstep.active[lane] = lane == MASKED_LANE ? 0 : 0xFF;
+        lane_steps[lane] = 0;
+    }
+    lane_budget = c->steps;
+    snapshotCpu(&lockstep.lanes[MASKED_LANE], &masked_start);
+}
+
+// Marks the lanes the next `stepLockstep` runs, the active ones at the lowest program counter with
+// the same opcode as the first of them
+static void nextGroup(bool* group) {
+    uint32_t pc = UINT32_MAX;
+    size_t leader = 0;
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        if (lockstep.active[lane] && lockstep.program_counter[lane] < pc) {
+            pc = lockstep.program_counter[lane];
+            leader = lane;
+        }
+    }
+
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        group[lane] = lockstep.active[lane] && lockstep.program_counter[lane] == pc &&
+                      lockstep.lanes[lane].memory[pc] == lockstep.lanes[leader].memory[pc];
+    }
+}
+
+// Steps until lane 0 has run one instruction. The other lanes stop at an instruction that can't be
+// tested or once they ran as many as the case, so they can't keep lane 0 waiting forever.
+static bool lockstepStep(void) {
+    if (!lockstep.active[0] || !runnable(gatherLane(&lockstep, 0))) return false;
+
+    bool group[LOCKSTEP_LANES];
+    do {
+        for (size_t lane = 1; lane < LOCKSTEP_LANES; ++lane) {
+            if (lockstep.active[lane] &&
+                (lane_steps[lane] == lane_budget || !runnable(gatherLane(&lockstep, lane)))) {
+                lockstep.active[lane] = 0;
+            }
+        }
+
+        nextGroup(group);
+        stepLockstep(&lockstep);
+
+        for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+            if (group[lane]) {
+                stepCpu(&lane_references[lane]);
+                lane_steps[lane]++;
+            }
+        }
+    } while (!group[0]);
+
+    return true;
+}
+
+// Shows lane 0, unless another lane disagrees with its own reference or the masked lane moved, then
+// that lane is shown instead so the comparison fails
+static void lockstepSnapshot(DiffState* s) {
+    for (size_t lane = 1; lane < MASKED_LANE; ++lane) {
+        const CPU* cpu = gatherLane(&lockstep, lane);
+        if (!sameCpu(cpu, &lane_references[lane])) {
+            snapshotCpu(cpu, s);
+            return;
+        }
+    }
+
+    snapshotCpu(gatherLane(&lockstep, MASKED_LANE), s);
+    if (!sameState(s, &masked_start)) return;
+
+    snapshotCpu(gatherLane(&lockstep, 0), s);
+}
+
+// Set up with the reference as the first engine, every other engine in the tree goes after it
+static const Engine ENGINES[] = {
+    {"reference", referenceLoad, referenceStep, referenceSnapshot},
+    {"watched", watchedLoad, watchedStep, watchedSnapshot},
+    {"lockstep", lockstepLoad, lockstepStep, lockstepSnapshot},
+};
+#define ENGINE_COUNT (sizeof(ENGINES) / sizeof(Engine))
+
+static void initEngines(void) {
+    initCpu(&reference);
+    initCpu(&watched);
+    initWatchpoints(&watch_all, ignoreHit, NULL);
+    watchRange(&watch_all, 0, MEMORY_SIZE - 1, WATCH_READ | WATCH_WRITE);
+    initLockstep(&lockstep);
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        initCpu(&lane_references[lane]);
+    }
+}
+
+static void freeEngines(void) {
+    freeCpu(&reference);
+    freeCpu(&watched);
+    freeLockstep(&lockstep);
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        freeCpu(&lane_references[lane]);
+    }
+}
+
+static void generateCase(DiffCase* c, uint64_t seed) {
+    uint64_t rng = seed;
+    memset(c, 0, sizeof(DiffCase));
+    c->seed = seed;
+    c->steps = DIFF_STEPS;
+
+    randomStart(c, &rng);
+
+    // pick the opcodes first so jumps can target the start of any instruction
+    uint16_t starts[DIFF_INSTRUCTIONS];
+    size_t size = 0;
+    for (size_t i = 0; i < DIFF_INSTRUCTIONS; ++i) {
+        uint8_t op;
+        do {
+            op = (uint8_t)nextRandom(&rng);
+        } while (OPCODE_INFO[op].mnemonic == NULL || op == OP_HALT || op == OP_RESET ||
+                 op == OP_WAIT || op == OP_BRK);
+
+        starts[i] = (uint16_t)(PROGRAM_START + size);
+        c->program[size] = op;
+        size += OPCODE_INFO[op].length;
+    }
+
+    for (size_t i = 0; i < DIFF_INSTRUCTIONS; ++i) {
+        uint8_t* code = &c->program[starts[i] - PROGRAM_START];
+        const OpcodeInfo* info = &OPCODE_INFO[code[0]];
+
+        for (size_t b = 1; b < info->length; ++b) {
+            code[b] = (uint8_t)nextRandom(&rng);
+        }
+
+        uint16_t addr = 0;
+        if (info->mode == MODE_CODE) {
+            addr = starts[nextRandom(&rng) % DIFF_INSTRUCTIONS];
+        } else if (info->mode == MODE_ABS) {
+            // mostly the data and the program itself, so self modifying code gets tested too
+            const uint64_t r = nextRandom(&rng);
+            addr = (uint16_t)(r % 4 == 0 ? r >> 16 : (r >> 16) % (PROGRAM_START + size));
+        } else {
+            continue;
+        }
+
+        uint8_t* operand = info->operands == OPERANDS_U8_U16 ? &code[2] : &code[1];
+        operand[0] = (uint8_t)(addr >> 8);
+        operand[1] = (uint8_t)addr;
+    }
+
+    c->program[size++] = OP_JMP;
+    c->program[size++] = (uint8_t)(PROGRAM_START >> 8);
+    c->program[size++] = (uint8_t)PROGRAM_START;
+    c->program_size = size;
+}
+
+// Runs `c` on every engine, comparing them every `block` instructions. Returns false and fills in
+// `d` at the first block where an engine disagrees with the first one.
+static bool runCase(const DiffCase* c, const Engine* engines, size_t count, size_t block,
+                    Divergence* d) {
+    for (size_t e = 0; e < count; ++e) {
+        engines[e].load(c);
+    }
+
+    size_t done = 0;
+    bool running = true;
+    while (running && done < c->steps) {
+        const size_t n = c->steps - done < block ? c->steps - done : block;
+
+        size_t ran = 0;
+        while (ran < n && engines[0].step()) {
+            ran++;
+        }
+        running = ran == n;
+        done += ran;
+
+        DiffState expected;
+        engines[0].snapshot(&expected);
+
+        for (size_t e = 1; e < count; ++e) {
+            size_t other = 0;
+            while (other < n && engines[e].step()) {
+                other++;
+            }
+
+            DiffState got;
+            engines[e].snapshot(&got);
+
+            if (other != ran || !sameState(&expected, &got)) {
+                *d = (Divergence){.engine = &engines[e], .step = done, .expected = expected,
+                                  .got = got};
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Size of the instruction at `offset` of a generated program
+static size_t instructionSize(const DiffCase* c, size_t offset) {
+    return OPCODE_INFO[c->program[offset]].length;
+}
+
+/// Makes a failing case as small as possible while it still fails: finds the first instruction
+/// after which the engines disagree, replaces every instruction that isn't needed for that with
+/// NOOPs and clears every part of the starting state that doesn't matter.
+static void shrinkCase(DiffCase* c, const Engine* engines, size_t count, Divergence* d) {
+    // NOOPs take more steps than the instructions they replace
+    const size_t budget = DIFF_STEPS * MAX_OPCODE_LENGTH;
+
+    c->steps = budget;
+    if (!runCase(c, engines, count, 1, d)) {
+        c->steps = d->step;
+    }
+
+    // leave the trailing jump alone
+    for (size_t offset = 0; offset + 3 < c->program_size;) {
+        const size_t len = instructionSize(c, offset);
+        if (c->program[offset] == OP_NOOP) {
+            offset += len;
+            continue;
+        }
+
+        DiffCase smaller = *c;
+        memset(&smaller.program[offset], OP_NOOP, len);
+        smaller.steps = budget;
+
+        Divergence sd;
+        if (!runCase(&smaller, engines, count, 1, &sd)) {
+            smaller.steps = sd.step;
+            *c = smaller;
+            *d = sd;
+        }
+        offset += len;
+    }
+
+#define TRY_CLEAR(field)                                  \
+    do {                                                  \
+        DiffCase smaller = *c;                            \
+        memset(&smaller.field, 0, sizeof(smaller.field)); \
+        Divergence sd;                                    \
+        if (!runCase(&smaller, engines, count, 1, &sd)) { \
+            *c = smaller;                                 \
+            *d = sd;                                      \
+        }                                                 \
+    } while (0)
+
+    TRY_CLEAR(start.acc);
+    TRY_CLEAR(start.r0);
+    TRY_CLEAR(start.r1);
+    TRY_CLEAR(start.h);
+    TRY_CLEAR(start.l);
+    TRY_CLEAR(start.flags);
+    TRY_CLEAR(start.sp);
+    TRY_CLEAR(start.bp);
+    TRY_CLEAR(start.stack);
+    TRY_CLEAR(data);
+
+#undef TRY_CLEAR
+}
+
+static void printState(const char* label, const DiffState* s) {
+    printf("    %-9s pc 0x%04x acc %3u r0 %3u r1 %3u h %3u l %3u flags 0x%02x sp %3u bp %3u", label,
+           s->pc, s->acc, s->r0, s->r1, s->h, s->l, s->flags, s->sp, s->bp);
+}
+
+static void printReproducer(const DiffCase* c, const Divergence* d) {
+    printf("\n%s disagrees with %s after %zu instructions, seed 0x%llx\n", d->engine->name,
+           ENGINES[0].name, d->step, (unsigned long long)c->seed);
+    printState("start", &c->start);
+    printf("\n");
+    printState("expected", &d->expected);
+    printf(" memory %016llx\n", (unsigned long long)d->expected.memory_hash);
+    printState("got", &d->got);
+    printf(" memory %016llx\n", (unsigned long long)d->got.memory_hash);
+
+    size_t data_bytes = 0;
+    for (size_t i = 0; i < PROGRAM_START; ++i) {
+        data_bytes += c->data[i] != 0;
+    }
+    printf("    %zu non-zero bytes below the program, program without NOOPs:\n", data_bytes);
+
+    for (size_t offset = 0; offset < c->program_size; offset += instructionSize(c, offset)) {
+        if (c->program[offset] == OP_NOOP) continue;
+
+        printf("        0x%04zx  ", PROGRAM_START + offset);
+        printNextOperation(&c->program[offset]);
+        printf("\n");
+    }
+}
+
+static uint64_t envOr(const char* name, uint64_t fallback) {
+    const char* value = getenv(name);
+    return value != NULL ? strtoull(value, NULL, 0) : fallback;
+}
+
+TEST engines_agree(void) {
+    const uint64_t cases = envOr("DIFF_CASES", DIFF_CASES);
+    const uint64_t seed = envOr("DIFF_SEED", DIFF_SEED);
+
+    initEngines();
+
+    static DiffCase c;
+    for (uint64_t i = 0; i < cases; ++i) {
+        generateCase(&c, seed + i);
+
+        Divergence d;
+        if (!runCase(&c, ENGINES, ENGINE_COUNT, DIFF_BLOCK, &d)) {
+            shrinkCase(&c, ENGINES, ENGINE_COUNT, &d);
+            printReproducer(&c, &d);
+            freeEngines();
+            FAILm("execution engines disagree");
+        }
+    }
+
+    freeEngines();
+
+    PASS();
+}
+
+// An engine with a known bug, to make sure the harness catches it and shrinks it down
+
+static CPU broken;
+
+static void brokenLoad(const DiffCase* c) { loadCase(&broken, c); }
+
+static bool brokenStep(void) {
+    if (!runnable(&broken)) return false;
+
+    const uint8_t op = broken.memory[broken.program_counter];
+    stepCpu(&broken);
+    if (op == OP_ADD_I) {
+        broken.flags ^= CF_BIT;
+    }
+
+    return true;
+}
+
+static void brokenSnapshot(DiffState* s) { snapshotCpu(&broken, s); }
+
+TEST shrinks_to_the_broken_instruction(void) {
+    const Engine engines[] = {
+        {"reference", referenceLoad, referenceStep, referenceSnapshot},
+        {"broken", brokenLoad, brokenStep, brokenSnapshot},
+    };
+
+    initCpu(&reference);
+    initCpu(&broken);
+
+    static DiffCase c;
+    Divergence d;
+    uint64_t seed = DIFF_SEED;
+    do {
+        generateCase(&c, seed++);
+    } while (runCase(&c, engines, 2, DIFF_BLOCK, &d));
+
+    shrinkCase(&c, engines, 2, &d);
+
+    // only the ADD is left, apart from the jump at the end
+    size_t left = 0;
+    uint8_t op = OP_NOOP;
+    for (size_t offset = 0; offset + 3 < c.program_size; offset += instructionSize(&c, offset)) {
+        if (c.program[offset] != OP_NOOP) {
+            op = c.program[offset];
+            left++;
+        }
+    }
+
+    ASSERT_EQ(1, left);
+    ASSERT_EQ(OP_ADD_I, op);
+    ASSERT_STR_EQ("broken", d.engine->name);
+    ASSERT_EQ(d.expected.flags ^ CF_BIT, d.got.flags);
+
+    freeCpu(&reference);
+    freeCpu(&broken);
+
+    PASS();
+}
+
+SUITE(DIFFERENTIAL_SUITE) {
+    RUN_TEST(engines_agree);
+    RUN_TEST(shrinks_to_the_broken_instruction);
+}
@@ -0,0 +1,117 @@
+#include "../src/headers/disassembler.h"
+
+#include "../src/headers/instructions.h"
+#include "../src/headers/opcodes.h"
+#include "greatest.h"
+#include "util.h"
+
+static size_t operandBytes(OperandLayout layout) {
+    switch (layout) {
+        case OPERANDS_NONE:
+            return 0;
+        case OPERANDS_U8:
+            return 1;
+        case OPERANDS_U16:
+            return 2;
+        case OPERANDS_U8_U16:
+            return 3;
+    }
+    return 0;
+}
+
+TEST lengths_match_operands(void) {
+    for (size_t op = 0; op < 256; ++op) {
+        const OpcodeInfo* info = &OPCODE_INFO[op];
+        ASSERT_EQ_FMT((size_t)info->length, 1 + operandBytes(info->operands), "%zu");
+        ASSERT(info->length <= MAX_OPCODE_LENGTH);
+    }
+
+    PASS();
+}
+
+TEST lengths_match_execution(void) {
+    CPU cpu;
+    initCpu(&cpu);
+
+    for (size_t op = 0; op < 256; ++op) {
+        const OpcodeInfo* info = &OPCODE_INFO[op];
+        // WAIT stays put without input and BRK needs breakpoints to be set up
+        if (info->flow != FLOW_NEXT || op == OP_WAIT || op == OP_BRK) continue;
+
+        cpu.stackptr = 0;
+        initTestCpu(&cpu, (Opcode)op);
+        OP_TABLE[op](&cpu);
+
+        if (cpu.program_counter != 8 + info->length) {
+            FAILm(info->mnemonic != NULL ? info->mnemonic : "unused opcode");
+        }
+    }
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST jext_skips_its_operands(void) {
+    CPU cpu;
+    initCpu(&cpu);
+
+    const uint8_t program[] = {OP_JEXT, 0x3f, 0x01, 0x10, OP_HALT};
+    memcpy(&cpu.memory[PROGRAM_START], program, sizeof(program));
+
+    // any flag set, none are
+    cpu.flags = 0;
+    stepCpu(&cpu);
+    ASSERT_EQ(PROGRAM_START + 4, cpu.program_counter);
+
+    cpu.program_counter = PROGRAM_START;
+    cpu.flags = 1;
+    stepCpu(&cpu);
+    ASSERT_EQ(0x110, cpu.program_counter);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+// clang-format off
+static const uint8_t mixed[] = {
+    OP_JMP, 0x01, 0x05,     // 0x100
+    0x09, 0x09,             // 0x103, never runs
+    OP_CALL, 0x01, 0x0a,    // 0x105
+    OP_HALT,                // 0x108
+    0x00,                   // 0x109, data
+    OP_RET,                 // 0x10a
+};
+// clang-format on
+
+TEST recursive_skips_data(void) {
+    static uint8_t memory[MEMORY_SIZE];
+    memcpy(&memory[PROGRAM_START], mixed, sizeof(mixed));
+    const size_t end = PROGRAM_START + sizeof(mixed);
+
+    InstructionStarts reachable;
+    findReachable(memory, PROGRAM_START, end, reachable);
+
+    for (size_t addr = PROGRAM_START; addr < end; ++addr) {
+        const bool expected =
+            addr == 0x100 || addr == 0x105 || addr == 0x108 || addr == 0x10a;
+        ASSERT_EQ(expected, isInstructionStart(reachable, addr));
+    }
+
+    // a linear sweep decodes the garbage after the jump and loses track of the CALL
+    InstructionStarts linear;
+    sweepLinear(memory, PROGRAM_START, end, linear);
+
+    ASSERT(isInstructionStart(linear, 0x103));
+    ASSERT_FALSE(isInstructionStart(linear, 0x105));
+
+    PASS();
+}
+
+SUITE(DISASSEMBLER_SUITE) {
+    RUN_TEST(lengths_match_operands);
+    RUN_TEST(lengths_match_execution);
+    RUN_TEST(jext_skips_its_operands);
+    RUN_TEST(recursive_skips_data);
+}
@@ -0,0 +1,243 @@
+#include "../src/headers/gdb_stub.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* gdb_src =
+    "    LOAD 3\n"
+    "    STORE R0\n"
+    "loop:\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    "    STORE far[0]\n"
+    "HALT\n"
+    ".far = 0x8000\n";
+
+typedef struct GdbRun {
+    CPU* cpu;
+    GdbStub* stub;
+} GdbRun;
+
+static void* runStub(void* data) {
+    GdbRun* run = (GdbRun*)data;
+    runCpuGdb(run->cpu, run->stub);
+    return NULL;
+}
+
+static int connectClient(const char* path) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends `cmd` like GDB would and returns the reply without framing
+static const char* request(int fd, const char* cmd) {
+    static char reply[GDB_PACKET_SIZE];
+    char packet[GDB_PACKET_SIZE];
+    uint8_t sum = 0;
+
+    for (const char* c = cmd; *c; ++c) {
+        sum += (uint8_t)*c;
+    }
+    int len = snprintf(packet, sizeof(packet), "$%s#%02x", cmd, sum);
+    if (write(fd, packet, (size_t)len) != len) return "";
+
+    char c;
+    size_t n = 0;
+    // skip the ack and anything before the reply
+    while (read(fd, &c, 1) == 1 && c != '$') {
+    }
+    while (read(fd, &c, 1) == 1 && c != '#' && n < sizeof(reply) - 1) {
+        reply[n++] = c;
+    }
+    reply[n] = '\0';
+
+    char checksum[2];
+    if (read(fd, checksum, 2) != 2 || write(fd, "+", 1) != 1) return "";
+
+    return reply;
+}
+
+TEST gdb_breakpoints_steps_and_watchpoints(void) {
+    const char* path = "gdb";
+    Executable exec = assemble(from_cstr_slice(gdb_src, strlen(gdb_src)), static_slice(path));
+    const uint16_t loop = (uint16_t)*get_map(&exec.labels, static_slice("loop"));
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+
+    const char* socket_path = "/tmp/cce_gdb_stub_test.sock";
+    char address[128];
+    snprintf(address, sizeof(address), "unix:%s", socket_path);
+
+    GdbStub stub;
+    ASSERT(openGdbStub(&stub, address, true));
+
+    int fd = connectClient(socket_path);
+    ASSERT(fd >= 0);
+
+    GdbRun run = {.cpu = &cpu, .stub = &stub};
+    pthread_t vm;
+    pthread_create(&vm, NULL, runStub, &run);
+
+    char cmd[64];
+    char expected[64];
+
+    ASSERT_STR_EQ("S05", request(fd, "?"));
+    ASSERT_EQ(0, strncmp(request(fd, "qXfer:features:read:target.xml:0,fff"), "l<?xml", 6));
+    // pc is little endian, acc and the other registers start out zeroed
+    ASSERT_STR_EQ("00010000000000000000", request(fd, "g"));
+    snprintf(expected, sizeof(expected), "%02x03", OP_LOAD_I);
+    ASSERT_STR_EQ(expected, request(fd, "m100,2"));
+
+    snprintf(cmd, sizeof(cmd), "Z0,%x,1", loop);
+    ASSERT_STR_EQ("OK", request(fd, cmd));
+    ASSERT_EQ(OP_BRK, cpu.memory[loop]);
+    // reads see through the breakpoint
+    snprintf(cmd, sizeof(cmd), "m%x,1", loop);
+    snprintf(expected, sizeof(expected), "%02x", OP_DEC_R0);
+    ASSERT_STR_EQ(expected, request(fd, cmd));
+
+    ASSERT_STR_EQ("T05swbreak:;", request(fd, "c"));
+    snprintf(expected, sizeof(expected), "%02x%02x", loop & 0xFF, loop >> 8);
+    ASSERT_STR_EQ(expected, request(fd, "p0"));
+    ASSERT_STR_EQ("03", request(fd, "p2"));
+
+    // continuing runs the DEC under the breakpoint and stops on the next pass
+    ASSERT_STR_EQ("T05swbreak:;", request(fd, "c"));
+    ASSERT_STR_EQ("02", request(fd, "p2"));
+
+    ASSERT_STR_EQ("S05", request(fd, "s"));
+    ASSERT_STR_EQ("01", request(fd, "p2"));
+
+    snprintf(cmd, sizeof(cmd), "z0,%x,1", loop);
+    ASSERT_STR_EQ("OK", request(fd, cmd));
+    ASSERT_EQ(OP_DEC_R0, cpu.memory[loop]);
+
+    ASSERT_STR_EQ("OK", request(fd, "Z2,8000,1"));
+    ASSERT_STR_EQ("T05watch:8000;", request(fd, "c"));
+    ASSERT_STR_EQ("W00", request(fd, "c"));
+
+    pthread_join(vm, NULL);
+    close(fd);
+    closeGdbStub(&stub);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+// Breakpoints from --break go into the stub's table before it runs, and have to run the
+// instruction they cover like the client's own do
+TEST gdb_keeps_breakpoints_set_before_it_runs(void) {
+    Executable exec = assemble(from_cstr_slice(gdb_src, strlen(gdb_src)), static_slice("gdb"));
+    const uint16_t loop = (uint16_t)*get_map(&exec.labels, static_slice("loop"));
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+
+    const char* socket_path = "/tmp/cce_gdb_stub_break_test.sock";
+    char address[128];
+    snprintf(address, sizeof(address), "unix:%s", socket_path);
+
+    GdbStub stub;
+    ASSERT(openGdbStub(&stub, address, true));
+    cpu.breakpoints = &stub.breakpoints;
+    ASSERT(setBreakpoint(&cpu, loop));
+
+    int fd = connectClient(socket_path);
+    ASSERT(fd >= 0);
+
+    GdbRun run = {.cpu = &cpu, .stub = &stub};
+    pthread_t vm;
+    pthread_create(&vm, NULL, runStub, &run);
+
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%02x%02x", loop & 0xFF, loop >> 8);
+
+    ASSERT_STR_EQ("S05", request(fd, "?"));
+    ASSERT_STR_EQ("T05swbreak:;", request(fd, "c"));
+    ASSERT_STR_EQ(expected, request(fd, "p0"));
+    ASSERT_STR_EQ("03", request(fd, "p2"));
+    ASSERT_STR_EQ("T05swbreak:;", request(fd, "c"));
+    ASSERT_STR_EQ(expected, request(fd, "p0"));
+    ASSERT_STR_EQ("02", request(fd, "p2"));
+
+    // detaching keeps the breakpoint, the VM runs through it to the end without a client
+    ASSERT_STR_EQ("OK", request(fd, "D"));
+    pthread_join(vm, NULL);
+
+    ASSERT_EQ(1, len_vec(&stub.breakpoints.list));
+    ASSERT_EQ(OP_BRK, cpu.memory[loop]);
+    ASSERT_EQ(0, cpu.registers.reg_0);
+    ASSERT_EQ(3, cpu.memory[0x8000]);
+    ASSERT_EQ(OP_HALT, cpu.memory[cpu.program_counter]);
+
+    close(fd);
+    closeGdbStub(&stub);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST gdb_exits_through_a_breakpoint_on_halt(void) {
+    const char* src = "    LOAD 1\nend:\nHALT\n";
+    Executable exec = assemble(from_cstr_slice(src, strlen(src)), static_slice("gdb"));
+    const uint16_t end = (uint16_t)*get_map(&exec.labels, static_slice("end"));
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+
+    const char* socket_path = "/tmp/cce_gdb_stub_halt_test.sock";
+    char address[128];
+    snprintf(address, sizeof(address), "unix:%s", socket_path);
+
+    GdbStub stub;
+    ASSERT(openGdbStub(&stub, address, true));
+    int fd = connectClient(socket_path);
+    ASSERT(fd >= 0);
+
+    GdbRun run = {.cpu = &cpu, .stub = &stub};
+    pthread_t vm;
+    pthread_create(&vm, NULL, runStub, &run);
+
+    char cmd[64];
+    ASSERT_STR_EQ("S05", request(fd, "?"));
+    snprintf(cmd, sizeof(cmd), "Z0,%x,1", end);
+    ASSERT_STR_EQ("OK", request(fd, cmd));
+    // the program ends right before the HALT, with or without a breakpoint on it
+    ASSERT_STR_EQ("W00", request(fd, "c"));
+
+    pthread_join(vm, NULL);
+    close(fd);
+    closeGdbStub(&stub);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+SUITE(GDB_STUB_SUITE) {
+    RUN_TEST(gdb_breakpoints_steps_and_watchpoints);
+    RUN_TEST(gdb_keeps_breakpoints_set_before_it_runs);
+    RUN_TEST(gdb_exits_through_a_breakpoint_on_halt);
+}
@@ -0,0 +1,252 @@
+#include "../src/headers/hot_reload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* running_src =
+    "start:\n"
+    "    LOAD 5\n"
+    "    STORE data[0]\n"
+    "loop:\n"
+    "    INC R0\n"
+    "    JMP .loop\n"
+    "data:\n"
+    "    1 2\n";
+
+static Executable assembleSource(const char* src) {
+    return assemble(from_cstr_slice(src, strlen(src)), static_slice("reload"));
+}
+
+// Loads `exec` and runs `steps` instructions of it
+static void startProgram(CPU* cpu, const Executable* exec, size_t steps) {
+    initCpu(cpu);
+    loadProgram(cpu, exec->executable, exec->size);
+    for (size_t i = 0; i < steps; ++i) {
+        stepCpu(cpu);
+    }
+}
+
+TEST patches_code_and_keeps_state(void) {
+    Executable prev = assembleSource(running_src);
+    CPU cpu;
+    // LOAD, STORE and the first INC, so the program changed data[0] already
+    startProgram(&cpu, &prev, 3);
+    const uint16_t pc = cpu.program_counter;
+    const uint16_t data = (uint16_t)*(const size_t*)get_map(&prev.labels, static_slice("data"));
+
+    Executable next = assembleSource(
+        "start:\n"
+        "    LOAD 6\n"
+        "    STORE data[0]\n"
+        "loop:\n"
+        "    INC R0\n"
+        "    JMP .loop\n"
+        "data:\n"
+        "    1 3\n");
+
+    vec_t moved = new_vec(4, sizeof(MovedLabel));
+    size_t patched;
+    ASSERT_EQ(RELOAD_PATCHED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+    ASSERT_EQ(0, len_vec(&moved));
+    ASSERT_EQ(2, patched);
+
+    ASSERT_EQ(6, cpu.memory[PROGRAM_START + 1]);
+    ASSERT_EQ(5, cpu.memory[data]);
+    ASSERT_EQ(3, cpu.memory[data + 1]);
+    ASSERT_EQ(pc, cpu.program_counter);
+    ASSERT_EQ(1, cpu.registers.reg_0);
+    ASSERT_EQ(5, cpu.accumulator);
+
+    free_vec(&moved, NULL);
+    freeExecutable(&next);
+    freeExecutable(&prev);
+    freeCpu(&cpu);
+    PASS();
+}
+
+TEST refuses_moved_labels(void) {
+    Executable prev = assembleSource(running_src);
+    CPU cpu;
+    startProgram(&cpu, &prev, 3);
+    uint8_t* before = malloc(MEMORY_SIZE);
+    memcpy(before, cpu.memory, MEMORY_SIZE);
+
+    Executable next = assembleSource(
+        "start:\n"
+        "    LOAD 5\n"
+        "    INC R1\n"
+        "    STORE data[0]\n"
+        "loop:\n"
+        "    INC R0\n"
+        "    JMP .loop\n"
+        "data:\n"
+        "    1 2\n");
+
+    vec_t moved = new_vec(4, sizeof(MovedLabel));
+    size_t patched;
+    ASSERT_EQ(RELOAD_MOVED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+    ASSERT_EQ(2, len_vec(&moved));
+    for (size_t i = 0; i < len_vec(&moved); ++i) {
+        const MovedLabel* label = get_vec(&moved, i);
+        ASSERT_EQ(label->from + 1, label->to);
+        ASSERT_EQ(4, label->name.len);
+        ASSERT(memcmp(label->name.str, "loop", 4) == 0 ||
+               memcmp(label->name.str, "data", 4) == 0);
+    }
+    ASSERT_EQ(0, patched);
+    ASSERT_MEM_EQ(before, cpu.memory, MEMORY_SIZE);
+
+    free(before);
+    free_vec(&moved, NULL);
+    freeExecutable(&next);
+    freeExecutable(&prev);
+    freeCpu(&cpu);
+    PASS();
+}
+
+TEST refuses_pc_inside_an_instruction(void) {
+    Executable prev = assembleSource("start:\n    LOAD 1\n    ADD 2\n    JMP .start\n");
+    CPU cpu;
+    startProgram(&cpu, &prev, 1);
+
+    // LOAD R0 is a byte shorter, so the ADD starts a byte earlier
+    Executable next = assembleSource("start:\n    LOAD R0\n    ADD 2\n    JMP .start\n");
+    vec_t moved = new_vec(4, sizeof(MovedLabel));
+    size_t patched;
+    ASSERT_EQ(RELOAD_MISALIGNED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+    ASSERT_EQ(0x08, cpu.memory[PROGRAM_START]);
+    freeExecutable(&next);
+
+    // a shorter instruction at the PC keeps it at the start of one
+    next = assembleSource("start:\n    LOAD 1\n    ADD R0\n    JMP .start\n");
+    ASSERT_EQ(RELOAD_PATCHED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+
+    free_vec(&moved, NULL);
+    freeExecutable(&next);
+    freeExecutable(&prev);
+    freeCpu(&cpu);
+    PASS();
+}
+
+static const char* calling_src =
+    "start:\n"
+    "    JMP .main\n"
+    "func:\n"
+    "    INC R0\n"
+    "    RET\n"
+    "main:\n"
+    "    LOAD 1\n"
+    "    CALL .func\n"
+    "    JMP .main\n";
+
+TEST refuses_moving_a_live_return_address(void) {
+    Executable prev = assembleSource(calling_src);
+    CPU cpu;
+    // JMP, LOAD and CALL, so the frame of `func` is live and its return address is on the stack
+    startProgram(&cpu, &prev, 3);
+    ASSERT_EQ(2, cpu.stackptr);
+
+    // no label moves, but the CALL in the last block starts a byte earlier
+    Executable next = assembleSource(
+        "start:\n"
+        "    JMP .main\n"
+        "func:\n"
+        "    INC R0\n"
+        "    RET\n"
+        "main:\n"
+        "    LOAD R0\n"
+        "    CALL .func\n"
+        "    JMP .main\n");
+    vec_t moved = new_vec(4, sizeof(MovedLabel));
+    size_t patched;
+    ASSERT_EQ(RELOAD_MISALIGNED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+    ASSERT_EQ(0, len_vec(&moved));
+    ASSERT_EQ(0, patched);
+    freeExecutable(&next);
+
+    // changing the function itself keeps the return address where it was
+    next = assembleSource(
+        "start:\n"
+        "    JMP .main\n"
+        "func:\n"
+        "    DEC R0\n"
+        "    RET\n"
+        "main:\n"
+        "    LOAD 1\n"
+        "    CALL .func\n"
+        "    JMP .main\n");
+    ASSERT_EQ(RELOAD_PATCHED, patchProgram(&cpu, &prev, &next, &moved, &patched));
+    ASSERT_EQ(1, patched);
+
+    free_vec(&moved, NULL);
+    freeExecutable(&next);
+    freeExecutable(&prev);
+    freeCpu(&cpu);
+    PASS();
+}
+
+#ifdef __linux__
+
+static void writeSource(const char* path, const char* src) {
+    FILE* file = fopen(path, "w");
+    fputs(src, file);
+    fclose(file);
+}
+
+TEST reloads_saved_source(void) {
+    char dir[] = "/tmp/vm-hot-reload-XXXXXX";
+    ASSERT(mkdtemp(dir) != NULL);
+    char path[64];
+    char replacement[64];
+    snprintf(path, sizeof(path), "%s/prog.casm", dir);
+    snprintf(replacement, sizeof(replacement), "%s/prog.casm.new", dir);
+    writeSource(path, running_src);
+
+    HotReload reload;
+    ASSERT(openHotReload(&reload, path));
+    CPU cpu;
+    startProgram(&cpu, &reload.exec, 3);
+    ASSERT_FALSE(pollHotReload(&reload, &cpu));
+
+    writeSource(path, "start:\n    LOAD 7\n    STORE data[0]\nloop:\n    INC R0\n    JMP .loop\n"
+                      "data:\n    1 2\n");
+    ASSERT(pollHotReload(&reload, &cpu));
+    ASSERT_EQ(7, cpu.memory[PROGRAM_START + 1]);
+    ASSERT_EQ(1, reload.reloads);
+
+    // a source with errors keeps the running program
+    writeSource(path, "start:\n    LOAD 8\n    FOO\n");
+    ASSERT_FALSE(pollHotReload(&reload, &cpu));
+    ASSERT_EQ(7, cpu.memory[PROGRAM_START + 1]);
+
+    // editors that save to a new file and rename it over the old one
+    writeSource(replacement, "start:\n    LOAD 9\n    STORE data[0]\nloop:\n    INC R0\n"
+                             "    JMP .loop\ndata:\n    1 2\n");
+    ASSERT_EQ(0, rename(replacement, path));
+    ASSERT(pollHotReload(&reload, &cpu));
+    ASSERT_EQ(9, cpu.memory[PROGRAM_START + 1]);
+    ASSERT_EQ(2, reload.reloads);
+
+    closeHotReload(&reload);
+    freeCpu(&cpu);
+    unlink(path);
+    rmdir(dir);
+    PASS();
+}
+
+#endif
+
+SUITE(HOT_RELOAD_SUITE) {
+    RUN_TEST(patches_code_and_keeps_state);
+    RUN_TEST(refuses_moved_labels);
+    RUN_TEST(refuses_pc_inside_an_instruction);
+    RUN_TEST(refuses_moving_a_live_return_address);
+#ifdef __linux__
+    RUN_TEST(reloads_saved_source);
+#endif
+}
@@ -0,0 +1,78 @@
+#include "../src/headers/lockstep.h"
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+#include "util.h"
+
+// Collatz step count of the number in HL, lanes branch differently on odd and even numbers and
+// call into different subroutines
+static const char* collatz_src =
+    "collatz:\n"
+    "    INC R0\n"
+    "    LOAD L\n"
+    "    AND 1\n"
+    "    CMP 0\n"
+    "    JZ .even\n"
+    "    CALL .odd\n"
+    "    JMP .continue\n"
+    "    even:\n"
+    "        CALL .half\n"
+    "    continue:\n"
+    "    LOAD H\n"
+    "    CMP 0\n"
+    "    JNZ .collatz\n"
+    "    LOAD L\n"
+    "    SBC 1\n"
+    "    ADC 0\n"
+    "    CMP 1\n"
+    "    JNZ .collatz\n"
+    "HALT\n"
+    "half:\n"
+    "    DIVW 2\n"
+    "    RET\n"
+    "odd:\n"
+    "    MULW 3\n"
+    "    ADDW 1\n"
+    "    RET\n";
+
+TEST lockstep_matches_scalar(void) {
+    const char* path = "collatz";
+    Executable exec =
+        assemble(from_cstr_slice(collatz_src, strlen(collatz_src)), static_slice(path));
+
+    static LockstepCpu ls;
+    initLockstep(&ls);
+    loadProgramLockstep(&ls, exec.executable, exec.size);
+
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        CPU* cpu = gatherLane(&ls, lane);
+        L = (uint8_t)(lane * 7 + 3);
+        FLAGS = (Flags)(lane & CF_BIT);
+        scatterLane(&ls, lane);
+    }
+
+    runLockstep(&ls, 0);
+    ASSERT_EQ(0, activeLanes(&ls));
+
+    for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+        CPU scalar;
+        initCpu(&scalar);
+        loadProgram(&scalar, exec.executable, exec.size);
+        scalar.registers.reg_L = (uint8_t)(lane * 7 + 3);
+        scalar.flags = (Flags)(lane & CF_BIT);
+
+        while (stepCpu(&scalar) != OP_HALT) {
+        }
+
+        ASSERTm("lane diverged from scalar execution", cpus_eq(&scalar, gatherLane(&ls, lane)));
+        freeCpu(&scalar);
+    }
+
+    freeLockstep(&ls);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+SUITE(LOCKSTEP_SUITE) { RUN_TEST(lockstep_matches_scalar); }
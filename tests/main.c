@@ -8,6 +8,24 @@ int main(int argc, char **argv) {
     RUN_SUITE(INSTRUCTION_PARITY_SUITE);
     RUN_SUITE(INSTRUCTION_FUNCTIONALITY_SUITE);
     RUN_SUITE(ASSEMBLE_FIB_SUITE);
+    RUN_SUITE(LOCKSTEP_SUITE);
+    RUN_SUITE(SCHEDULER_SUITE);
+    RUN_SUITE(CPU_POOL_SUITE);
+    RUN_SUITE(PROFILER_SUITE);
+    RUN_SUITE(CALLGRAPH_SUITE);
+    RUN_SUITE(SAMPLER_SUITE);
+    RUN_SUITE(DEBUG_INFO_SUITE);
+    RUN_SUITE(BREAKPOINTS_SUITE);
+    RUN_SUITE(WATCHPOINTS_SUITE);
+    RUN_SUITE(TRACE_SUITE);
+    RUN_SUITE(GDB_STUB_SUITE);
+    RUN_SUITE(DISASSEMBLER_SUITE);
+    RUN_SUITE(DIFFERENTIAL_SUITE);
+    RUN_SUITE(TOKENIZER_SUITE);
+    RUN_SUITE(ARENA_SUITE);
+    RUN_SUITE(STR_INT_MAP_SUITE);
+    RUN_SUITE(ASSEMBLER_SUITE);
+    RUN_SUITE(HOT_RELOAD_SUITE);
 
     GREATEST_MAIN_END();
 }
@@ -0,0 +1,68 @@
+#include "../src/headers/profiler.h"
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* loop_src =
+    "    LOAD 5\n"
+    "    STORE R0\n"
+    "loop:\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    "HALT\n"
+    ".video = 0x9fff\n";
+
+TEST profile_counts_instructions(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+
+    static Profile profile;
+    initProfile(&profile);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    runCpuProfiled(&cpu, &profile);
+
+    // LOAD, STORE, 5 times DEC and JNZ
+    ASSERT_EQ(12, profile.instructions);
+    ASSERT_EQ(5, profile.opcodes[OP_DEC_R0]);
+    ASSERT_EQ(5, profile.opcodes[OP_JNZ]);
+    ASSERT_EQ(0, profile.opcodes[OP_HALT]);
+
+    size_t* loop = get_map(&exec.labels, static_slice("loop"));
+    ASSERT(loop != NULL);
+    ASSERT_EQ(5, profile.addresses[*loop]);
+
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST symbols_resolve_label_offsets(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+    const SymbolTable symbols = exec.debug_info.symbols;
+
+    // .video points outside of the program, so only loop is a symbol
+    ASSERT_EQ(1, symbols.symbols.len);
+
+    const uint16_t loop = (uint16_t)*get_map(&exec.labels, static_slice("loop"));
+    ASSERT_EQ(NULL, findSymbol(&symbols, loop - 1));
+    ASSERT_EQ(loop, findSymbol(&symbols, loop)->addr);
+    ASSERT_EQ(loop, findSymbol(&symbols, loop + 2)->addr);
+
+    slice_t line = sourceLine(static_slice(loop_src), 4);
+    ASSERT(eq_cstr_slice(line, "    DEC R0", 10));
+
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+SUITE(PROFILER_SUITE) {
+    RUN_TEST(profile_counts_instructions);
+    RUN_TEST(symbols_resolve_label_offsets);
+}
@@ -0,0 +1,58 @@
+#include "../src/headers/sampler.h"
+
+#include "../src/headers/instructions.h"
+#include "../src/headers/util.h"
+#include "greatest.h"
+
+TEST sampler_records_guest_pc(void) {
+    // INC R0 and JMP back to it, forever
+    const uint8_t program[] = {OP_INC_R0, OP_JMP, 0, 0};
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, program, sizeof(program));
+    cpu.program_counter = 0;
+
+    if (!startSampler(&cpu, NULL, 10000)) {
+        SKIPm("no profiling timer on this platform");
+    }
+
+    // ITIMER_PROF only advances while the process is using CPU time, so this terminates
+    for (size_t i = 0; samplesTaken() < 3 && i < 4000000000UL; ++i) {
+        stepCpu(&cpu);
+    }
+    stopSampler();
+
+    ASSERT(samplesTaken() >= 3);
+
+    for (size_t i = 0; i < min(samplesTaken(), SAMPLE_CAPACITY); ++i) {
+        const Sample s = samples()[i];
+        ASSERT(s.pc <= 1);
+        ASSERT_EQ(program[s.pc], s.opcode);
+        ASSERT_EQ(UINT32_MAX, s.node);
+    }
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST sampler_starts_at_one_hz(void) {
+    CPU cpu;
+    initCpu(&cpu);
+
+#ifdef _WIN32
+    SKIPm("no profiling timer on this platform");
+#endif
+    // a whole second between samples doesn't fit in tv_usec alone
+    ASSERT(startSampler(&cpu, NULL, 1));
+    stopSampler();
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+SUITE(SAMPLER_SUITE) {
+    RUN_TEST(sampler_records_guest_pc);
+    RUN_TEST(sampler_starts_at_one_hz);
+}
@@ -0,0 +1,114 @@
+#include "../src/headers/scheduler.h"
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+#define VM_COUNT 512
+
+// Sums three values read from the input ring buffer into R0
+static const char* sum_src =
+    "    LOAD 3\n"
+    "    STORE R1\n"
+    "next:\n"
+    "    WAIT\n"
+    "    LOAD read_idx[0]\n"
+    "    STORE L\n"
+    "    LOAD 0\n"
+    "    STORE H\n"
+    "    LOAD ringbuf[HL]\n"
+    "    ADD R0\n"
+    "    STORE R0\n"
+    "    LOAD read_idx[0]\n"
+    "    INC ACC\n"
+    "    AND 0x0f\n"
+    "    STORE read_idx[0]\n"
+    "    DEC R1\n"
+    "    JNZ .next\n"
+    "HALT\n"
+    ".read_idx = 0x9fee\n"
+    ".ringbuf = 0x9fef\n";
+
+TEST scheduler_parks_waiting_vms(void) {
+    const char* path = "sum";
+    Executable exec = assemble(from_cstr_slice(sum_src, strlen(sum_src)), static_slice(path));
+
+    static CPU cpus[VM_COUNT];
+    Scheduler s;
+    initScheduler(&s, 64);
+
+    for (size_t i = 0; i < VM_COUNT; ++i) {
+        initCpu(&cpus[i]);
+        loadProgram(&cpus[i], exec.executable, exec.size);
+        ASSERT_EQ(i, addVm(&s, &cpus[i]));
+    }
+
+    // everything runs into the first WAIT within a single slice
+    ASSERT_EQ(1, runScheduler(&s));
+    for (size_t i = 0; i < VM_COUNT; ++i) {
+        ASSERT_EQ(VM_PARKED, vmState(&s, i));
+    }
+
+    // nothing is ready, so a round doesn't touch any VM
+    ASSERT_EQ(0, runRound(&s));
+
+    for (size_t i = 0; i < VM_COUNT; ++i) {
+        ASSERT(postInput(&s, i, (char)(i % 8)));
+    }
+    runScheduler(&s);
+
+    for (size_t i = 0; i < VM_COUNT; i += 2) {
+        ASSERT(postInput(&s, i, 10));
+        ASSERT(postInput(&s, i, 20));
+    }
+    runScheduler(&s);
+
+    for (size_t i = 0; i < VM_COUNT; ++i) {
+        if (i % 2 == 0) {
+            ASSERT_EQ(VM_HALTED, vmState(&s, i));
+            ASSERT_EQ(i % 8 + 30, cpus[i].registers.reg_0);
+        } else {
+            ASSERT_EQ(VM_PARKED, vmState(&s, i));
+            ASSERT_EQ(i % 8, cpus[i].registers.reg_0);
+        }
+    }
+
+    // input posted to a halted VM is accepted but doesn't reschedule it
+    ASSERT(postInput(&s, 0, 1));
+    ASSERT_EQ(0, runScheduler(&s));
+
+    for (size_t i = 0; i < VM_COUNT; ++i) {
+        freeCpu(&cpus[i]);
+    }
+    freeScheduler(&s);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST scheduler_bounds_slices(void) {
+    // an endless loop never parks, but only runs one slice per round
+    const uint8_t program[] = {OP_NOOP, OP_JMP, 0, 0};
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, program, sizeof(program));
+    cpu.program_counter = 0;
+
+    Scheduler s;
+    initScheduler(&s, 10);
+    addVm(&s, &cpu);
+
+    ASSERT_EQ(1, runRound(&s));
+    ASSERT_EQ(VM_READY, vmState(&s, 0));
+    ASSERT(cpu.program_counter == 0 || cpu.program_counter == 1);
+
+    freeScheduler(&s);
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+SUITE(SCHEDULER_SUITE) {
+    RUN_TEST(scheduler_parks_waiting_vms);
+    RUN_TEST(scheduler_bounds_slices);
+}
@@ -0,0 +1,114 @@
+#include "../src/headers/str_int_map.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "greatest.h"
+
+#define KEY_COUNT 2000
+
+// keys are borrowed, so they live here for the whole suite
+static char keys[KEY_COUNT][16];
+
+static slice_t key(size_t i) { return from_cstr_slice(keys[i], strlen(keys[i])); }
+
+static void makeKeys(void) {
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        // lengths from 1 to 12 so the word-wise compare sees every tail length
+        snprintf(keys[i], sizeof(keys[i]), "%.*s%zx", (int)(i % 8), "lbl_name", i);
+    }
+}
+
+TEST insert_get_remove_match_a_reference(void) {
+    makeKeys();
+
+    si_map_t map = new_map();
+    // value + 1 of every key in the map, 0 when it isn't
+    static size_t reference[KEY_COUNT];
+    memset(reference, 0, sizeof(reference));
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t step = 0; step < 50000; ++step) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t i = (size_t)(state >> 33) % KEY_COUNT;
+        const bool insert = (state >> 20) % 3 != 0;
+
+        if (insert) {
+            ASSERT_EQ(reference[i] == 0, insert_map(&map, key(i), step));
+            if (reference[i] == 0) reference[i] = step + 1;
+        } else {
+            ASSERT_EQ(reference[i] != 0, remove_map(&map, key(i)));
+            reference[i] = 0;
+        }
+    }
+
+    size_t len = 0;
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        size_t* value = get_map(&map, key(i));
+        if (reference[i] == 0) {
+            ASSERT_EQ(NULL, value);
+        } else {
+            ASSERT(value != NULL);
+            ASSERT_EQ(reference[i] - 1, *value);
+            len++;
+        }
+    }
+    ASSERT_EQ(len, len_map(&map));
+
+    free_map(&map);
+    PASS();
+}
+
+TEST iteration_visits_every_entry_once(void) {
+    makeKeys();
+
+    si_map_t map = new_map();
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        insert_map(&map, key(i), i);
+    }
+
+    static bool seen[KEY_COUNT];
+    memset(seen, 0, sizeof(seen));
+
+    si_map_iter_t iter = iter_from_map(&map);
+    si_kv kv;
+    size_t count = 0;
+
+    while ((kv = map_iter_next(&iter)).key.str != NULL) {
+        ASSERT(kv.value < KEY_COUNT);
+        ASSERT_FALSE(seen[kv.value]);
+        ASSERT(eq_slice(kv.key, key(kv.value)));
+        seen[kv.value] = true;
+        count++;
+    }
+    ASSERT_EQ(KEY_COUNT, count);
+    ASSERT_EQ(NULL, map_iter_peek(&iter).key.str);
+
+    free_map(&map);
+    PASS();
+}
+
+TEST capacity_hint_avoids_growing(void) {
+    makeKeys();
+
+    si_map_t map = new_map_with_capacity(KEY_COUNT);
+    const size_t capacity = capacity_map(&map);
+
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        insert_map(&map, key(i), i);
+    }
+    ASSERT_EQ(capacity, capacity_map(&map));
+
+    clear_map(&map);
+    ASSERT_EQ(0, len_map(&map));
+    ASSERT_EQ(NULL, get_map(&map, key(0)));
+
+    free_map(&map);
+    PASS();
+}
+
+SUITE(STR_INT_MAP_SUITE) {
+    RUN_TEST(insert_get_remove_match_a_reference);
+    RUN_TEST(iteration_visits_every_entry_once);
+    RUN_TEST(capacity_hint_avoids_growing);
+}
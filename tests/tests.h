@@ -6,5 +6,23 @@
 SUITE(INSTRUCTION_PARITY_SUITE);
 SUITE(INSTRUCTION_FUNCTIONALITY_SUITE);
 SUITE(ASSEMBLE_FIB_SUITE);
+SUITE(LOCKSTEP_SUITE);
+SUITE(SCHEDULER_SUITE);
+SUITE(CPU_POOL_SUITE);
+SUITE(PROFILER_SUITE);
+SUITE(CALLGRAPH_SUITE);
+SUITE(SAMPLER_SUITE);
+SUITE(DEBUG_INFO_SUITE);
+SUITE(BREAKPOINTS_SUITE);
+SUITE(WATCHPOINTS_SUITE);
+SUITE(TRACE_SUITE);
+SUITE(GDB_STUB_SUITE);
+SUITE(DISASSEMBLER_SUITE);
+SUITE(DIFFERENTIAL_SUITE);
+SUITE(TOKENIZER_SUITE);
+SUITE(ARENA_SUITE);
+SUITE(STR_INT_MAP_SUITE);
+SUITE(ASSEMBLER_SUITE);
+SUITE(HOT_RELOAD_SUITE);
 
 #endif
@@ -0,0 +1,144 @@
+#include "../src/headers/tokenizer.h"
+
+#include <string.h>
+
+#include "greatest.h"
+
+// Long enough for every run to cross a few SIMD blocks
+#define MAX_RUN 80
+
+static Token* tokenAt(TokenLines* lines, size_t line, size_t token) {
+    TokenLine* l = get_vec(&lines->lines, line);
+    if (token >= l->count) return NULL;
+    return firstToken(lines, l) + token;
+}
+
+static bool substrIs(const Token* token, const char* expected) {
+    return token->substr.len == strlen(expected) &&
+           memcmp(token->substr.str, expected, token->substr.len) == 0;
+}
+
+// Runs of every length from 0 to MAX_RUN, so each one ends at every position within a block
+TEST runs_end_at_every_offset(void) {
+    for (size_t n = 0; n <= MAX_RUN; ++n) {
+        char label[MAX_RUN + 3];
+        char comment[MAX_RUN + 3];
+        char src[4 * MAX_RUN + 32];
+
+        memset(label, 'a', n + 1);
+        label[n / 2] = '_';
+        label[n + 1] = ':';
+        label[n + 2] = '\0';
+
+        comment[0] = ';';
+        memset(comment + 1, 'x', n);
+        comment[n + 1] = '\0';
+
+        snprintf(src, sizeof(src), "%*s%s %s\n\nADD 1", (int)n, "", label, comment);
+
+        TokenLines lines = tokenizeProgram(from_cstr_slice(src, strlen(src)), NULL);
+
+        ASSERT_EQ(2, len_vec(&lines.lines));
+        ASSERT_EQ(4, len_vec(&lines.tokens));
+
+        Token* def = tokenAt(&lines, 0, 0);
+        ASSERT_EQ(LABEL_DEF_T, def->tok);
+        ASSERT_EQ(n, def->char_nr);
+        ASSERT(substrIs(def, label));
+
+        Token* com = tokenAt(&lines, 0, 1);
+        ASSERT_EQ(COMMENT_T, com->tok);
+        ASSERT(substrIs(com, comment));
+
+        TokenLine* add = get_vec(&lines.lines, 1);
+        ASSERT_EQ(3, add->line_nr);
+        ASSERT_EQ(ADD_T, tokenAt(&lines, 1, 0)->tok);
+        ASSERT(substrIs(tokenAt(&lines, 1, 1), "1"));
+
+        freeTokenLines(&lines);
+    }
+
+    PASS();
+}
+
+TEST quoted_bytes_of_every_length(void) {
+    for (size_t n = 0; n <= MAX_RUN; ++n) {
+        char src[MAX_RUN + 16];
+
+        src[0] = '"';
+        memset(src + 1, 'q', n);
+        strcpy(src + 1 + n, "\" 7\n");
+
+        TokenLines lines = tokenizeProgram(from_cstr_slice(src, strlen(src)), NULL);
+
+        ASSERT_EQ(1, len_vec(&lines.lines));
+        Token* quoted = tokenAt(&lines, 0, 0);
+        ASSERT_EQ(QUOTED_BYTES_T, quoted->tok);
+        ASSERT_EQ(n + 2, quoted->substr.len);
+        ASSERT(substrIs(tokenAt(&lines, 0, 1), "7"));
+
+        freeTokenLines(&lines);
+    }
+
+    PASS();
+}
+
+// Scans only look at the slice, even when what comes after it would continue the run
+TEST scans_stop_at_the_end(void) {
+    const char* src = "; a comment that continues past the slice\nNOOP";
+
+    for (size_t len = 1; len < strlen(src); ++len) {
+        TokenLines lines = tokenizeProgram(from_cstr_slice(src, len), NULL);
+        const size_t comment_len = len < 42 ? len : 41;
+
+        ASSERT(len_vec(&lines.lines) >= 1);
+        ASSERT_EQ(COMMENT_T, tokenAt(&lines, 0, 0)->tok);
+        ASSERT_EQ(comment_len, tokenAt(&lines, 0, 0)->substr.len);
+
+        freeTokenLines(&lines);
+    }
+
+    PASS();
+}
+
+TEST nul_ends_the_program(void) {
+    const char src[] = "NOOP ; comment\0 HALT\nHALT";
+
+    TokenLines lines = tokenizeProgram(from_cstr_slice(src, sizeof(src) - 1), NULL);
+
+    ASSERT_EQ(1, len_vec(&lines.lines));
+    ASSERT_EQ(2, len_vec(&lines.tokens));
+    ASSERT(substrIs(tokenAt(&lines, 0, 1), "; comment"));
+
+    freeTokenLines(&lines);
+    PASS();
+}
+
+TEST labels_share_an_id(void) {
+    const char src[] = "JMP .end\nLOAD end[1]\nend:\nstart:\nCALL .start\nADD 1";
+
+    TokenLines lines = tokenizeProgram(from_cstr_slice(src, sizeof(src) - 1), NULL);
+
+    ASSERT_EQ(2, labelCount(&lines));
+    const uint32_t end = tokenAt(&lines, 0, 1)->label;
+    ASSERT_EQ(end, tokenAt(&lines, 1, 1)->label);
+    ASSERT_EQ(end, tokenAt(&lines, 2, 0)->label);
+    ASSERT(tokenAt(&lines, 3, 0)->label != end);
+    ASSERT_EQ(tokenAt(&lines, 3, 0)->label, tokenAt(&lines, 4, 1)->label);
+    ASSERT_EQ(NO_LABEL, tokenAt(&lines, 5, 1)->label);
+
+    slice_t name = labelName(&lines, end);
+    ASSERT_EQ(3, name.len);
+    ASSERT_MEM_EQ("end", name.str, 3);
+
+    freeTokenLines(&lines);
+    PASS();
+}
+
+SUITE(TOKENIZER_SUITE) {
+    RUN_TEST(runs_end_at_every_offset);
+    RUN_TEST(quoted_bytes_of_every_length);
+    RUN_TEST(scans_stop_at_the_end);
+    RUN_TEST(nul_ends_the_program);
+    RUN_TEST(labels_share_an_id);
+}
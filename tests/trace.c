@@ -0,0 +1,158 @@
+#include "../src/headers/trace.h"
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+static const char* loop_src =
+    "    LOAD 200\n"
+    "    STORE R0\n"
+    "loop:\n"
+    "    DEC R0\n"
+    "    JNZ .loop\n"
+    "HALT\n";
+
+// LOAD, STORE, 200 times DEC and JNZ
+#define LOOP_INSTRUCTIONS 402
+
+TEST ring_keeps_last_instructions(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+
+    Trace trace;
+    initTrace(&trace, 100);
+    ASSERT_EQ(128, trace.capacity);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    runCpuTraced(&cpu, &trace);
+
+    ASSERT_EQ(LOOP_INSTRUCTIONS, atomic_load(&trace.head));
+
+    const char* file = "trace_ring_test.bin";
+    ASSERT(dumpTrace(&trace, file));
+
+    vec_t records = new_vec(128, sizeof(TraceRecord));
+    ASSERT(readTrace(file, &records));
+    remove(file);
+
+    ASSERT_EQ(127, records.len);
+
+    const TraceRecord* last = last_vec(&records);
+    ASSERT_EQ(LOOP_INSTRUCTIONS - 1, last->cycle);
+    ASSERT_EQ(OP_JNZ, last->opcode);
+    ASSERT_EQ(200, last->acc);
+
+    const TraceRecord* dec = get_vec(&records, records.len - 2);
+    ASSERT_EQ(OP_DEC_R0, dec->opcode);
+    ASSERT_EQ(*get_map(&exec.labels, static_slice("loop")), dec->pc);
+    ASSERT_EQ(LOOP_INSTRUCTIONS - 2, dec->cycle);
+
+    free_vec(&records, NULL);
+    freeTrace(&trace);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+TEST writer_streams_every_instruction(void) {
+    const char* path = "loop";
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice(path));
+
+    // large enough that the writer can't fall behind
+    Trace trace;
+    initTrace(&trace, 1024);
+
+    const char* file = "trace_stream_test.bin";
+    ASSERT(startTraceWriter(&trace, file));
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, exec.executable, exec.size);
+    runCpuTraced(&cpu, &trace);
+
+    ASSERT_EQ(0, stopTraceWriter(&trace));
+
+    vec_t records = new_vec(512, sizeof(TraceRecord));
+    ASSERT(readTrace(file, &records));
+    remove(file);
+
+    ASSERT_EQ(LOOP_INSTRUCTIONS, records.len);
+    for (size_t i = 0; i < records.len; ++i) {
+        ASSERT_EQ(i, ((TraceRecord*)get_vec(&records, i))->cycle);
+    }
+
+    const TraceRecord* load = first_vec(&records);
+    ASSERT_EQ(PROGRAM_START, load->pc);
+    ASSERT_EQ(OP_LOAD_I, load->opcode);
+    ASSERT_EQ(200, load->operands[0]);
+    ASSERT_EQ(200, load->acc);
+
+    free_vec(&records, NULL);
+    freeTrace(&trace);
+    freeCpu(&cpu);
+    freeExecutable(&exec);
+
+    PASS();
+}
+
+#ifndef _WIN32
+TEST crash_dumps_the_ring(void) {
+    Executable exec = assemble(from_cstr_slice(loop_src, strlen(loop_src)), static_slice("loop"));
+    const char* file = "trace_crash_test.bin";
+    remove(file);
+
+    // the dump has to come out of a process that's really dying
+    const pid_t child = fork();
+    ASSERT(child >= 0);
+    if (child == 0) {
+        Trace trace;
+        initTrace(&trace, 100);
+        CPU cpu;
+        initCpu(&cpu);
+        loadProgram(&cpu, exec.executable, exec.size);
+        runCpuTraced(&cpu, &trace);
+
+        if (!dumpTraceOnSignal(&trace, file)) _exit(1);
+        abort();
+    }
+
+    int status;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT(WIFSIGNALED(status));
+    ASSERT_EQ(SIGABRT, WTERMSIG(status));
+
+    vec_t records = new_vec(128, sizeof(TraceRecord));
+    ASSERT(readTrace(file, &records));
+    remove(file);
+
+    ASSERT_EQ(127, records.len);
+    const TraceRecord* last = last_vec(&records);
+    ASSERT_EQ(LOOP_INSTRUCTIONS - 1, last->cycle);
+    ASSERT_EQ(OP_JNZ, last->opcode);
+
+    free_vec(&records, NULL);
+    freeExecutable(&exec);
+
+    PASS();
+}
+#endif
+
+SUITE(TRACE_SUITE) {
+    RUN_TEST(ring_keeps_last_instructions);
+    RUN_TEST(writer_streams_every_instruction);
+#ifndef _WIN32
+    RUN_TEST(crash_dumps_the_ring);
+#endif
+}
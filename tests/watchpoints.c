@@ -0,0 +1,144 @@
+#include "../src/headers/watchpoints.h"
+
+#include "../src/headers/instructions.h"
+#include "greatest.h"
+
+typedef struct Hits {
+    size_t count;
+    WatchHit last;
+} Hits;
+
+static void recordHit(CPU* cpu, const WatchHit* hit, void* data) {
+    UNUSED(cpu);
+    Hits* hits = (Hits*)data;
+    hits->count++;
+    hits->last = *hit;
+}
+
+// LOAD 7, STORE 0x9fed, LOAD 0x9fed, STORE 0x9000, HALT
+static const uint8_t ring_program[] = {
+    OP_LOAD_I,   7,    OP_STORE_IM, 0x9f, 0xed, OP_LOAD_IM, 0x9f, 0xed,
+    OP_STORE_IM, 0x90, 0x00,        OP_HALT,
+};
+
+TEST watch_writes_to_ring_buffer(void) {
+    static Watchpoints w;
+    Hits hits = {0};
+    initWatchpoints(&w, recordHit, &hits);
+    watchRange(&w, INPUT_WRITE_IDX, INPUT_RINGBUF + INPUT_BUF_SIZE - 1, WATCH_WRITE);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, ring_program, sizeof(ring_program));
+    cpu.program_counter = 0;
+
+    runCpuWatched(&cpu, &w);
+
+    ASSERT_EQ(1, hits.count);
+    ASSERT_EQ(2, hits.last.pc);
+    ASSERT_EQ(INPUT_WRITE_IDX, hits.last.addr);
+    ASSERT_EQ(WATCH_WRITE, hits.last.kind);
+    ASSERT_EQ(0, hits.last.old_value);
+    ASSERT_EQ(7, hits.last.new_value);
+    ASSERT_EQ(7, cpu.memory[0x9000]);
+    ASSERT_EQ(NULL, cpu.watchpoints);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST watch_reads(void) {
+    static Watchpoints w;
+    Hits hits = {0};
+    initWatchpoints(&w, recordHit, &hits);
+    watchRange(&w, INPUT_WRITE_IDX, INPUT_WRITE_IDX, WATCH_READ);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, ring_program, sizeof(ring_program));
+    cpu.program_counter = 0;
+
+    runCpuWatched(&cpu, &w);
+
+    ASSERT_EQ(1, hits.count);
+    ASSERT_EQ(5, hits.last.pc);
+    ASSERT_EQ(WATCH_READ, hits.last.kind);
+    ASSERT_EQ(7, hits.last.old_value);
+
+    // nothing left to watch
+    unwatchRange(&w, INPUT_WRITE_IDX, INPUT_WRITE_IDX, WATCH_READ);
+    cpu.program_counter = 0;
+    runCpuWatched(&cpu, &w);
+    ASSERT_EQ(1, hits.count);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST read_modify_write_hits_once(void) {
+    static Watchpoints w;
+    Hits hits = {0};
+    initWatchpoints(&w, recordHit, &hits);
+    watchRange(&w, 0x1234, 0x1234, WATCH_READ | WATCH_WRITE);
+
+    const uint8_t program[] = {OP_INC_MHL, OP_HALT};
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, program, sizeof(program));
+    cpu.program_counter = 0;
+    cpu.registers.reg_H = 0x12;
+    cpu.registers.reg_L = 0x34;
+    cpu.memory[0x1234] = 41;
+
+    runCpuWatched(&cpu, &w);
+
+    ASSERT_EQ(1, hits.count);
+    ASSERT_EQ(WATCH_WRITE, hits.last.kind);
+    ASSERT_EQ(41, hits.last.old_value);
+    ASSERT_EQ(42, hits.last.new_value);
+
+    freeCpu(&cpu);
+
+    PASS();
+}
+
+TEST watch_write_under_breakpoint(void) {
+    static Watchpoints w;
+    Hits hits = {0};
+    initWatchpoints(&w, recordHit, &hits);
+    watchRange(&w, 0x9000, 0x9000, WATCH_WRITE);
+
+    Breakpoints bps;
+    initBreakpoints(&bps, NULL, NULL);
+
+    CPU cpu;
+    initCpu(&cpu);
+    loadProgram(&cpu, ring_program, sizeof(ring_program));
+    cpu.program_counter = 0;
+    cpu.breakpoints = &bps;
+    // the STORE to 0x9000 runs from the BRK covering it
+    ASSERT(setBreakpoint(&cpu, 8));
+
+    runCpuWatched(&cpu, &w);
+
+    ASSERT_EQ(1, hits.count);
+    ASSERT_EQ(8, hits.last.pc);
+    ASSERT_EQ(0x9000, hits.last.addr);
+    ASSERT_EQ(WATCH_WRITE, hits.last.kind);
+    ASSERT_EQ(7, hits.last.new_value);
+
+    freeCpu(&cpu);
+    freeBreakpoints(&bps);
+
+    PASS();
+}
+
+SUITE(WATCHPOINTS_SUITE) {
+    RUN_TEST(watch_writes_to_ring_buffer);
+    RUN_TEST(watch_reads);
+    RUN_TEST(read_modify_write_hits_once);
+    RUN_TEST(watch_write_under_breakpoint);
+}
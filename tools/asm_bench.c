@@ -0,0 +1,354 @@
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/util.h"
+
+#define USAGE                                                                        \
+    "USAGE: build/asm-bench [options]\n"                                             \
+    "\n"                                                                             \
+    "OPTIONS:\n"                                                                     \
+    "    --lines <n>       size of the generated program in lines, default 200000\n" \
+    "    --repeat <n>      assemble it <n> times and report the median, default 5\n" \
+    "    --chunks <n>      split it into <n> chunks, default one per core for large sources\n" \
+    "    --json <file>     also write the results to <file> as JSON, - for stdout\n" \
+    "    --save <file>     write the generated program to <file>\n"
+
+#define DEFAULT_LINES 200000
+#define DEFAULT_REPEAT 5
+#define MAX_REPEAT 101
+// lines of comments in front of every generated function
+#define COMMENT_LINES 6
+
+typedef struct Options {
+    size_t lines;
+    size_t repeat;
+    // 0 leaves it to `assemble`
+    size_t chunks;
+    const char* json;
+    const char* save;
+} Options;
+
+// Phases of `assembleWithHook` plus the total
+#define PHASE_COUNT 4
+static const char* PHASE_NAMES[PHASE_COUNT] = {"tokenize", "pass1", "pass2", "total"};
+
+/// What happened during one phase of one run
+typedef struct PhaseSample {
+    double ns;
+    size_t allocations;
+    // most bytes allocated at once during the phase, including what was live when it started
+    size_t peak_bytes;
+} PhaseSample;
+
+typedef struct Run {
+    PhaseSample phases[PHASE_COUNT];
+    uint64_t started;
+    AssemblerPhase current;
+} Run;
+
+// Allocation counters, every malloc, calloc and realloc of the assembler goes through the
+// wrappers below since this tool is linked with --wrap for each of them.
+
+static size_t allocations;
+static size_t live_bytes;
+static size_t peak_bytes;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+static void* counted(void* ptr) {
+    if (ptr != NULL) {
+        allocations++;
+        live_bytes += malloc_usable_size(ptr);
+        peak_bytes = live_bytes > peak_bytes ? live_bytes : peak_bytes;
+    }
+    return ptr;
+}
+
+void* __wrap_malloc(size_t size) { return counted(__real_malloc(size)); }
+
+void* __wrap_calloc(size_t count, size_t size) { return counted(__real_calloc(count, size)); }
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    const size_t old = ptr != NULL ? malloc_usable_size(ptr) : 0;
+    void* res = __real_realloc(ptr, size);
+
+    if (res != NULL) {
+        live_bytes -= old;
+    }
+    return counted(res);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr != NULL) {
+        live_bytes -= malloc_usable_size(ptr);
+    }
+    __real_free(ptr);
+}
+
+static bool parseArgs(int argc, char** argv, Options* options) {
+    *options = (Options){
+        .lines = DEFAULT_LINES, .repeat = DEFAULT_REPEAT, .chunks = 0, .json = NULL, .save = NULL};
+
+    for (int i = 1; i < argc; ++i) {
+        const char* opt = argv[i];
+        bool takes_value = strcmp(opt, "--lines") == 0 || strcmp(opt, "--repeat") == 0 ||
+                           strcmp(opt, "--chunks") == 0 || strcmp(opt, "--json") == 0 ||
+                           strcmp(opt, "--save") == 0;
+
+        if (takes_value && ++i == argc) {
+            printf("%s expects a value\n", opt);
+            return false;
+        }
+
+        if (strcmp(opt, "--lines") == 0) {
+            options->lines = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->lines == 0) {
+                printf("--lines expects a positive number\n");
+                return false;
+            }
+        } else if (strcmp(opt, "--repeat") == 0) {
+            options->repeat = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->repeat == 0 || options->repeat > MAX_REPEAT) {
+                printf("--repeat expects a number from 1 to %d\n", MAX_REPEAT);
+                return false;
+            }
+        } else if (strcmp(opt, "--chunks") == 0) {
+            options->chunks = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->chunks == 0) {
+                printf("--chunks expects a positive number\n");
+                return false;
+            }
+        } else if (strcmp(opt, "--json") == 0) {
+            options->json = argv[i];
+        } else if (strcmp(opt, "--save") == 0) {
+            options->save = argv[i];
+        } else {
+            printf("unknown option '%s'\n", opt);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void pushCstr(string_t* str, const char* s) { push_cstr_str(str, s, strlen(s)); }
+
+// Labels can't contain digits, so numbers are spelled with letters: 0 is "a", 26 is "ba"
+static void pushName(string_t* str, const char* prefix, size_t n) {
+    char letters[16];
+    size_t len = 0;
+
+    do {
+        letters[len++] = (char)('a' + n % 26);
+        n /= 26;
+    } while (n > 0);
+
+    pushCstr(str, prefix);
+    while (len > 0) {
+        push_str(str, letters[--len]);
+    }
+}
+
+/// Builds a program of at least `lines` lines out of small functions. Every function starts with
+/// a block of comments, calls and jumps forward into functions further down the file and indexes
+/// its own data and the next function's data with `label[idx]`.
+static string_t generateProgram(size_t lines, size_t* line_count) {
+    // the lines of one function below
+    const size_t per_function = COMMENT_LINES + 20;
+    const size_t functions = (lines + per_function - 1) / per_function;
+    string_t src = new_str(lines * 24);
+
+    for (size_t f = 0; f < functions; ++f) {
+        const size_t next = (f + 1) % functions;
+        const size_t far = (f + 97) % functions;
+
+        for (size_t c = 0; c < COMMENT_LINES; ++c) {
+            pushCstr(&src, "; generated helper, keeps the running total in HL and the loop count "
+                           "in R0\n");
+        }
+
+        pushName(&src, "fn_", f);
+        pushCstr(&src, ":\n    LOAD 12\n    STORE R0\n");
+        pushName(&src, "loop_", f);
+        pushCstr(&src, ":\n    LOAD 0\n    STORE H\n    LOAD R0\n    STORE L\n    LOAD ");
+        pushName(&src, "data_", f);
+        pushCstr(&src, "[HL]\n    ADD ");
+        pushName(&src, "data_", next);
+        pushCstr(&src, "[3]\n    STORE ");
+        pushName(&src, "data_", f);
+        pushCstr(&src, "[1]\n    CALL .");
+        pushName(&src, "fn_", next);
+        pushCstr(&src, "\n    DEC R0\n    JNZ .");
+        pushName(&src, "loop_", f);
+        pushCstr(&src, "\n    CMP 7 ; rarely true\n    JZ .");
+        pushName(&src, "fn_", far);
+        pushCstr(&src, "\n    RET\n");
+        pushName(&src, "data_", f);
+        pushCstr(&src, ":\n    1 2 3 4 5 6 7 8\n\n");
+    }
+
+    *line_count = functions * per_function;
+    return src;
+}
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void finishPhase(Run* run, uint64_t now) {
+    PhaseSample* phase = &run->phases[run->current];
+    phase->ns = (double)(now - run->started);
+    phase->allocations = allocations;
+    phase->peak_bytes = peak_bytes;
+}
+
+static void onPhase(AssemblerPhase phase, void* data) {
+    Run* run = (Run*)data;
+    const uint64_t now = nowNs();
+
+    if (phase != TOKENIZE_PHASE) {
+        finishPhase(run, now);
+    }
+
+    run->current = phase;
+    run->started = nowNs();
+    allocations = 0;
+    peak_bytes = live_bytes;
+}
+
+static void assembleOnce(slice_t program, size_t chunks, Run* run) {
+    *run = (Run){0};
+
+    const uint64_t start = nowNs();
+    Executable exec =
+        chunks == 0 ? assembleWithHook(program, static_slice("generated"), onPhase, run)
+                    : assembleInChunks(program, static_slice("generated"), chunks, onPhase, run);
+    const uint64_t end = nowNs();
+
+    size_t total_allocations = 0;
+    size_t total_peak = 0;
+    for (size_t p = 0; p < PHASE_COUNT - 1; ++p) {
+        total_allocations += run->phases[p].allocations;
+        total_peak = max(total_peak, run->phases[p].peak_bytes);
+    }
+    run->phases[PHASE_COUNT - 1] =
+        (PhaseSample){.ns = (double)(end - start),
+                      .allocations = total_allocations,
+                      .peak_bytes = total_peak};
+
+    freeExecutable(&exec);
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double medianNs(const Run* runs, size_t count, size_t phase) {
+    double ns[MAX_REPEAT];
+    for (size_t i = 0; i < count; ++i) {
+        ns[i] = runs[i].phases[phase].ns;
+    }
+    qsort(ns, count, sizeof(double), compareDoubles);
+
+    return count % 2 == 1 ? ns[count / 2] : (ns[count / 2 - 1] + ns[count / 2]) / 2.0;
+}
+
+static void writeJson(FILE* out, const Run* runs, const Options* options, size_t lines,
+                      size_t bytes) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"version\": 1,\n");
+    fprintf(out, "  \"repeat\": %zu,\n", options->repeat);
+    fprintf(out, "  \"lines\": %zu,\n", lines);
+    fprintf(out, "  \"bytes\": %zu,\n", bytes);
+    fprintf(out, "  \"phases\": [\n");
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        const double med = medianNs(runs, options->repeat, p);
+
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": \"%s\",\n", PHASE_NAMES[p]);
+        fprintf(out, "      \"median_ms\": %.3f,\n", med / 1e6);
+        fprintf(out, "      \"lines_per_second\": %.0f,\n", (double)lines / med * 1e9);
+        fprintf(out, "      \"mb_per_second\": %.2f,\n", (double)bytes / med * 1e3);
+        fprintf(out, "      \"allocations\": %zu,\n", runs[0].phases[p].allocations);
+        fprintf(out, "      \"peak_bytes\": %zu,\n", runs[0].phases[p].peak_bytes);
+        fprintf(out, "      \"runs_ms\": [");
+        for (size_t r = 0; r < options->repeat; ++r) {
+            fprintf(out, r == 0 ? "%.3f" : ", %.3f", runs[r].phases[p].ns / 1e6);
+        }
+        fprintf(out, "]\n");
+        fprintf(out, "    }%s\n", p + 1 < PHASE_COUNT ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parseArgs(argc, argv, &options)) {
+        printf(USAGE);
+        return 1;
+    }
+
+    size_t lines;
+    string_t program = generateProgram(options.lines, &lines);
+
+    if (options.save != NULL) {
+        write_file(options.save, from_str_slice(program));
+    }
+
+    static Run runs[MAX_REPEAT];
+    for (size_t i = 0; i < options.repeat; ++i) {
+        assembleOnce(from_str_slice(program), options.chunks, &runs[i]);
+    }
+
+    // the table goes to stderr when the JSON goes to stdout
+    FILE* table = options.json != NULL && strcmp(options.json, "-") == 0 ? stderr : stdout;
+
+    fprintf(table, "%zu lines, %.2f MB, median of %zu runs\n", lines,
+            (double)program.len / 1e6, options.repeat);
+    fprintf(table, "%-10s %11s %14s %9s %12s %12s\n", "phase", "median ms", "lines/s", "MB/s",
+            "allocations", "peak KB");
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        const double med = medianNs(runs, options.repeat, p);
+
+        fprintf(table, "%-10s %11.3f %14.0f %9.2f %12zu %12zu\n", PHASE_NAMES[p], med / 1e6,
+                (double)lines / med * 1e9, (double)program.len / med * 1e3,
+                runs[0].phases[p].allocations, runs[0].phases[p].peak_bytes / 1024);
+    }
+
+    if (options.json != NULL) {
+        const bool to_stdout = strcmp(options.json, "-") == 0;
+        FILE* out = to_stdout ? stdout : fopen(options.json, "w");
+
+        if (out == NULL) {
+            printf("couldn't open '%s' for writing\n", options.json);
+            free_str(&program);
+            return 1;
+        }
+        writeJson(out, runs, &options, lines, program.len);
+        if (!to_stdout) {
+            fclose(out);
+        }
+    }
+
+    free_str(&program);
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/headers/str_int_map.h"
+
+#define USAGE                                                                        \
+    "USAGE: build/map-bench [options]\n"                                             \
+    "\n"                                                                             \
+    "OPTIONS:\n"                                                                     \
+    "    --labels <n>      number of distinct labels, default 100000\n"              \
+    "    --repeat <n>      time every operation <n> times and report the median, "   \
+    "default 7\n"                                                                    \
+    "    --json <file>     also write the results to <file> as JSON, - for stdout\n"
+
+#define DEFAULT_LABELS 100000
+#define DEFAULT_REPEAT 7
+#define MAX_REPEAT 101
+
+typedef struct Options {
+    size_t labels;
+    size_t repeat;
+    const char* json;
+} Options;
+
+// The chained map str_int_map.c used to be, kept here to compare against: one bucket array plus
+// a malloc per collision, every key copied with strndup and copied again whenever it grows.
+
+typedef struct chained_bucket {
+    slice_t key;
+    size_t value;
+    struct chained_bucket* next;
+} chained_bucket;
+
+typedef struct chained_map {
+    size_t capacity;
+    size_t len;
+    chained_bucket* buckets;
+} chained_map;
+
+static chained_map chained_new(size_t capacity) {
+    return (chained_map){.capacity = capacity,
+                         .len = 0,
+                         .buckets = calloc(capacity, sizeof(chained_bucket))};
+}
+
+static void chained_free(chained_map* map) {
+    for (size_t i = 0; i < map->capacity; ++i) {
+        chained_bucket* bucket = &map->buckets[i];
+        chained_bucket* current = bucket->next;
+        while (current != NULL) {
+            chained_bucket* next = current->next;
+            free((void*)current->key.str);
+            free(current);
+            current = next;
+        }
+        free((void*)bucket->key.str);
+    }
+    free(map->buckets);
+}
+
+static size_t* chained_get(const chained_map* map, slice_t key) {
+    const chained_bucket* bucket = &map->buckets[hash_str(key) % map->capacity];
+
+    // the original also printed a line for every miss, which is left out so only the lookups
+    // themselves get timed
+    do {
+        if (bucket->key.str == NULL) return NULL;
+        if (cmp_str(bucket->key, key) == 0) return (size_t*)&bucket->value;
+    } while ((bucket = bucket->next));
+
+    return NULL;
+}
+
+static bool chained_insert(chained_map* map, slice_t key, size_t value);
+
+static void chained_grow(chained_map* map) {
+    chained_map grown = chained_new(map->capacity * 2);
+
+    for (size_t i = 0; i < map->capacity; ++i) {
+        for (chained_bucket* b = &map->buckets[i]; b != NULL && b->key.str != NULL; b = b->next) {
+            chained_insert(&grown, b->key, b->value);
+        }
+    }
+
+    chained_free(map);
+    *map = grown;
+}
+
+static bool chained_insert(chained_map* map, slice_t key, size_t value) {
+    if (map->len > map->capacity / 4 * 3) {
+        chained_grow(map);
+    }
+
+    chained_bucket* bucket = &map->buckets[hash_str(key) % map->capacity];
+    do {
+        if (bucket->key.str == NULL) {
+            bucket->key = (slice_t){.str = strndup(key.str, key.len), .len = key.len};
+            bucket->value = value;
+            map->len++;
+            return true;
+        }
+        if (cmp_str(bucket->key, key) == 0) {
+            return false;
+        }
+        if (bucket->next == NULL) {
+            chained_bucket* new = malloc(sizeof(chained_bucket));
+            *new = (chained_bucket){.key = {.str = strndup(key.str, key.len), .len = key.len},
+                                    .value = value,
+                                    .next = NULL};
+            bucket->next = new;
+            map->len++;
+            return true;
+        }
+    } while ((bucket = bucket->next));
+
+    return false;
+}
+
+// What gets timed, in ns per label for both maps
+typedef enum Operation { INSERT_OP, HIT_OP, MISS_OP, OPERATION_COUNT } Operation;
+static const char* OPERATION_NAMES[OPERATION_COUNT] = {"insert", "lookup_hit", "lookup_miss"};
+
+typedef enum MapKind { CHAINED_MAP, OPEN_MAP, MAP_KIND_COUNT } MapKind;
+static const char* MAP_NAMES[MAP_KIND_COUNT] = {"chained", "open_addressing"};
+
+static bool parseArgs(int argc, char** argv, Options* options) {
+    *options = (Options){.labels = DEFAULT_LABELS, .repeat = DEFAULT_REPEAT, .json = NULL};
+
+    for (int i = 1; i < argc; ++i) {
+        const char* opt = argv[i];
+        bool takes_value = strcmp(opt, "--labels") == 0 || strcmp(opt, "--repeat") == 0 ||
+                           strcmp(opt, "--json") == 0;
+
+        if (takes_value && ++i == argc) {
+            printf("%s expects a value\n", opt);
+            return false;
+        }
+
+        if (strcmp(opt, "--labels") == 0) {
+            options->labels = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->labels == 0) {
+                printf("--labels expects a positive number\n");
+                return false;
+            }
+        } else if (strcmp(opt, "--repeat") == 0) {
+            options->repeat = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->repeat == 0 || options->repeat > MAX_REPEAT) {
+                printf("--repeat expects a number from 1 to %d\n", MAX_REPEAT);
+                return false;
+            }
+        } else if (strcmp(opt, "--json") == 0) {
+            options->json = argv[i];
+        } else {
+            printf("unknown option '%s'\n", opt);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Labels that look like the ones in real programs: a few words joined by underscores
+static char* makeLabels(size_t count, const char* prefix, slice_t* labels) {
+    static const char* WORDS[] = {"loop", "end", "draw", "sprite", "next", "check",
+                                  "init", "data", "table", "read",   "key",  "update"};
+    const size_t word_count = sizeof(WORDS) / sizeof(WORDS[0]);
+    char* text = malloc(count * 48);
+    size_t used = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const int len = snprintf(text + used, 48, "%s%s_%s_%zx", prefix, WORDS[i % word_count],
+                                 WORDS[(i / word_count) % word_count], i);
+        labels[i] = (slice_t){.str = text + used, .len = (size_t)len};
+        used += (size_t)len;
+    }
+
+    return text;
+}
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// keeps the lookups from being optimized out
+static volatile size_t sink;
+
+// Times every operation once on `kind`, returns the ns per label of each
+static void timeMap(MapKind kind, const slice_t* labels, const slice_t* missing, size_t count,
+                    double* ns) {
+    chained_map chained = chained_new(DEFAULT_MAP_CAPACITY);
+    si_map_t open = new_map();
+    uint64_t start;
+
+    start = nowNs();
+    for (size_t i = 0; i < count; ++i) {
+        if (kind == CHAINED_MAP) {
+            chained_insert(&chained, labels[i], i);
+        } else {
+            insert_map(&open, labels[i], i);
+        }
+    }
+    ns[INSERT_OP] = (double)(nowNs() - start) / (double)count;
+
+    for (Operation op = HIT_OP; op <= MISS_OP; ++op) {
+        const slice_t* keys = op == HIT_OP ? labels : missing;
+
+        start = nowNs();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t* value = kind == CHAINED_MAP ? chained_get(&chained, keys[i])
+                                                      : get_map(&open, keys[i]);
+            sink += value != NULL ? *value : 1;
+        }
+        ns[op] = (double)(nowNs() - start) / (double)count;
+    }
+
+    chained_free(&chained);
+    free_map(&open);
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double* ns, size_t count) {
+    qsort(ns, count, sizeof(double), compareDoubles);
+    return count % 2 == 1 ? ns[count / 2] : (ns[count / 2 - 1] + ns[count / 2]) / 2.0;
+}
+
+static void writeJson(FILE* out, double medians[MAP_KIND_COUNT][OPERATION_COUNT],
+                      const Options* options) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"version\": 1,\n");
+    fprintf(out, "  \"repeat\": %zu,\n", options->repeat);
+    fprintf(out, "  \"labels\": %zu,\n", options->labels);
+    fprintf(out, "  \"maps\": [\n");
+
+    for (MapKind kind = 0; kind < MAP_KIND_COUNT; ++kind) {
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": \"%s\",\n", MAP_NAMES[kind]);
+        for (Operation op = 0; op < OPERATION_COUNT; ++op) {
+            fprintf(out, "      \"%s_ns\": %.2f%s\n", OPERATION_NAMES[op], medians[kind][op],
+                    op + 1 < OPERATION_COUNT ? "," : "");
+        }
+        fprintf(out, "    }%s\n", kind + 1 < MAP_KIND_COUNT ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parseArgs(argc, argv, &options)) {
+        printf(USAGE);
+        return 1;
+    }
+
+    slice_t* labels = malloc(options.labels * sizeof(slice_t));
+    slice_t* missing = malloc(options.labels * sizeof(slice_t));
+    char* label_text = makeLabels(options.labels, "", labels);
+    char* missing_text = makeLabels(options.labels, "x", missing);
+
+    static double ns[MAP_KIND_COUNT][OPERATION_COUNT][MAX_REPEAT];
+    double medians[MAP_KIND_COUNT][OPERATION_COUNT];
+
+    for (size_t r = 0; r < options.repeat; ++r) {
+        for (MapKind kind = 0; kind < MAP_KIND_COUNT; ++kind) {
+            double run[OPERATION_COUNT];
+            timeMap(kind, labels, missing, options.labels, run);
+            for (Operation op = 0; op < OPERATION_COUNT; ++op) {
+                ns[kind][op][r] = run[op];
+            }
+        }
+    }
+
+    // the table goes to stderr when the JSON goes to stdout
+    FILE* table = options.json != NULL && strcmp(options.json, "-") == 0 ? stderr : stdout;
+
+    fprintf(table, "%zu labels, median ns per label of %zu runs\n", options.labels,
+            options.repeat);
+    fprintf(table, "%-16s %12s %12s %12s\n", "map", "insert", "lookup hit", "lookup miss");
+
+    for (MapKind kind = 0; kind < MAP_KIND_COUNT; ++kind) {
+        for (Operation op = 0; op < OPERATION_COUNT; ++op) {
+            medians[kind][op] = median(ns[kind][op], options.repeat);
+        }
+        fprintf(table, "%-16s %12.2f %12.2f %12.2f\n", MAP_NAMES[kind], medians[kind][INSERT_OP],
+                medians[kind][HIT_OP], medians[kind][MISS_OP]);
+    }
+
+    if (options.json != NULL) {
+        const bool to_stdout = strcmp(options.json, "-") == 0;
+        FILE* out = to_stdout ? stdout : fopen(options.json, "w");
+
+        if (out == NULL) {
+            printf("couldn't open '%s' for writing\n", options.json);
+            return 1;
+        }
+        writeJson(out, medians, &options);
+        if (!to_stdout) {
+            fclose(out);
+        }
+    }
+
+    free(labels);
+    free(missing);
+    free(label_text);
+    free(missing_text);
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/headers/assembler.h"
+#include "../src/headers/cpu.h"
+#include "../src/headers/instructions.h"
+#include "../src/headers/util.h"
+
+#define USAGE                                                                          \
+    "USAGE: build/vm-bench [options]\n"                                                \
+    "\n"                                                                               \
+    "OPTIONS:\n"                                                                       \
+    "    --repeat <n>          time every benchmark <n> times and report the median, " \
+    "default 7\n"                                                                      \
+    "    --instructions <n>    instructions per timed run, default 10000000\n"         \
+    "    --filter <text>       only run benchmarks with <text> in their name\n"        \
+    "    --json <file>         also write the results to <file> as JSON, - for stdout\n"
+
+#define DEFAULT_REPEAT 7
+#define DEFAULT_INSTRUCTIONS 10000000ULL
+#define MAX_REPEAT 101
+
+typedef struct Options {
+    size_t repeat;
+    uint64_t instructions;
+    const char* filter;
+    const char* json;
+} Options;
+
+typedef enum BenchKind {
+    // a loop written to exercise one class of instructions
+    BENCH_MICRO,
+    // a program from programs/, restarted whenever it halts
+    BENCH_PROGRAM,
+} BenchKind;
+
+typedef struct Benchmark {
+    const char* name;
+    BenchKind kind;
+    // instructions run once before the loop
+    const char* setup;
+    // BENCH_MICRO: repeated `repeat` times, then jumped back to. BENCH_PROGRAM: path to it.
+    const char* body;
+    // how often the body is repeated so the jump back is a small part of what gets measured, only
+    // bodies without labels can be repeated
+    size_t repeat;
+} Benchmark;
+
+typedef struct BenchResult {
+    const Benchmark* bench;
+    // ns per instruction of every run, sorted
+    double ns[MAX_REPEAT];
+    size_t runs;
+} BenchResult;
+
+// clang-format off
+static const Benchmark BENCHMARKS[] = {
+    {"alu_register", BENCH_MICRO, "",
+     "ADD R0\nSUB R1\nAND L\nOR H\nXOR R0\nADC R1\nSBC L\nCMP H\n", 8},
+    {"memory", BENCH_MICRO, "LOAD 0x80\nSTORE H\nLOAD 0x10\nSTORE L\n",
+     "LOAD (HL)\nADD (L)\nSTORE (0x8000)\nXCH (HL)\nLOAD (L)\nINC (HL)\nSUB (0x8001)\n"
+     "STORE (L)\n", 8},
+    {"stack_bp", BENCH_MICRO, "ENTER 4\n",
+     "LOAD {BP - 1}\nADD {BP - 2}\nSTORE {BP - 3}\nINC {BP - 4}\nXCH {BP - 1}\nSUB {BP - 2}\n"
+     "PUSH ACC\nPOP R0\n", 8},
+    {"jumps", BENCH_MICRO, "",
+     "JMP .a\na:\nJNZ .b\nb:\nJZ .c\nc:\nJC .d\nd:\nJNC .e\ne:\nJS .f\nf:\nJNS .g\ng:\n", 1},
+    {"call_ret", BENCH_MICRO, "JMP .loop\nfunc:\nRET\n", "CALL .func\n", 8},
+    {"opw_16bit", BENCH_MICRO, "LOAD 3\nSTORE R0\nLOAD 1\nSTORE R1\nLOAD 2\n",
+     "ADDW 3\nSUBW 1\nMULW 3\nDIVW 2\nADDW R0\nSUBW R1\nMULW ACC\nDIVW R0\n", 8},
+    {"fibonacci", BENCH_PROGRAM, NULL, "programs/fibonacci.casm", 0},
+    {"fib_recursive", BENCH_PROGRAM, NULL, "programs/fib_recursive.casm", 0},
+    {"collatz", BENCH_PROGRAM, NULL, "programs/collatz.casm", 0},
+    {"graphics", BENCH_PROGRAM, NULL, "programs/graphics.casm", 0},
+};
+// clang-format on
+#define BENCHMARK_COUNT (sizeof(BENCHMARKS) / sizeof(Benchmark))
+
+static bool parseArgs(int argc, char** argv, Options* options) {
+    *options = (Options){.repeat = DEFAULT_REPEAT,
+                         .instructions = DEFAULT_INSTRUCTIONS,
+                         .filter = NULL,
+                         .json = NULL};
+
+    for (int i = 1; i < argc; ++i) {
+        const char* opt = argv[i];
+        bool takes_value = strcmp(opt, "--repeat") == 0 || strcmp(opt, "--instructions") == 0 ||
+                           strcmp(opt, "--filter") == 0 || strcmp(opt, "--json") == 0;
+
+        if (takes_value && ++i == argc) {
+            printf("%s expects a value\n", opt);
+            return false;
+        }
+
+        if (strcmp(opt, "--repeat") == 0) {
+            options->repeat = (size_t)strtoul(argv[i], NULL, 10);
+            if (options->repeat == 0 || options->repeat > MAX_REPEAT) {
+                printf("--repeat expects a number from 1 to %d\n", MAX_REPEAT);
+                return false;
+            }
+        } else if (strcmp(opt, "--instructions") == 0) {
+            options->instructions = strtoull(argv[i], NULL, 10);
+            if (options->instructions == 0) {
+                printf("--instructions expects a positive number\n");
+                return false;
+            }
+        } else if (strcmp(opt, "--filter") == 0) {
+            options->filter = argv[i];
+        } else if (strcmp(opt, "--json") == 0) {
+            options->json = argv[i];
+        } else {
+            printf("unknown option '%s'\n", opt);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Turns a micro benchmark into a program: the setup, then the body in an endless loop
+static string_t microSource(const Benchmark* bench) {
+    string_t src = new_str(256);
+
+    push_cstr_str(&src, bench->setup, strlen(bench->setup));
+    push_cstr_str(&src, "loop:\n", strlen("loop:\n"));
+    for (size_t i = 0; i < bench->repeat; ++i) {
+        push_cstr_str(&src, bench->body, strlen(bench->body));
+    }
+    push_cstr_str(&src, "JMP .loop\n", strlen("JMP .loop\n"));
+
+    return src;
+}
+
+static bool assembleBenchmark(const Benchmark* bench, Executable* exec) {
+    string_t src = bench->kind == BENCH_MICRO ? microSource(bench) : read_file_to_str(bench->body);
+    // read_file_to_str returns an empty string for missing files
+    if (src.len == 0) {
+        free_str(&src);
+        return false;
+    }
+
+    const char* path = bench->kind == BENCH_MICRO ? bench->name : bench->body;
+    *exec = assemble(from_str_slice(src), from_cstr_slice(path, strlen(path)));
+    free_str(&src);
+
+    return exec->executable != NULL;
+}
+
+static uint64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Runs at most `budget` instructions, stopping like `runCpu` once the next one is a HALT
+static uint64_t runFor(CPU* cpu, uint64_t budget) {
+    uint64_t executed = 0;
+
+    while (executed < budget) {
+        executed++;
+        if (stepCpu(cpu) == OP_HALT) break;
+    }
+
+    return executed;
+}
+
+// Times exactly `instructions` instructions, restarting the program every time it halts
+static double timeRun(CPU* cpu, uint64_t instructions) {
+    uint64_t executed = 0;
+
+    resetCpu(cpu);
+    const uint64_t start = nowNs();
+    while (executed < instructions) {
+        executed += runFor(cpu, instructions - executed);
+        if (executed < instructions) {
+            resetCpu(cpu);
+        }
+    }
+    const uint64_t end = nowNs();
+
+    return (double)(end - start) / (double)instructions;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(const BenchResult* r) {
+    return r->runs % 2 == 1 ? r->ns[r->runs / 2]
+                            : (r->ns[r->runs / 2 - 1] + r->ns[r->runs / 2]) / 2.0;
+}
+
+static bool runBenchmark(const Benchmark* bench, const Options* options, BenchResult* result) {
+    Executable exec;
+    if (!assembleBenchmark(bench, &exec)) {
+        return false;
+    }
+
+    uint8_t* baseline = (uint8_t*)calloc(MEMORY_SIZE, sizeof(uint8_t));
+    if (baseline == NULL) {
+        exit(1);
+    }
+    memcpy(baseline, exec.executable, exec.size);
+
+    CPU cpu;
+    initCpu(&cpu);
+    cpu.baseline = baseline;
+    memcpy(cpu.memory, baseline, MEMORY_SIZE);
+
+    // one untimed run to warm up the caches and the branch predictor
+    timeRun(&cpu, options->instructions / 10 + 1);
+
+    *result = (BenchResult){.bench = bench, .runs = options->repeat};
+    for (size_t i = 0; i < options->repeat; ++i) {
+        result->ns[i] = timeRun(&cpu, options->instructions);
+    }
+    qsort(result->ns, result->runs, sizeof(double), compareDoubles);
+
+    freeCpu(&cpu);
+    free(baseline);
+    freeExecutable(&exec);
+
+    return true;
+}
+
+static void writeJson(FILE* out, const BenchResult* results, size_t count, const Options* options) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"version\": 1,\n");
+    fprintf(out, "  \"repeat\": %zu,\n", options->repeat);
+    fprintf(out, "  \"instructions_per_run\": %llu,\n", (unsigned long long)options->instructions);
+    fprintf(out, "  \"benchmarks\": [\n");
+
+    for (size_t i = 0; i < count; ++i) {
+        const BenchResult* r = &results[i];
+        const double med = median(r);
+
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": \"%s\",\n", r->bench->name);
+        fprintf(out, "      \"kind\": \"%s\",\n",
+                r->bench->kind == BENCH_MICRO ? "micro" : "program");
+        fprintf(out, "      \"median_ns_per_instruction\": %.4f,\n", med);
+        fprintf(out, "      \"median_instructions_per_second\": %.0f,\n", 1e9 / med);
+        fprintf(out, "      \"min_ns_per_instruction\": %.4f,\n", r->ns[0]);
+        fprintf(out, "      \"max_ns_per_instruction\": %.4f,\n", r->ns[r->runs - 1]);
+        fprintf(out, "      \"runs_ns_per_instruction\": [");
+        for (size_t j = 0; j < r->runs; ++j) {
+            fprintf(out, j == 0 ? "%.4f" : ", %.4f", r->ns[j]);
+        }
+        fprintf(out, "]\n");
+        fprintf(out, "    }%s\n", i + 1 < count ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parseArgs(argc, argv, &options)) {
+        printf(USAGE);
+        return 1;
+    }
+
+    // the table goes to stderr when the JSON goes to stdout
+    FILE* table = options.json != NULL && strcmp(options.json, "-") == 0 ? stderr : stdout;
+    BenchResult results[BENCHMARK_COUNT];
+    size_t count = 0;
+
+    fprintf(table, "%-16s %12s %12s %12s %14s\n", "benchmark", "median ns", "min ns", "max ns",
+            "median MIPS");
+
+    for (size_t i = 0; i < BENCHMARK_COUNT; ++i) {
+        const Benchmark* bench = &BENCHMARKS[i];
+        if (options.filter != NULL && strstr(bench->name, options.filter) == NULL) continue;
+
+        if (!runBenchmark(bench, &options, &results[count])) {
+            fprintf(table, "%-16s couldn't assemble '%s'\n", bench->name,
+                    bench->kind == BENCH_MICRO ? bench->name : bench->body);
+            continue;
+        }
+
+        const BenchResult* r = &results[count++];
+        const double med = median(r);
+        fprintf(table, "%-16s %12.3f %12.3f %12.3f %14.1f\n", bench->name, med, r->ns[0],
+                r->ns[r->runs - 1], 1e3 / med);
+    }
+
+    if (options.json != NULL) {
+        const bool to_stdout = strcmp(options.json, "-") == 0;
+        FILE* out = to_stdout ? stdout : fopen(options.json, "w");
+
+        if (out == NULL) {
+            printf("couldn't open '%s' for writing\n", options.json);
+            return 1;
+        }
+        writeJson(out, results, count, &options);
+        if (!to_stdout) {
+            fclose(out);
+        }
+    }
+
+    return 0;
+}
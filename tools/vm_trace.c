@@ -0,0 +1,205 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/headers/debug.h"
+#include "../src/headers/debug_info.h"
+#include "../src/headers/trace.h"
+
+#define USAGE                                                                              \
+    "USAGE: build/vm-trace [options] <trace>\n"                                            \
+    "\n"                                                                                   \
+    "OPTIONS:\n"                                                                           \
+    "    --debug-info <file>   symbolize addresses with the tables from vm --debug-info\n" \
+    "    --pc <lo[:hi]>        only show instructions at these addresses or labels\n"      \
+    "    --func <label>        only show instructions from <label> up to the next label\n" \
+    "    --last <n>            only show the last <n> matching instructions\n"
+
+typedef struct Options {
+    const char* trace;
+    const char* debug_info;
+    const char* pc;
+    const char* func;
+    size_t last;
+} Options;
+
+static bool parseArgs(int argc, char** argv, Options* options) {
+    *options = (Options){.trace = NULL, .debug_info = NULL, .pc = NULL, .func = NULL, .last = 0};
+
+    for (int i = 1; i < argc; ++i) {
+        const char* opt = argv[i];
+        bool takes_value = strcmp(opt, "--debug-info") == 0 || strcmp(opt, "--pc") == 0 ||
+                           strcmp(opt, "--func") == 0 || strcmp(opt, "--last") == 0;
+
+        if (takes_value && ++i == argc) {
+            printf("%s expects a value\n", opt);
+            return false;
+        }
+
+        if (strcmp(opt, "--debug-info") == 0) {
+            options->debug_info = argv[i];
+        } else if (strcmp(opt, "--pc") == 0) {
+            options->pc = argv[i];
+        } else if (strcmp(opt, "--func") == 0) {
+            options->func = argv[i];
+        } else if (strcmp(opt, "--last") == 0) {
+            options->last = (size_t)strtoul(argv[i], NULL, 10);
+        } else if (opt[0] == '-') {
+            printf("unknown option '%s'\n", opt);
+            return false;
+        } else {
+            options->trace = opt;
+        }
+    }
+
+    return options->trace != NULL;
+}
+
+static const Symbol* symbolNamed(const DebugInfo* info, const char* name) {
+    if (info == NULL) return NULL;
+
+    for (size_t i = 0; i < info->symbols.symbols.len; ++i) {
+        const Symbol* sym = get_vec(&info->symbols.symbols, i);
+        if (sym->name.len == strlen(name) && memcmp(sym->name.str, name, sym->name.len) == 0) {
+            return sym;
+        }
+    }
+
+    return NULL;
+}
+
+static bool resolveAddress(const DebugInfo* info, const char* target, uint16_t* addr) {
+    const Symbol* sym = symbolNamed(info, target);
+    if (sym != NULL) {
+        *addr = sym->addr;
+        return true;
+    }
+
+    char* end;
+    unsigned long value = strtoul(target, &end, 0);
+    if (*target == '\0' || (*end != '\0' && *end != ':') || value >= MEMORY_SIZE) {
+        return false;
+    }
+
+    *addr = (uint16_t)value;
+    return true;
+}
+
+// Parses `lo:hi` or a single `lo` for --pc
+static bool resolveRange(const DebugInfo* info, const char* range, uint16_t* lo, uint16_t* hi) {
+    const char* colon = strchr(range, ':');
+    char low[64];
+    size_t len = colon == NULL ? strlen(range) : (size_t)(colon - range);
+
+    if (len >= sizeof(low)) return false;
+    memcpy(low, range, len);
+    low[len] = '\0';
+
+    if (!resolveAddress(info, low, lo)) return false;
+    if (colon == NULL) {
+        *hi = *lo;
+        return true;
+    }
+
+    return resolveAddress(info, colon + 1, hi) && *lo <= *hi;
+}
+
+// A function covers everything from its label up to the next one
+static bool funcRange(const DebugInfo* info, const char* name, uint16_t* lo, uint16_t* hi) {
+    const Symbol* sym = symbolNamed(info, name);
+    if (sym == NULL) return false;
+
+    const Symbol* first = info->symbols.symbols.ptr;
+    const size_t idx = (size_t)(sym - first);
+
+    *lo = sym->addr;
+    *hi = idx + 1 < info->symbols.symbols.len ? first[idx + 1].addr - 1 : MEMORY_SIZE - 1;
+
+    return true;
+}
+
+static void printRecord(const TraceRecord* rec, const DebugInfo* info) {
+    // records only keep two operand bytes, so the last byte of a JEXT target shows up as 0
+    const uint8_t bytes[MAX_OPCODE_LENGTH] = {rec->opcode, rec->operands[0], rec->operands[1], 0};
+
+    printf("%10lu  0x%04x  ", (unsigned long)rec->cycle, rec->pc);
+    if (info != NULL) {
+        const Symbol* sym = findSymbol(&info->symbols, rec->pc);
+        int width = 0;
+        if (sym != NULL) {
+            width = printf("%.*s+%u", (int)sym->name.len, sym->name.str, rec->pc - sym->addr);
+        }
+        printf("%*s", width < 20 ? 20 - width : 1, "");
+    }
+    printf("acc %3u  flags 0x%02x  sp %3u  ", rec->acc, rec->flags, rec->sp);
+    printNextOperation(bytes);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!parseArgs(argc, argv, &options)) {
+        printf(USAGE);
+        return 0;
+    }
+
+    DebugInfo debug_info;
+    const DebugInfo* info = NULL;
+    if (options.debug_info != NULL) {
+        if (!readDebugInfo(&debug_info, options.debug_info)) {
+            printf("couldn't read debug info from '%s'\n", options.debug_info);
+            return 1;
+        }
+        info = &debug_info;
+    }
+
+    uint16_t lo = 0;
+    uint16_t hi = MEMORY_SIZE - 1;
+    if (options.pc != NULL && !resolveRange(info, options.pc, &lo, &hi)) {
+        printf("can't resolve '%s', expected <lo[:hi]> with labels or addresses\n", options.pc);
+        return 1;
+    }
+    if (options.func != NULL && !funcRange(info, options.func, &lo, &hi)) {
+        printf("no label called '%s', --func needs --debug-info\n", options.func);
+        return 1;
+    }
+
+    vec_t records = new_vec(1024, sizeof(TraceRecord));
+    if (!readTrace(options.trace, &records)) {
+        printf("'%s' isn't a trace file\n", options.trace);
+        return 1;
+    }
+
+    vec_t matches = new_vec(1024, sizeof(TraceRecord*));
+    for (size_t i = 0; i < records.len; ++i) {
+        TraceRecord* rec = get_vec(&records, i);
+        if (rec->pc >= lo && rec->pc <= hi) {
+            push_vec(&matches, &rec);
+        }
+    }
+
+    const size_t first =
+        options.last != 0 && options.last < matches.len ? matches.len - options.last : 0;
+    for (size_t i = first; i < matches.len; ++i) {
+        printRecord(CAST(get_vec(&matches, i), TraceRecord*), info);
+    }
+
+    if (records.len > 0) {
+        const TraceRecord* start = first_vec(&records);
+        const TraceRecord* end = last_vec(&records);
+        const uint64_t missing = end->cycle - start->cycle + 1 - records.len;
+        if (missing != 0) {
+            printf("%lu instructions were dropped while tracing\n", (unsigned long)missing);
+        }
+    }
+
+    free_vec(&matches, NULL);
+    free_vec(&records, NULL);
+    if (info != NULL) {
+        freeDebugInfo(&debug_info);
+    }
+
+    return 0;
+}